@@ -33,6 +33,7 @@
 #include "binder/expressions/bound_star.h"
 #include "binder/expressions/bound_unary_op.h"
 #include "binder/statement/create_statement.h"
+#include "binder/statement/drop_statement.h"
 #include "binder/statement/index_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/table_ref/bound_base_table_ref.h"
@@ -132,4 +133,22 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
   return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
 }
 
+auto Binder::BindDrop(duckdb_libpgquery::PGDropStmt *stmt) -> std::unique_ptr<DropStatement> {
+  if (stmt->removeType != duckdb_libpgquery::PG_OBJECT_TABLE &&
+      stmt->removeType != duckdb_libpgquery::PG_OBJECT_INDEX) {
+    throw NotImplementedException("only DROP TABLE and DROP INDEX are supported");
+  }
+  if (stmt->objects->length != 1) {
+    throw NotImplementedException("only one table or index can be dropped at a time");
+  }
+  // The name may be qualified; the last part is the name of the table or index itself.
+  auto name_list = reinterpret_cast<duckdb_libpgquery::PGList *>(stmt->objects->head->data.ptr_value);
+  std::string name = reinterpret_cast<duckdb_libpgquery::PGValue *>(name_list->tail->data.ptr_value)->val.str;
+  const bool is_index = stmt->removeType == duckdb_libpgquery::PG_OBJECT_INDEX;
+  if (!is_index && !stmt->missing_ok && catalog_.GetTable(name) == nullptr) {
+    throw bustub::Exception(fmt::format("invalid table {}", name));
+  }
+  return std::make_unique<DropStatement>(is_index, std::move(name), stmt->missing_ok);
+}
+
 }  // namespace bustub
@@ -722,6 +722,23 @@ auto Binder::BindAExpr(duckdb_libpgquery::PGAExpr *root) -> std::unique_ptr<Boun
   BUSTUB_ASSERT(root, "nullptr");
   auto name = std::string((reinterpret_cast<duckdb_libpgquery::PGValue *>(root->name->head->data.ptr_value))->val.str);
 
+  if (root->kind == duckdb_libpgquery::PG_AEXPR_BETWEEN || root->kind == duckdb_libpgquery::PG_AEXPR_NOT_BETWEEN) {
+    // `x BETWEEN lo AND hi` is bound as `x >= lo and x <= hi`, and `x NOT BETWEEN lo AND hi` as `x < lo or x > hi`,
+    // so that the optimizer sees the bounds of x as comparisons.
+    auto *bounds = reinterpret_cast<duckdb_libpgquery::PGList *>(root->rexpr);
+    if (bounds == nullptr || bounds->length != 2) {
+      throw bustub::Exception("BETWEEN should have 2 bounds");
+    }
+    const bool between = root->kind == duckdb_libpgquery::PG_AEXPR_BETWEEN;
+    auto lower = std::make_unique<BoundBinaryOp>(
+        between ? ">=" : "<", BindExpression(root->lexpr),
+        BindExpression(reinterpret_cast<duckdb_libpgquery::PGNode *>(bounds->head->data.ptr_value)));
+    auto upper = std::make_unique<BoundBinaryOp>(
+        between ? "<=" : ">", BindExpression(root->lexpr),
+        BindExpression(reinterpret_cast<duckdb_libpgquery::PGNode *>(bounds->head->next->data.ptr_value)));
+    return std::make_unique<BoundBinaryOp>(between ? "and" : "or", std::move(lower), std::move(upper));
+  }
+
   if (root->kind != duckdb_libpgquery::PG_AEXPR_OP) {
     throw bustub::Exception("unsupported op in AExpr");
   }
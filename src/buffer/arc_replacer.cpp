@@ -0,0 +1,187 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) : frames_(num_frames), capacity_(num_frames) {}
+
+void ARCReplacer::CheckFrame(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= frames_.size()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id is out of the replacer's range");
+  }
+}
+
+auto ARCReplacer::PickVictims(size_t n) const -> std::vector<frame_id_t> {
+  std::vector<frame_id_t> victims;
+  auto t1_it = t1_.begin();
+  auto t2_it = t2_.begin();
+  auto next_evictable = [this](std::list<frame_id_t>::const_iterator it, const std::list<frame_id_t> &list) {
+    while (it != list.end() && !frames_[*it].evictable_) {
+      ++it;
+    }
+    return it;
+  };
+  // Every victim taken from T1 shrinks it, which may hand the next pick over to T2.
+  size_t t1_size = t1_.size();
+  while (victims.size() < n) {
+    t1_it = next_evictable(t1_it, t1_);
+    t2_it = next_evictable(t2_it, t2_);
+    bool from_t1 = t1_it != t1_.end() && (t1_size > p_ || t2_it == t2_.end());
+    if (from_t1) {
+      victims.push_back(*t1_it++);
+      t1_size--;
+    } else if (t2_it != t2_.end()) {
+      victims.push_back(*t2_it++);
+    } else {
+      break;
+    }
+  }
+  return victims;
+}
+
+void ARCReplacer::EraseGhost(page_id_t page_id) {
+  auto it = ghosts_.find(page_id);
+  if (it == ghosts_.end()) {
+    return;
+  }
+  (it->second.in_b2_ ? b2_ : b1_).erase(it->second.pos_);
+  ghosts_.erase(it);
+}
+
+void ARCReplacer::TrimGhosts() {
+  while (!b1_.empty() && t1_.size() + b1_.size() > capacity_) {
+    ghosts_.erase(b1_.front());
+    b1_.pop_front();
+  }
+  while (t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * capacity_) {
+    auto &ghost_list = b2_.empty() ? b1_ : b2_;
+    if (ghost_list.empty()) {
+      break;
+    }
+    ghosts_.erase(ghost_list.front());
+    ghost_list.pop_front();
+  }
+}
+
+void ARCReplacer::Detach(frame_id_t frame_id) {
+  auto &entry = frames_[frame_id];
+  (entry.in_t2_ ? t2_ : t1_).erase(entry.pos_);
+  if (entry.page_id_ != INVALID_PAGE_ID) {
+    EraseGhost(entry.page_id_);
+    auto &ghost_list = entry.in_t2_ ? b2_ : b1_;
+    ghosts_[entry.page_id_] = {entry.in_t2_, ghost_list.insert(ghost_list.end(), entry.page_id_)};
+  }
+  if (entry.evictable_) {
+    curr_size_--;
+  }
+  entry = FrameEntry{};
+  TrimGhosts();
+}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto victims = PickVictims(1);
+  if (victims.empty()) {
+    return false;
+  }
+  *frame_id = victims[0];
+  Detach(victims[0]);
+  return true;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  auto &entry = frames_[frame_id];
+  const bool is_scan = access_type == AccessType::Scan;
+  if (entry.tracked_) {
+    if (entry.in_t2_) {
+      t2_.splice(t2_.end(), t2_, entry.pos_);
+    } else if (!is_scan) {
+      t2_.splice(t2_.end(), t1_, entry.pos_);
+      entry.in_t2_ = true;
+    }
+    return;
+  }
+
+  entry.tracked_ = true;
+  entry.page_id_ = page_id;
+  auto ghost = page_id == INVALID_PAGE_ID ? ghosts_.end() : ghosts_.find(page_id);
+  if (ghost != ghosts_.end() && !is_scan) {
+    // A ghost hit: the list the page was evicted from should have been larger.
+    if (ghost->second.in_b2_) {
+      size_t delta = std::max<size_t>(1, b1_.size() / b2_.size());
+      p_ = p_ > delta ? p_ - delta : 0;
+    } else {
+      size_t delta = std::max<size_t>(1, b2_.size() / b1_.size());
+      p_ = std::min(capacity_, p_ + delta);
+    }
+    entry.in_t2_ = true;
+  }
+  if (ghost != ghosts_.end()) {
+    EraseGhost(page_id);
+  }
+  auto &list = entry.in_t2_ ? t2_ : t1_;
+  entry.pos_ = list.insert(list.end(), frame_id);
+  TrimGhosts();
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  auto &entry = frames_[frame_id];
+  if (!entry.tracked_ || entry.evictable_ == set_evictable) {
+    return;
+  }
+  entry.evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  auto &entry = frames_[frame_id];
+  if (!entry.tracked_) {
+    return;
+  }
+  if (!entry.evictable_) {
+    throw Exception(ExceptionType::INVALID, "cannot remove a non-evictable frame");
+  }
+  Detach(frame_id);
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+auto ARCReplacer::EvictionCandidates(size_t n) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  return PickVictims(n);
+}
+
+auto ARCReplacer::GetTarget() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return p_;
+}
+
+}  // namespace bustub
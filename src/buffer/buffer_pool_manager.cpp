@@ -11,21 +11,48 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager.h"
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "common/exception.h"
+#include "common/logger.h"
 #include "common/macros.h"
 #include "storage/page/page.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+/** @return the steady clock in nanoseconds, for timing pins */
+static auto SteadyNowNs() -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
                                      LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+    : BufferPoolManager(pool_size, 1, 0, disk_manager, replacer_k, log_manager) {}
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                     DiskManager *disk_manager, size_t replacer_k, LogManager *log_manager)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(static_cast<page_id_t>(instance_index)),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      replacer_k_(replacer_k) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 0.");
   // TODO(students): remove this line after you have implemented the buffer pool manager
   // throw NotImplementedException(
   //     "BufferPoolManager is not implemented yet. If you have finished implementing BPM, please remove the throw "
@@ -33,8 +60,22 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
 
   // we allocate a consecutive memory space for the buffer pool
   std::cout << "pool_size" << pool_size << "  replacer_k" << replacer_k << std::endl;
-  pages_ = new Page[pool_size_];
-  replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
+  arenas_.push_back(std::make_unique<FrameArena>(pool_size, buffer_pool_huge_pages.load()));
+  pages_.Init(pool_size, [arena = arenas_.back().get()](Page *page, size_t i) {
+    new (page) Page(arena->GetFrame(static_cast<frame_id_t>(i)));
+  });
+  replacer_ = MakeReplacer(replacer_policy_, pool_size, replacer_k);
+  free_page_map_ = std::make_unique<FreePageMap>(disk_manager, num_instances_, instance_index_);
+  next_page_id_ = free_page_map_->End();
+  disk_scheduler_ = std::make_unique<DiskScheduler>(disk_manager);
+  page_table_.Reserve(pool_size_);
+  cleaned_by_flusher_.resize(pool_size_, false);
+  prefetched_.Init(pool_size_);
+  frame_access_type_.Init(pool_size_);
+  pinned_since_.Init(pool_size_);
+  // An access log entry has 24 bits for the frame id.
+  BUSTUB_ASSERT(pool_size_ < (1U << 24), "buffer pool is too large");
+  access_log_ = std::make_unique<AccessLogStripe[]>(ACCESS_LOG_STRIPES);
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
@@ -42,172 +83,1040 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
   }
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
+BufferPoolManager::BufferPoolManager(size_t pool_size) : pool_size_(pool_size) {}
+
+BufferPoolManager::~BufferPoolManager() {
+  StopBackgroundFlusher();
+  // Join the scheduler before the frames it reads into and writes from go away.
+  disk_scheduler_.reset();
+}
 
-auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
+auto BufferPoolManager::NewPage(page_id_t *page_id, segment_id_t segment) -> Page * {
   // 理解 ：让 缓冲池 多管理一个页面
-  std::lock_guard<std::mutex> lock(latch_);
+  if (segment < DEFAULT_SEGMENT_ID || segment > MAX_SEGMENT_ID) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "invalid segment id " + std::to_string(segment));
+  }
+  std::unique_lock<std::mutex> lock(latch_);
   *page_id = INVALID_PAGE_ID;
-  if (replacer_->Size() == 0 && free_list_.empty()) {
-    return nullptr;
+  if (auto allocation = segments_.find(segment); allocation != segments_.end() && allocation->second.free_.empty() &&
+                                                 allocation->second.next_page_number_ >= SEGMENT_PAGES) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "segment " + std::to_string(segment) + " is full");
+  }
+  if (segment == DEFAULT_SEGMENT_ID && allocation_batch_.empty()) {
+    allocation_batch_ = free_page_map_->Allocate(ALLOCATION_BATCH_SIZE);
+    std::reverse(allocation_batch_.begin(), allocation_batch_.end());
+    if (allocation_batch_.empty()) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "segment " + std::to_string(segment) + " is full");
+    }
   }
 
   frame_id_t id;
+  std::optional<WriteBack> write_back;
+  if (!AcquireFrame(&id, &write_back)) {
+    return nullptr;
+  }
 
-  if (!free_list_.empty()) {
-    id = static_cast<int>(*free_list_.begin());
-    free_list_.pop_front();
+  bool reused = false;
+  *page_id = AllocatePage(&reused, segment);
+  // A reused page is dirty from the start, or an eviction could bring its old contents back.
+  pages_[id].is_dirty_ = reused;
+  PinFrame(id, AccessType::Unknown, *page_id);
+  page_table_.Insert(*page_id, id);
 
-  } else if (!replacer_->Evict(&id)) {
-    return nullptr;
-  } else {
-    page_table_.erase(pages_[id].GetPageId());
-    // TOOD(unknown): writeback
-    if (pages_[id].IsDirty()) {
-      disk_manager_->WritePage(pages_[id].GetPageId(), pages_[id].GetData());
+  // Nobody knows the new page id yet, so the frame can be handed out as soon as the old contents are on disk.
+  if (write_back.has_value()) {
+    lock.unlock();
+    const bool written = write_back->done_.get();
+    lock.lock();
+    if (!written) {
+      // The evicted page keeps the frame, and the new page is given up.
+      page_table_.Erase(*page_id);
+      DeallocatePage(*page_id);
+      *page_id = INVALID_PAGE_ID;
+      if (RestoreVictim(id, *write_back, &lock)) {
+        UnpinFrame(id, false);
+      } else {
+        AbandonFrame(id, &lock);
+      }
+      return nullptr;
     }
-
-    // DeallocatePage(pages_[id].GetPageId());
+    FinishWriteBack(*write_back);
   }
-  *page_id = AllocatePage();
   pages_[id].ResetMemory();
-  pages_[id].pin_count_++;
   pages_[id].page_id_ = *page_id;
-  pages_[id].is_dirty_ = false;
-  disk_manager_->ReadPage(*page_id, pages_[id].data_);
-  replacer_->RecordAccess(id);
-  replacer_->SetEvictable(id, false);
-  // emplace  不会删除这个页面。
-  page_table_.emplace(std::make_pair(*page_id, id));
   return &pages_[id];
 }
 
-auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
-  std::lock_guard<std::mutex> lock(latch_);
-  auto it = page_table_.find(page_id);
-  if (it != page_table_.end()) {
-    replacer_->RecordAccess(it->second);
-    replacer_->SetEvictable(it->second, false);
-    pages_[it->second].pin_count_++;
-    // pages_[it->second].is_dirty_ = true;
-    return &pages_[it->second];
+auto BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  // Fast path: pin a resident page without the latch. The pin only counts if the frame still holds the page after it
+  // was taken; TryClaimVictim() does the same two steps in the opposite order, so either the eviction sees the pin,
+  // or this fetch sees the frame being taken away and retries under the latch.
+  if (frame_id_t id = page_table_.Find(page_id); id >= 0) {
+    Page &page = pages_[id];
+    int pin_count = page.pin_count_.fetch_add(1);
+    if (page.page_id_.load() == page_id) {
+      if (prefetched_[id].load(std::memory_order_relaxed)) {
+        prefetched_[id].store(false, std::memory_order_relaxed);
+      }
+      LogAccess(id, page_id, access_type);
+      CountPin(id, pin_count, access_type);
+      counters_.Add(BufferPoolCounters::HITS);
+      return &page;
+    }
+    page.pin_count_.fetch_sub(1);
   }
-  frame_id_t id;
-  if (!free_list_.empty()) {
-    id = static_cast<int>(*free_list_.begin());
-    free_list_.pop_front();
 
-  } else if (!replacer_->Evict(&id)) {
-    return nullptr;
-  } else {
-    page_table_.erase(pages_[id].GetPageId());
-    if (pages_[id].IsDirty()) {
-      disk_manager_->WritePage(pages_[id].GetPageId(), pages_[id].GetData());
+  std::unique_lock<std::mutex> lock(latch_);
+  if (frame_id_t id = page_table_.Find(page_id); id >= 0) {
+    PinFrame(id, access_type, page_id);
+    prefetched_[id] = false;
+    counters_.Add(BufferPoolCounters::HITS);
+    auto loading = in_flight_.find(page_id);
+    if (loading != in_flight_.end()) {
+      // Someone else is reading this page in. Share that read instead of issuing a duplicate one, and if it is a
+      // prefetch that nobody waited for so far, have it served as a foreground read.
+      counters_.Add(BufferPoolCounters::PIN_WAITS);
+      auto loaded = loading->second;
+      lock.unlock();
+      disk_scheduler_->Expedite(page_id);
+      if (!loaded.get()) {
+        UnpinFrame(id, false);
+        return nullptr;
+      }
     }
-    // DeallocatePage(pages_[id].GetPageId());
+    return &pages_[id];
   }
-  pages_[id].ResetMemory();
-  pages_[id].page_id_ = page_id;
-  disk_manager_->ReadPage(page_id, pages_[id].data_);
-  pages_[id].pin_count_++;
+
+  frame_id_t id;
+  std::optional<WriteBack> write_back;
+  if (!AcquireFrame(&id, &write_back)) {
+    return nullptr;
+  }
+
+  // Publish the frame right away, marked in-flight, so that concurrent fetchers of this page wait for our read.
+  // The page id of the frame is only set once the read is done, so that the fast path never hands out a frame that
+  // is still being read into.
+  std::promise<bool> loaded;
+  in_flight_.emplace(page_id, loaded.get_future().share());
   pages_[id].is_dirty_ = false;
-  replacer_->RecordAccess(id);
-  replacer_->SetEvictable(id, false);
-  page_table_.emplace(std::make_pair(page_id, id));
-  return &pages_[id];
+  PinFrame(id, access_type, page_id);
+  page_table_.Insert(page_id, id);
+
+  // The page may have been evicted a moment ago and still be on its way to disk.
+  counters_.Add(BufferPoolCounters::MISSES);
+  std::optional<std::shared_future<bool>> pending_write;
+  if (auto pending = write_backs_.find(page_id); pending != write_backs_.end()) {
+    pending_write = pending->second.done_;
+    counters_.Add(BufferPoolCounters::PIN_WAITS);
+  }
+  lock.unlock();
+
+  const bool written = !write_back.has_value() || write_back->done_.get();
+  // If the write-back of this very page failed, the disk has an older copy, and the evictor puts the page back.
+  const bool ok = written && (!pending_write.has_value() || pending_write->get()) &&
+                  ScheduleIo(false, pages_[id].data_, page_id, DiskRequestPriority::Foreground).get();
+
+  lock.lock();
+  in_flight_.erase(page_id);
+  if (ok) {
+    pages_[id].page_id_ = page_id;
+    if (write_back.has_value()) {
+      FinishWriteBack(*write_back);
+    }
+    lock.unlock();
+    loaded.set_value(true);
+    return &pages_[id];
+  }
+
+  // Nothing was read: take the page out of the pool again, and give the frame back to the page evicted from it if that
+  // could not be written, or to the free list.
+  page_table_.Erase(page_id);
+  lock.unlock();
+  loaded.set_value(false);
+  lock.lock();
+  bool restored = false;
+  if (write_back.has_value()) {
+    if (written) {
+      FinishWriteBack(*write_back);
+    } else {
+      restored = RestoreVictim(id, *write_back, &lock);
+    }
+  }
+  if (restored) {
+    UnpinFrame(id, false);
+  } else {
+    AbandonFrame(id, &lock);
+  }
+  return nullptr;
 }
 
 auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
+  // The caller's pin keeps the frame on its page, so there is nothing to lock. Only a lookup that raced with a page
+  // table update, or an unpin of a page that is not pinned, has to look again under the latch.
+  frame_id_t id = page_table_.Find(page_id);
+  if (id >= 0 && pages_[id].page_id_.load() == page_id) {
+    UnpinFrame(id, is_dirty);
+    return true;
+  }
   std::lock_guard<std::mutex> lock(latch_);
-  auto it = page_table_.find(page_id);
-  if (it != page_table_.end()) {
-    if (pages_[it->second].pin_count_ > 0) {
-      pages_[it->second].pin_count_--;
-      if (pages_[it->second].pin_count_ == 0) {
-        replacer_->SetEvictable(it->second, true);
+  id = page_table_.Find(page_id);
+  if (id < 0) {
+    return false;
+  }
+  UnpinFrame(id, is_dirty);
+  return true;
+}
+
+auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  frame_id_t id;
+  while (true) {
+    id = page_table_.Find(page_id);
+    if (id < 0) {
+      return false;
+    }
+    auto loading = in_flight_.find(page_id);
+    if (loading == in_flight_.end()) {
+      break;
+    }
+    // Nothing to flush until the page has been read in; look it up again afterwards as it may be gone by then.
+    auto loaded = loading->second;
+    lock.unlock();
+    loaded.wait();
+    lock.lock();
+  }
+
+  // Keep the frame pinned while the write is outstanding. A page dirtied in the meantime will be marked dirty again
+  // when it is unpinned.
+  pages_[id].pin_count_.fetch_add(1);
+  pages_[id].is_dirty_ = false;
+  lock.unlock();
+
+  const bool ok = ScheduleIo(true, pages_[id].data_, page_id, DiskRequestPriority::Foreground).get();
+  if (ok) {
+    // Concurrent flushes share their fdatasync calls.
+    disk_manager_->SyncPages();
+  }
+
+  UnpinFrame(id, !ok);
+  return ok;
+}
+
+void BufferPoolManager::FlushAllPages() { CheckpointPools({this}); }
+
+void BufferPoolManager::CheckpointPools(const std::vector<BufferPoolManager *> &pools) {
+  struct CheckpointPage {
+    page_id_t page_id_;
+    BufferPoolManager *pool_;
+    frame_id_t frame_id_;
+  };
+  std::vector<CheckpointPage> pages;
+  std::vector<std::shared_future<bool>> write_backs;
+  for (auto *pool : pools) {
+    std::lock_guard<std::mutex> lock(pool->latch_);
+    // Frames being drained by a shrink are past pool_size_, but may still hold dirty pages.
+    for (size_t i = 0; i < pool->pages_.Capacity(); i++) {
+      Page &page = pool->pages_[i];
+      page_id_t page_id = page.page_id_.load();
+      if (page_id == INVALID_PAGE_ID || !page.is_dirty_ || pool->in_flight_.count(page_id) > 0) {
+        continue;
+      }
+      // Like FlushPage(), the pin keeps the frame from being evicted while its write is outstanding.
+      page.pin_count_.fetch_add(1);
+      page.is_dirty_ = false;
+      pages.push_back({page_id, pool, static_cast<frame_id_t>(i)});
+    }
+    for (const auto &[page_id, write_back] : pool->write_backs_) {
+      write_backs.push_back(write_back.done_);
+    }
+  }
+  std::sort(pages.begin(), pages.end(),
+            [](const CheckpointPage &a, const CheckpointPage &b) { return a.page_id_ < b.page_id_; });
+
+  // Cut the sorted pages into runs of consecutive page ids.
+  std::vector<std::pair<size_t, size_t>> runs;
+  for (size_t begin = 0, end = 1; begin < pages.size(); begin = end++) {
+    while (end < pages.size() && end - begin < CHECKPOINT_RUN_PAGES &&
+           pages[end].page_id_ == pages[end - 1].page_id_ + 1) {
+      end++;
+    }
+    runs.emplace_back(begin, end);
+  }
+
+  // The writers take the runs in page id order, so each of them still writes the file front to back.
+  std::atomic<size_t> next_run{0};
+  auto writer = [&] {
+    std::vector<const char *> data;
+    for (size_t r = next_run.fetch_add(1); r < runs.size(); r = next_run.fetch_add(1)) {
+      auto [begin, end] = runs[r];
+      data.clear();
+      for (size_t i = begin; i < end; i++) {
+        data.push_back(pages[i].pool_->pages_[pages[i].frame_id_].data_);
+      }
+      pages[begin].pool_->disk_manager_->WritePages(pages[begin].page_id_, data);
+      for (size_t i = begin; i < end; i++) {
+        pages[i].pool_->UnpinFrame(pages[i].frame_id_, false);
       }
     }
-    if (!pages_[it->second].is_dirty_) {
-      pages_[it->second].is_dirty_ = is_dirty;
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(checkpoint_writers.load(), runs.size()); i++) {
+    threads.emplace_back(writer);
+  }
+  writer();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (auto &write_back : write_backs) {
+    write_back.wait();
+  }
+  std::vector<DiskManager *> disk_managers;
+  for (auto *pool : pools) {
+    pool->FlushFreePageMap();
+    if (std::find(disk_managers.begin(), disk_managers.end(), pool->disk_manager_) == disk_managers.end()) {
+      disk_managers.push_back(pool->disk_manager_);
+    }
+  }
+  for (auto *disk_manager : disk_managers) {
+    disk_manager->SyncPages();
+  }
+}
+
+void BufferPoolManager::FlushFreePageMap() {
+  {
+    // Pages held back for later allocations are not in use, and should not stay allocated on disk.
+    std::lock_guard<std::mutex> lock(latch_);
+    for (auto page_id : allocation_batch_) {
+      free_page_map_->Free(page_id);
     }
+    allocation_batch_.clear();
+  }
+  free_page_map_->Flush();
+}
+
+auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  frame_id_t id = page_table_.Find(page_id);
+  if (id < 0) {
+    DeallocatePage(page_id);
     return true;
   }
-  return false;
+  // A frame that is still being read in is pinned by its reader, so it is never deleted here.
+  if (TryClaimVictim(id, false) == INVALID_PAGE_ID) {
+    return false;
+  }
+  page_table_.Erase(page_id);
+  FreeFrame(id);
+  DeallocatePage(page_id);
+  return true;
 }
 
-auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
-  auto it = page_table_.find(page_id);
-  if (it != page_table_.end()) {
-    disk_manager_->WritePage(page_id, pages_[it->second].GetData());
-    replacer_->RecordAccess(it->second);
-    replacer_->SetEvictable(it->second, true);
-    // pages_[it->second].pin_count_++;
-    pages_[it->second].is_dirty_ = false;
+void BufferPoolManager::FreeFrame(frame_id_t frame_id) {
+  // The page is gone, so its contents are dropped rather than written back.
+  replacer_->Remove(frame_id);
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    free_list_.emplace_back(static_cast<int>(frame_id));
+  }
+  prefetched_[frame_id] = false;
+  cleaned_by_flusher_[frame_id] = false;
+  pages_[frame_id].ResetMemory();
+  pages_[frame_id].is_dirty_ = false;
+}
+
+void BufferPoolManager::AbandonFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  while (pages_[frame_id].pin_count_.load() > 1) {
+    lock->unlock();
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    lock->lock();
+  }
+  UnpinFrame(frame_id, false);
+  FreeFrame(frame_id);
+}
+
+auto BufferPoolManager::RestoreVictim(frame_id_t frame_id, const WriteBack &write_back,
+                                      std::unique_lock<std::mutex> *lock) -> bool {
+  const page_id_t page_id = write_back.page_id_;
+  LOG_WARN("write-back of page %d failed, keeping it in the buffer pool", page_id);
+  // A fetch of the page since the eviction saw the write fail too, and takes the page out of the page table again.
+  while (page_table_.Find(page_id) >= 0) {
+    lock->unlock();
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    lock->lock();
+  }
+  FinishWriteBack(write_back);
+  if (!IsAllocated(page_id)) {
+    return false;
+  }
+  page_table_.Insert(page_id, frame_id);
+  pages_[frame_id].is_dirty_ = true;
+  pages_[frame_id].page_id_ = page_id;
+  return true;
+}
+
+void BufferPoolManager::CreateSegment(segment_id_t segment, const std::string &directory) {
+  disk_manager_->CreateSegment(segment, directory);
+}
+
+auto BufferPoolManager::DropSegment(segment_id_t segment) -> bool {
+  if (segment == DEFAULT_SEGMENT_ID) {
+    throw Exception("the default segment can't be dropped");
+  }
+  const bool discarded = DiscardSegment(segment);
+  disk_manager_->DropSegment(segment);
+  return discarded;
+}
+
+auto BufferPoolManager::DiscardSegment(segment_id_t segment) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  // The I/O in flight on the pages of the segment must be done before its file goes away.
+  while (true) {
+    std::vector<std::shared_future<bool>> pending;
+    for (const auto &[page_id, loaded] : in_flight_) {
+      if (SegmentOf(page_id) == segment) {
+        pending.push_back(loaded);
+      }
+    }
+    std::vector<WriteBack> finished;
+    for (const auto &[page_id, write_back] : write_backs_) {
+      if (SegmentOf(page_id) != segment) {
+        continue;
+      }
+      if (write_back.done_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        finished.push_back(write_back);
+      } else {
+        pending.push_back(write_back.done_);
+      }
+    }
+    for (const auto &write_back : finished) {
+      FinishWriteBack(write_back);
+    }
+    if (pending.empty()) {
+      break;
+    }
+    lock.unlock();
+    for (auto &done : pending) {
+      done.wait();
+    }
+    lock.lock();
+  }
+  // Every frame, including the ones past pool_size_ that a shrinking Resize() is still draining.
+  bool discarded = true;
+  for (size_t id = 0; id < pages_.Capacity(); id++) {
+    const auto frame_id = static_cast<frame_id_t>(id);
+    const page_id_t page_id = pages_[frame_id].page_id_.load();
+    if (page_id == INVALID_PAGE_ID || SegmentOf(page_id) != segment) {
+      continue;
+    }
+    if (TryClaimVictim(frame_id, false) != page_id) {
+      discarded = false;
+      continue;
+    }
+    page_table_.Erase(page_id);
+    FreeFrame(frame_id);
+  }
+  segments_.erase(segment);
+  return discarded;
+}
+
+auto BufferPoolManager::AllocatePage(bool *reused, segment_id_t segment) -> page_id_t {
+  if (segment != DEFAULT_SEGMENT_ID) {
+    const auto base = MakeSegmentPageId(segment, 0);
+    const auto num_instances = static_cast<page_id_t>(num_instances_);
+    // The first page number whose page id maps to this instance.
+    const page_id_t first_page_number =
+        (static_cast<page_id_t>(instance_index_) - base % num_instances + num_instances) % num_instances;
+    auto allocation = segments_.try_emplace(segment, SegmentAllocation{first_page_number, {}}).first;
+    auto &free = allocation->second.free_;
+    *reused = !free.empty();
+    if (*reused) {
+      const page_id_t page_id = free.back();
+      free.pop_back();
+      return page_id;
+    }
+    BUSTUB_ASSERT(allocation->second.next_page_number_ < SEGMENT_PAGES, "NewPage() checks that the segment has room");
+    const page_id_t page_id = base + allocation->second.next_page_number_;
+    allocation->second.next_page_number_ += num_instances;
+    return page_id;
+  }
+  BUSTUB_ASSERT(!allocation_batch_.empty(), "NewPage() checks that the default segment has room");
+  const page_id_t page_id = allocation_batch_.back();
+  allocation_batch_.pop_back();
+  BUSTUB_ASSERT(page_id % static_cast<page_id_t>(num_instances_) == static_cast<page_id_t>(instance_index_),
+                "allocated pages must be mod-aligned with the instance index");
+  *reused = page_id < next_page_id_.load();
+  if (!*reused) {
+    next_page_id_ = page_id + static_cast<page_id_t>(num_instances_);
+  }
+  return page_id;
+}
+
+void BufferPoolManager::DeallocatePage(page_id_t page_id) {
+  if (SegmentOf(page_id) != DEFAULT_SEGMENT_ID) {
+    if (IsAllocated(page_id)) {
+      auto &free = segments_[SegmentOf(page_id)].free_;
+      free.insert(std::upper_bound(free.begin(), free.end(), page_id, std::greater<>()), page_id);
+    }
+    return;
+  }
+  if (!free_page_map_->IsAllocated(page_id) ||
+      std::find(allocation_batch_.begin(), allocation_batch_.end(), page_id) != allocation_batch_.end()) {
+    return;
+  }
+  allocation_batch_.insert(
+      std::upper_bound(allocation_batch_.begin(), allocation_batch_.end(), page_id, std::greater<>()), page_id);
+  if (allocation_batch_.size() > 2 * ALLOCATION_BATCH_SIZE) {
+    free_page_map_->Free(allocation_batch_.front());
+    allocation_batch_.erase(allocation_batch_.begin());
+  }
+}
+
+auto BufferPoolManager::IsAllocated(page_id_t page_id) -> bool {
+  if (page_id < 0) {
+    return false;
+  }
+  if (SegmentOf(page_id) == DEFAULT_SEGMENT_ID) {
+    return page_id < next_page_id_.load() && free_page_map_->IsAllocated(page_id);
+  }
+  auto allocation = segments_.find(SegmentOf(page_id));
+  return allocation != segments_.end() && SegmentPageNumber(page_id) < allocation->second.next_page_number_ &&
+         !std::binary_search(allocation->second.free_.begin(), allocation->second.free_.end(), page_id,
+                             std::greater<>());
+}
+
+auto BufferPoolManager::AcquireFrame(frame_id_t *frame_id, std::optional<WriteBack> *write_back) -> bool {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
     return true;
   }
-  return false;
+  DrainAccessLog();
+  // Pinned frames stay in the replacer, so walk down its eviction order until a frame can be claimed.
+  for (size_t batch = EVICTION_CANDIDATES;; batch *= 2) {
+    auto candidates = replacer_->EvictionCandidates(batch);
+    for (auto candidate : candidates) {
+      // Frames past the end of a shrinking pool are left to Resize().
+      if (static_cast<size_t>(candidate) >= pool_size_) {
+        continue;
+      }
+      page_id_t victim_page_id = TryClaimVictim(candidate, false);
+      if (victim_page_id != INVALID_PAGE_ID) {
+        replacer_->Remove(candidate);
+        ReleaseVictim(candidate, victim_page_id, write_back);
+        *frame_id = candidate;
+        return true;
+      }
+    }
+    if (candidates.size() < batch) {
+      return false;
+    }
+  }
+}
+
+auto BufferPoolManager::TryClaimVictim(frame_id_t frame_id, bool clean_only) -> page_id_t {
+  Page &victim = pages_[frame_id];
+  page_id_t page_id = victim.page_id_.load();
+  if (page_id == INVALID_PAGE_ID || victim.pin_count_.load() > 0) {
+    return INVALID_PAGE_ID;
+  }
+  victim.page_id_.store(INVALID_PAGE_ID);
+  // Pairs with the fast path of FetchPage(), which pins first and checks the page id second.
+  if (victim.pin_count_.load() > 0 || (clean_only && victim.IsDirty())) {
+    victim.page_id_.store(page_id);
+    return INVALID_PAGE_ID;
+  }
+  // The frame will be overwritten with another page: fail the optimistic readers of the old one.
+  victim.version_.fetch_add(2);
+  return page_id;
 }
 
-void BufferPoolManager::FlushAllPages() {
-  for (auto &it : page_table_) {
-    disk_manager_->WritePage(pages_[it.second].GetPageId(), pages_[it.second].GetData());
-    replacer_->RecordAccess(it.second);
-    pages_[it.second].is_dirty_ = false;
-    replacer_->SetEvictable(it.second, true);
-    // pages_[i].pin_count_++;
-    // pages_[i].is_dirty_=false;
+void BufferPoolManager::ReleaseVictim(frame_id_t frame_id, page_id_t page_id, std::optional<WriteBack> *write_back) {
+  Page &victim = pages_[frame_id];
+  page_table_.Erase(page_id);
+  counters_.Add(BufferPoolCounters::EVICTIONS);
+  if (victim.IsDirty()) {
+    // The fetch that evicts the page waits for this write before reading into the frame.
+    auto done = ScheduleIo(true, victim.GetData(), page_id, DiskRequestPriority::Foreground).share();
+    WriteBack pending{page_id, next_write_back_seq_++, std::move(done)};
+    write_backs_[pending.page_id_] = pending;
+    *write_back = std::move(pending);
+    counters_.Add(BufferPoolCounters::DIRTY_WRITE_BACKS);
+    flusher_cv_.notify_one();
+  } else if (cleaned_by_flusher_[frame_id]) {
+    write_backs_avoided_.fetch_add(1, std::memory_order_relaxed);
   }
+  cleaned_by_flusher_[frame_id] = false;
+  prefetched_[frame_id] = false;
+  victim.is_dirty_ = false;
 }
 
-auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+void BufferPoolManager::FinishWriteBack(const WriteBack &write_back) {
+  auto it = write_backs_.find(write_back.page_id_);
+  if (it != write_backs_.end() && it->second.seq_ == write_back.seq_) {
+    write_backs_.erase(it);
+  }
+}
+
+void BufferPoolManager::PinFrame(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  CountPin(frame_id, pages_[frame_id].pin_count_.fetch_add(1), access_type);
+  // Replay the hits first, so that the replacer sees the accesses in the order they happened.
+  DrainAccessLog();
+  replacer_->RecordAccess(frame_id, access_type, page_id);
+  replacer_->SetEvictable(frame_id, true);
+}
+
+void BufferPoolManager::UnpinFrame(frame_id_t frame_id, bool is_dirty) {
+  Page &page = pages_[frame_id];
+  // Mark the page dirty before dropping the pin, so that whoever evicts it sees the flag.
+  if (is_dirty) {
+    page.is_dirty_.store(true);
+  }
+  int pin_count = page.pin_count_.load();
+  while (pin_count > 0 && !page.pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+  }
+  if (pin_count == 1) {
+    // Pins taken by the flusher, FlushPage() or a checkpoint did not start an interval, and leave 0 here.
+    uint64_t pinned_since = pinned_since_[frame_id].exchange(0, std::memory_order_relaxed);
+    if (pinned_since != 0) {
+      counters_.Add(BufferPoolCounters::PIN_INTERVALS);
+      counters_.Add(BufferPoolCounters::PINNED_NS, SteadyNowNs() - pinned_since);
+    }
+  }
+}
+
+void BufferPoolManager::CountPin(frame_id_t frame_id, int pin_count, AccessType access_type) {
+  if (pin_count == 0) {
+    pinned_since_[frame_id].store(SteadyNowNs(), std::memory_order_relaxed);
+  }
+  auto type = static_cast<uint8_t>(access_type);
+  if (frame_access_type_[frame_id].load(std::memory_order_relaxed) != type) {
+    frame_access_type_[frame_id].store(type, std::memory_order_relaxed);
+  }
+}
+
+void BufferPoolManager::LogAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  auto &stripe = access_log_[BufferPoolCounters::ThreadStripe() % ACCESS_LOG_STRIPES];
+  uint64_t slot = stripe.head_.fetch_add(1, std::memory_order_relaxed);
+  uint64_t entry = (1ULL << 63) | (static_cast<uint64_t>(access_type) << 56) | (static_cast<uint64_t>(frame_id) << 32) |
+                   static_cast<uint32_t>(page_id);
+  stripe.entries_[slot % ACCESS_LOG_STRIPE_SIZE].store(entry, std::memory_order_release);
+  // Replay twice per lap, but never wait for the latch: if it is busy, entries may be overwritten before the next
+  // replay, and the replacer only sees a sample of the hits.
+  if ((slot + 1) % (ACCESS_LOG_STRIPE_SIZE / 2) == 0 && latch_.try_lock()) {
+    DrainAccessLog();
+    latch_.unlock();
+  }
+}
+
+void BufferPoolManager::DrainAccessLog() {
+  for (size_t i = 0; i < ACCESS_LOG_STRIPES; i++) {
+    auto &stripe = access_log_[i];
+    uint64_t head = stripe.head_.load(std::memory_order_acquire);
+    stripe.tail_ = std::max(stripe.tail_, head < ACCESS_LOG_STRIPE_SIZE ? 0 : head - ACCESS_LOG_STRIPE_SIZE);
+    for (; stripe.tail_ < head; stripe.tail_++) {
+      uint64_t entry = stripe.entries_[stripe.tail_ % ACCESS_LOG_STRIPE_SIZE].exchange(0, std::memory_order_acquire);
+      if (entry == 0) {
+        continue;
+      }
+      auto page_id = static_cast<page_id_t>(static_cast<uint32_t>(entry));
+      auto frame_id = static_cast<frame_id_t>((entry >> 32) & ((1U << 24) - 1));
+      auto access_type = static_cast<AccessType>((entry >> 56) & 0x7F);
+      if (pages_[frame_id].page_id_.load(std::memory_order_relaxed) == page_id) {
+        replacer_->RecordAccess(frame_id, access_type, page_id);
+      }
+    }
+  }
+}
+
+auto BufferPoolManager::ScheduleIo(bool is_write, char *data, page_id_t page_id, DiskRequestPriority priority,
+                                   std::function<void(bool)> on_complete) -> std::future<bool> {
+  auto promise = disk_scheduler_->CreatePromise();
+  auto future = promise.get_future();
+  disk_scheduler_->Schedule({is_write, data, page_id, std::move(promise), std::move(on_complete), priority});
+  return future;
+}
+
+auto BufferPoolManager::PrefetchPage(page_id_t page_id, AccessType access_type) -> bool {
   std::lock_guard<std::mutex> lock(latch_);
-  auto it = page_table_.find(page_id);
-  if (it == page_table_.end()) {
+  if (page_table_.Find(page_id) >= 0) {
     return true;
   }
-  if (pages_[it->second].GetPinCount() > 0) {
+  // Never read pages that were not allocated, and never wait for a write-back on behalf of a prefetch.
+  if (!IsAllocated(page_id) || write_backs_.count(page_id) > 0) {
     return false;
   }
-  if (pages_[it->second].IsDirty()) {
-    disk_manager_->WritePage(page_id, pages_[it->second].GetData());
+
+  frame_id_t id = -1;
+  if (!free_list_.empty()) {
+    id = free_list_.front();
+    free_list_.pop_front();
+  } else {
+    // Take the first clean victim, but leave earlier prefetches alone: they are about to be used.
+    page_id_t victim_page_id = INVALID_PAGE_ID;
+    for (auto candidate : replacer_->EvictionCandidates(PREFETCH_VICTIM_CANDIDATES)) {
+      if (static_cast<size_t>(candidate) < pool_size_ && !prefetched_[candidate] &&
+          (victim_page_id = TryClaimVictim(candidate, true)) != INVALID_PAGE_ID) {
+        id = candidate;
+        break;
+      }
+    }
+    if (id == -1) {
+      return false;
+    }
+    replacer_->Remove(id);
+    std::optional<WriteBack> write_back;
+    ReleaseVictim(id, victim_page_id, &write_back);
   }
-  replacer_->Remove(it->second);
-  free_list_.emplace_back(static_cast<int>(it->second));
-  pages_[it->second].ResetMemory();
-  // pages_[it->second].pin_count_++;
-  DeallocatePage(page_id);
+
+  // The frame stays pinned by the prefetch until the read completes, so it cannot be evicted under the read.
+  auto loaded = std::make_shared<std::promise<bool>>();
+  in_flight_.emplace(page_id, loaded->get_future().share());
+  pages_[id].is_dirty_ = false;
+  PinFrame(id, access_type, page_id);
+  page_table_.Insert(page_id, id);
+  prefetched_[id] = true;
+
+  ScheduleIo(false, pages_[id].data_, page_id, DiskRequestPriority::Prefetch, [this, id, page_id, loaded](bool ok) {
+    std::unique_lock<std::mutex> lock(latch_);
+    in_flight_.erase(page_id);
+    if (ok) {
+      pages_[id].page_id_ = page_id;
+      lock.unlock();
+      UnpinFrame(id, false);
+      loaded->set_value(true);
+      return;
+    }
+    page_table_.Erase(page_id);
+    lock.unlock();
+    loaded->set_value(false);
+    lock.lock();
+    AbandonFrame(id, &lock);
+  });
   return true;
 }
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManager::PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type) -> size_t {
+  // Let the OS read ahead too: a mapped or cached file then serves the prefetches below from memory.
+  disk_manager_->AdvisePages(first_page_id, num_pages,
+                             access_type == AccessType::Scan ? DiskAccessHint::Sequential : DiskAccessHint::WillNeed);
+  size_t prefetched = 0;
+  for (size_t i = 0; i < num_pages; i++) {
+    if (PrefetchPage(first_page_id + static_cast<page_id_t>(i), access_type)) {
+      prefetched++;
+    }
+  }
+  return prefetched;
+}
+
+void BufferPoolManager::StartBackgroundFlusher(const BackgroundFlusherOptions &options) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (flusher_thread_.has_value()) {
+    return;
+  }
+  flusher_options_ = options;
+  flusher_stop_ = false;
+  flusher_thread_.emplace([this] { RunBackgroundFlusher(); });
+}
+
+void BufferPoolManager::StopBackgroundFlusher() {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    if (!flusher_thread_.has_value()) {
+      return;
+    }
+    flusher_stop_ = true;
+  }
+  flusher_cv_.notify_all();
+  flusher_thread_->join();
+  flusher_thread_.reset();
+}
+
+auto BufferPoolManager::GetBackgroundFlusherStats() -> BackgroundFlusherStats {
+  return {pages_cleaned_.load(std::memory_order_relaxed), write_backs_avoided_.load(std::memory_order_relaxed),
+          counters_.Get(BufferPoolCounters::DIRTY_WRITE_BACKS)};
+}
+
+void BufferPoolManager::SetReplacer(const std::string &policy) {
+  std::lock_guard<std::mutex> resize_lock(resize_latch_);
+  // Build the new replacer first, so that an unknown policy leaves the pool untouched.
+  auto replacer = MakeReplacer(policy, pool_size_, replacer_k_);
+  std::lock_guard<std::mutex> lock(latch_);
+  InstallReplacer(std::move(replacer));
+  replacer_policy_ = policy;
+}
+
+void BufferPoolManager::InstallReplacer(std::unique_ptr<Replacer> replacer) {
+  DrainAccessLog();
+  // The new policy starts without history: every page in the table, including those still being read in, is seeded
+  // with one access of its last type.
+  for (auto page_id : page_table_.PageIds()) {
+    auto frame_id = page_table_.Find(page_id);
+    replacer->RecordAccess(frame_id, static_cast<AccessType>(frame_access_type_[frame_id].load()), page_id);
+    replacer->SetEvictable(frame_id, true);
+  }
+  replacer_ = std::move(replacer);
+}
+
+void BufferPoolManager::Resize(size_t pool_size) {
+  std::lock_guard<std::mutex> resize_lock(resize_latch_);
+  // An access log entry has 24 bits for the frame id.
+  if (pool_size == 0 || pool_size > pages_.MaxCapacity() || pool_size >= (1U << 24)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "invalid buffer pool size: " + std::to_string(pool_size));
+  }
+  const size_t old_size = pool_size_;
+  if (pool_size == old_size) {
+    return;
+  }
+  // Once the resize is done, every page is in a frame below the new size, so the replacer is sized for it.
+  auto replacer = MakeReplacer(replacer_policy_, pool_size, replacer_k_);
+
+  if (pool_size > old_size) {
+    // Frames left over from an earlier shrink are reused before new chunks are added.
+    while (pages_.Capacity() < pool_size) {
+      AddFrameChunk();
+    }
+    std::lock_guard<std::mutex> lock(latch_);
+    page_table_.Reserve(pool_size);
+    InstallReplacer(std::move(replacer));
+    for (size_t i = old_size; i < pool_size; i++) {
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    pool_size_ = pool_size;
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(latch_);
+  // From here on, no new page goes into a frame at or past the new size.
+  pool_size_ = pool_size;
+  free_list_.remove_if([pool_size](frame_id_t id) { return static_cast<size_t>(id) >= pool_size; });
+  for (size_t i = pool_size; i < old_size; i++) {
+    DrainFrame(static_cast<frame_id_t>(i), &lock);
+  }
+  InstallReplacer(std::move(replacer));
+  lock.unlock();
+
+  // Nothing is read into the drained frames before they are added back, so their memory can go.
+  for (size_t i = pool_size; i < old_size;) {
+    size_t arena_index = 0;
+    size_t offset = i;
+    if (i >= pages_.FirstBlockSize()) {
+      arena_index = 1 + (i - pages_.FirstBlockSize()) / FrameArray<Page>::CHUNK_SIZE;
+      offset = (i - pages_.FirstBlockSize()) % FrameArray<Page>::CHUNK_SIZE;
+    }
+    const size_t arena_frames =
+        arena_index == 0 ? pages_.FirstBlockSize() : static_cast<size_t>(FrameArray<Page>::CHUNK_SIZE);
+    const size_t count = std::min(arena_frames - offset, old_size - i);
+    arenas_[arena_index]->Discard(static_cast<frame_id_t>(offset), count);
+    i += count;
+  }
+}
+
+void BufferPoolManager::AddFrameChunk() {
+  auto arena = std::make_unique<FrameArena>(FrameArray<Page>::CHUNK_SIZE, buffer_pool_huge_pages.load());
+  const size_t first_frame_id = pages_.Capacity();
+  pages_.AddChunk([&arena, first_frame_id](Page *page, size_t i) {
+    new (page) Page(arena->GetFrame(static_cast<frame_id_t>(i - first_frame_id)));
+  });
+  prefetched_.AddChunk();
+  frame_access_type_.AddChunk();
+  pinned_since_.AddChunk();
+  std::lock_guard<std::mutex> lock(latch_);
+  arenas_.push_back(std::move(arena));
+  cleaned_by_flusher_.resize(pages_.Capacity(), false);
+}
+
+void BufferPoolManager::DrainFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  Page &page = pages_[frame_id];
+  while (true) {
+    // A frame that is being read into, or handed to a new page, is pinned until its page id is set.
+    if (page.page_id_.load() == INVALID_PAGE_ID && page.pin_count_.load() == 0) {
+      return;
+    }
+    page_id_t page_id = TryClaimVictim(frame_id, false);
+    if (page_id != INVALID_PAGE_ID) {
+      replacer_->Remove(frame_id);
+      std::optional<WriteBack> write_back;
+      ReleaseVictim(frame_id, page_id, &write_back);
+      if (!write_back.has_value()) {
+        return;
+      }
+      lock->unlock();
+      const bool written = write_back->done_.get();
+      lock->lock();
+      if (written) {
+        FinishWriteBack(*write_back);
+        return;
+      }
+      // The page stays in the frame until a later write-back of it succeeds.
+      if (!RestoreVictim(frame_id, *write_back, lock)) {
+        return;
+      }
+    }
+    // Pinned: nothing wakes us up when the last pin goes, so poll without the latch.
+    lock->unlock();
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    lock->lock();
+  }
+}
+
+auto BufferPoolManager::GetStats() -> BufferPoolStats {
+  auto stats = counters_.Snapshot();
+  for (size_t i = 0; i < pages_.Capacity(); i++) {
+    if (pages_[i].page_id_.load(std::memory_order_relaxed) != INVALID_PAGE_ID) {
+      stats.frames_by_access_type_[frame_access_type_[i].load(std::memory_order_relaxed)]++;
+    }
+  }
+  return stats;
+}
+
+void BufferPoolManager::RunBackgroundFlusher() {
+  const auto options = flusher_options_;
+  const auto window = static_cast<size_t>(std::ceil(options.target_clean_ratio_ * static_cast<double>(pool_size_)));
+  // Token bucket for the per-second limit; a full bucket holds one round's worth of writes.
+  auto tokens = static_cast<double>(options.max_pages_per_round_);
+  auto last_refill = std::chrono::steady_clock::now();
+
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    flusher_cv_.wait_for(lock, options.interval_, [&] { return flusher_stop_; });
+    if (flusher_stop_) {
+      return;
+    }
+    lock.unlock();
+
+    size_t budget = options.max_pages_per_round_;
+    if (options.max_pages_per_sec_ > 0) {
+      auto now = std::chrono::steady_clock::now();
+      std::chrono::duration<double> elapsed = now - last_refill;
+      last_refill = now;
+      tokens = std::min(tokens + elapsed.count() * static_cast<double>(options.max_pages_per_sec_),
+                        static_cast<double>(options.max_pages_per_round_));
+      budget = static_cast<size_t>(tokens);
+    }
+    if (budget > 0 && window > 0) {
+      std::vector<frame_id_t> candidates;
+      {
+        // The replacer may be swapped by SetReplacer() at any time.
+        std::lock_guard<std::mutex> replacer_lock(latch_);
+        candidates = replacer_->EvictionCandidates(window);
+      }
+      auto written = CleanFrames(candidates, budget);
+      tokens -= static_cast<double>(written);
+    }
+
+    lock.lock();
+  }
+}
+
+auto BufferPoolManager::CleanFrames(const std::vector<frame_id_t> &frames, size_t budget) -> size_t {
+  std::vector<frame_id_t> pinned;
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    for (auto id : frames) {
+      if (pinned.size() == budget) {
+        break;
+      }
+      Page &page = pages_[id];
+      // The frame may have been pinned or evicted since the replacer listed it.
+      if (page.GetPageId() == INVALID_PAGE_ID || page.GetPinCount() > 0 || !page.IsDirty()) {
+        continue;
+      }
+      // Pin without recording an access, so that the frame keeps its place in the eviction order.
+      page.pin_count_.fetch_add(1);
+      pinned.push_back(id);
+    }
+  }
+
+  // Never block on a page latch while holding others: a page that is being modified right now is left for later.
+  std::vector<std::pair<frame_id_t, std::future<bool>>> writes;
+  for (auto id : pinned) {
+    Page &page = pages_[id];
+    if (!page.TryRLatch()) {
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(latch_);
+      page.is_dirty_ = false;
+    }
+    writes.emplace_back(id, ScheduleIo(true, page.GetData(), page.GetPageId(), DiskRequestPriority::Background));
+  }
+  size_t written = 0;
+  for (auto &[id, done] : writes) {
+    if (done.get()) {
+      written++;
+    } else {
+      pages_[id].is_dirty_ = true;
+    }
+    pages_[id].RUnlatch();
+  }
+
+  std::lock_guard<std::mutex> lock(latch_);
+  for (auto &[id, done] : writes) {
+    // A page dirtied again during the write is not clean, and its eviction will not count as avoided.
+    cleaned_by_flusher_[id] = !pages_[id].IsDirty();
+  }
+  for (auto id : pinned) {
+    UnpinFrame(id, false);
+  }
+  pages_cleaned_.fetch_add(written, std::memory_order_relaxed);
+  return written;
+}
 
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard {
-  Page *page = FetchPage(page_id);
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
+  Page *page = FetchPage(page_id, access_type);
   return {this, page};
 }
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
-  Page *page = FetchPage(page_id);
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+  Page *page = FetchPage(page_id, access_type);
   if (page != nullptr) {
     page->RLatch();
   }
   return {this, page};
 }
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
   // if (page_id < 0) {
   //   std::cout << "卧槽"
   //             << " 真有你的" << std::endl;
   // }
-  Page *page = FetchPage(page_id);
+  Page *page = FetchPage(page_id, access_type);
   if (page != nullptr) {
     page->WLatch();
   }
   return {this, page};
 }
 
-auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard {
-  Page *page = NewPage(page_id);
+auto BufferPoolManager::FetchPageOptimistic(page_id_t page_id, AccessType access_type) -> OptimisticPageGuard {
+  // Read the version before the page id: if the frame is taken away after the page id check, the version has moved.
+  if (frame_id_t id = page_table_.Find(page_id); id >= 0) {
+    Page &page = pages_[id];
+    uint64_t version = page.GetVersion();
+    if (page.page_id_.load() == page_id) {
+      if (version % 2 == 1) {
+        return {};
+      }
+      LogAccess(id, page_id, access_type);
+      counters_.Add(BufferPoolCounters::HITS);
+      return {&page, page_id, version};
+    }
+  }
+
+  // The page is not resident, or is being read in. Pin it until it is loaded, and take the version under the pin.
+  Page *page = FetchPage(page_id, access_type);
+  if (page == nullptr) {
+    return {};
+  }
+  uint64_t version = page->GetVersion();
+  UnpinPage(page_id, false);
+  if (version % 2 == 1) {
+    return {};
+  }
+  return {page, page_id, version};
+}
+
+auto BufferPoolManager::NewPageGuarded(page_id_t *page_id, segment_id_t segment) -> BasicPageGuard {
+  Page *page = NewPage(page_id, segment);
   return {this, page};
 }
 
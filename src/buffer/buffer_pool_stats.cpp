@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <functional>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+auto BufferPoolStats::HitRatio() const -> double {
+  const uint64_t fetches = hits_ + misses_;
+  return fetches == 0 ? 0.0 : static_cast<double>(hits_) / static_cast<double>(fetches);
+}
+
+auto BufferPoolStats::AveragePinDuration() const -> std::chrono::nanoseconds {
+  return pin_intervals_ == 0 ? std::chrono::nanoseconds(0) : pinned_time_ / static_cast<int64_t>(pin_intervals_);
+}
+
+auto BufferPoolStats::operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  evictions_ += other.evictions_;
+  dirty_write_backs_ += other.dirty_write_backs_;
+  pin_waits_ += other.pin_waits_;
+  pin_intervals_ += other.pin_intervals_;
+  pinned_time_ += other.pinned_time_;
+  for (size_t i = 0; i < NUM_ACCESS_TYPES; i++) {
+    frames_by_access_type_[i] += other.frames_by_access_type_[i];
+  }
+  return *this;
+}
+
+auto BufferPoolCounters::Get(Counter counter) const -> uint64_t {
+  uint64_t sum = 0;
+  for (const auto &stripe : stripes_) {
+    sum += stripe.counters_[counter].load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+auto BufferPoolCounters::Snapshot() const -> BufferPoolStats {
+  BufferPoolStats stats;
+  stats.hits_ = Get(HITS);
+  stats.misses_ = Get(MISSES);
+  stats.evictions_ = Get(EVICTIONS);
+  stats.dirty_write_backs_ = Get(DIRTY_WRITE_BACKS);
+  stats.pin_waits_ = Get(PIN_WAITS);
+  stats.pin_intervals_ = Get(PIN_INTERVALS);
+  stats.pinned_time_ = std::chrono::nanoseconds(Get(PINNED_NS));
+  return stats;
+}
+
+auto BufferPoolCounters::ThreadStripe() -> size_t {
+  static thread_local const size_t stripe = std::hash<std::thread::id>{}(std::this_thread::get_id()) % STRIPES;
+  return stripe;
+}
+
+}  // namespace bustub
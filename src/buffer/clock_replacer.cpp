@@ -12,18 +12,115 @@
 
 #include "buffer/clock_replacer.h"
 
+#include "common/exception.h"
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : tracked_(num_pages), evictable_(num_pages), referenced_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void ClockReplacer::CheckFrame(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= tracked_.size()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id is out of the replacer's range");
+  }
+}
+
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  // Within two sweeps, every reference bit has been cleared once.
+  const size_t num_frames = tracked_.size();
+  for (size_t step = 0; step < 2 * num_frames; step++) {
+    size_t frame = hand_;
+    hand_ = (hand_ + 1) % num_frames;
+    if (!evictable_[frame]) {
+      continue;
+    }
+    if (referenced_[frame]) {
+      referenced_[frame] = false;
+      continue;
+    }
+    *frame_id = static_cast<frame_id_t>(frame);
+    tracked_[frame] = false;
+    evictable_[frame] = false;
+    curr_size_--;
+    return true;
+  }
+  return false;
+}
+
+void ClockReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type,
+                                 [[maybe_unused]] page_id_t page_id) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  tracked_[frame_id] = true;
+  referenced_[frame_id] = true;
+}
+
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  if (!tracked_[frame_id] || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  if (!tracked_[frame_id]) {
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    throw Exception(ExceptionType::INVALID, "cannot remove a non-evictable frame");
+  }
+  tracked_[frame_id] = false;
+  evictable_[frame_id] = false;
+  referenced_[frame_id] = false;
+  curr_size_--;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+auto ClockReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return curr_size_;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+auto ClockReplacer::EvictionCandidates(size_t n) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  // The hand takes the unreferenced frames in its first sweep, and the referenced ones in its second.
+  std::vector<frame_id_t> candidates;
+  const size_t num_frames = tracked_.size();
+  for (bool referenced : {false, true}) {
+    for (size_t step = 0; step < num_frames && candidates.size() < n; step++) {
+      size_t frame = (hand_ + step) % num_frames;
+      if (evictable_[frame] && referenced_[frame] == referenced) {
+        candidates.push_back(static_cast<frame_id_t>(frame));
+      }
+    }
+  }
+  return candidates;
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  CheckFrame(frame_id);
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    if (evictable_[frame_id]) {
+      return;
+    }
+  }
+  RecordAccess(frame_id);
+  SetEvictable(frame_id, true);
+}
 
 }  // namespace bustub
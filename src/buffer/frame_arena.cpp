@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+/** Size of a transparent huge page on x86-64 and on most aarch64 kernels. */
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+FrameArena::FrameArena(size_t num_frames, bool huge_pages) {
+  const size_t frames_size = num_frames * static_cast<size_t>(BUSTUB_PAGE_SIZE);
+  const size_t granularity = huge_pages ? HUGE_PAGE_SIZE : FRAME_ALIGNMENT;
+  size_ = std::max<size_t>((frames_size + granularity - 1) / granularity * granularity, granularity);
+
+  void *data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data != MAP_FAILED) {
+    mapped_ = true;
+#ifdef MADV_HUGEPAGE
+    if (huge_pages && madvise(data, size_, MADV_HUGEPAGE) != 0) {
+      LOG_WARN("transparent huge pages are not available for the buffer pool");
+    }
+#endif
+  } else {
+    data = std::aligned_alloc(FRAME_ALIGNMENT, size_);
+    if (data == nullptr) {
+      throw std::bad_alloc();
+    }
+    memset(data, 0, size_);
+  }
+  data_ = static_cast<char *>(data);
+}
+
+FrameArena::~FrameArena() {
+  if (mapped_) {
+    munmap(data_, size_);
+  } else {
+    std::free(data_);  // NOLINT
+  }
+}
+
+void FrameArena::Discard(frame_id_t first, size_t count) {
+  char *begin = GetFrame(first);
+  const size_t length = count * static_cast<size_t>(BUSTUB_PAGE_SIZE);
+  // MADV_DONTNEED drops anonymous private pages, which then fault back in zero-filled.
+  if (!mapped_ || madvise(begin, length, MADV_DONTNEED) != 0) {
+    memset(begin, 0, length);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.cpp
+//
+// Identification: src/buffer/free_page_map.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/free_page_map.h"
+
+#include <algorithm>
+#include <bitset>
+#include <utility>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+FreePageMap::FreePageMap(DiskManager *disk_manager, uint32_t num_instances, uint32_t instance_index)
+    : disk_manager_(disk_manager),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      max_slots_((static_cast<size_t>(DEFAULT_SEGMENT_PAGES) - instance_index + num_instances - 1) / num_instances) {
+  BUSTUB_ASSERT(instance_index < num_instances, "instance index out of range");
+  if (disk_manager_ == nullptr) {
+    return;
+  }
+  std::vector<uint64_t> map_page(WORDS_PER_MAP_PAGE);
+  for (size_t k = 0;; k++) {
+    if (!disk_manager_->ReadFreeMapPage(k * num_instances_ + instance_index_,
+                                        reinterpret_cast<char *>(map_page.data()))) {
+      break;
+    }
+    words_.insert(words_.end(), map_page.begin(), map_page.end());
+    dirty_.push_back(false);
+  }
+  for (auto word : words_) {
+    num_allocated_ += std::bitset<64>(word).count();
+  }
+}
+
+auto FreePageMap::Allocate(size_t count) -> std::vector<page_id_t> {
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(count);
+  std::lock_guard<std::mutex> lock(latch_);
+  size_t w = first_free_word_;
+  while (page_ids.size() < count && w * 64 < max_slots_) {
+    if (w == words_.size()) {
+      // Every page is in use: extend the map by one map page, i.e. let the file grow.
+      words_.resize(words_.size() + WORDS_PER_MAP_PAGE, 0);
+      dirty_.push_back(true);
+    }
+    if (words_[w] == ~uint64_t{0}) {
+      w++;
+      continue;
+    }
+    auto bit = static_cast<size_t>(__builtin_ctzll(~words_[w]));
+    if (w * 64 + bit >= max_slots_) {
+      break;
+    }
+    words_[w] |= uint64_t{1} << bit;
+    dirty_[w / WORDS_PER_MAP_PAGE] = true;
+    page_ids.push_back(ToPageId(w * 64 + bit));
+  }
+  first_free_word_ = w;
+  num_allocated_ += page_ids.size();
+  return page_ids;
+}
+
+void FreePageMap::Free(page_id_t page_id) {
+  if (page_id < 0) {
+    return;
+  }
+  BUSTUB_ASSERT(static_cast<uint32_t>(page_id) % num_instances_ == instance_index_,
+                "page does not belong to this instance");
+  size_t slot = static_cast<size_t>(page_id) / num_instances_;
+  std::lock_guard<std::mutex> lock(latch_);
+  size_t w = slot / 64;
+  uint64_t mask = uint64_t{1} << (slot % 64);
+  if (w >= words_.size() || (words_[w] & mask) == 0) {
+    return;
+  }
+  words_[w] &= ~mask;
+  dirty_[w / WORDS_PER_MAP_PAGE] = true;
+  first_free_word_ = std::min(first_free_word_, w);
+  num_allocated_--;
+}
+
+auto FreePageMap::IsAllocated(page_id_t page_id) -> bool {
+  if (page_id < 0 || static_cast<uint32_t>(page_id) % num_instances_ != instance_index_) {
+    return false;
+  }
+  size_t slot = static_cast<size_t>(page_id) / num_instances_;
+  std::lock_guard<std::mutex> lock(latch_);
+  return slot / 64 < words_.size() && (words_[slot / 64] & (uint64_t{1} << (slot % 64))) != 0;
+}
+
+auto FreePageMap::End() -> page_id_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  for (size_t w = words_.size(); w > 0; w--) {
+    if (words_[w - 1] != 0) {
+      return ToPageId((w - 1) * 64 + 64 - static_cast<size_t>(__builtin_clzll(words_[w - 1])));
+    }
+  }
+  return ToPageId(0);
+}
+
+auto FreePageMap::NumAllocated() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return num_allocated_;
+}
+
+void FreePageMap::Flush() {
+  if (disk_manager_ == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> flush_lock(flush_latch_);
+  std::vector<std::pair<size_t, std::vector<uint64_t>>> map_pages;
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    for (size_t k = 0; k < dirty_.size(); k++) {
+      if (dirty_[k]) {
+        auto begin = words_.begin() + static_cast<std::ptrdiff_t>(k * WORDS_PER_MAP_PAGE);
+        map_pages.emplace_back(k, std::vector<uint64_t>(begin, begin + WORDS_PER_MAP_PAGE));
+        dirty_[k] = false;
+      }
+    }
+  }
+  // Only the flush latch is held across the writes; a page changed meanwhile is dirty again and goes out next time.
+  for (const auto &[k, map_page] : map_pages) {
+    disk_manager_->WriteFreeMapPage(k * num_instances_ + instance_index_,
+                                    reinterpret_cast<const char *>(map_page.data()));
+  }
+}
+
+}  // namespace bustub
@@ -11,210 +11,242 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/lru_k_replacer.h"
+#include <algorithm>
 #include <cstddef>
-#include <iterator>
+#include <functional>
+#include <queue>
 #include <utility>
 #include "common/config.h"
 #include "common/exception.h"
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+void LRUKFrameHeap::Push(frame_id_t frame_id, size_t key) {
+  heap_.emplace_back(key, frame_id);
+  pos_[frame_id] = heap_.size() - 1;
+  SiftUp(heap_.size() - 1);
+}
+
+void LRUKFrameHeap::Erase(frame_id_t frame_id) {
+  size_t idx = pos_[frame_id];
+  pos_[frame_id] = NPOS;
+  auto last = heap_.back();
+  heap_.pop_back();
+  if (idx == heap_.size()) {
+    return;
+  }
+  // Move the last entry into the hole; it may have to travel either way.
+  Place(idx, last);
+  SiftUp(idx);
+  SiftDown(pos_[last.second]);
+}
+
+void LRUKFrameHeap::Update(frame_id_t frame_id, size_t key) {
+  size_t idx = pos_[frame_id];
+  size_t old_key = heap_[idx].first;
+  heap_[idx].first = key;
+  if (key < old_key) {
+    SiftUp(idx);
+  } else {
+    SiftDown(idx);
+  }
+}
+
+void LRUKFrameHeap::Smallest(size_t n, std::vector<frame_id_t> *out) const {
+  // Best-first walk of the heap: a node can only be among the n smallest if its parent is.
+  std::priority_queue<std::pair<size_t, size_t>, std::vector<std::pair<size_t, size_t>>, std::greater<>> frontier;
+  if (!heap_.empty()) {
+    frontier.emplace(heap_[0].first, 0);
+  }
+  for (; n > 0 && !frontier.empty(); n--) {
+    size_t idx = frontier.top().second;
+    frontier.pop();
+    out->push_back(heap_[idx].second);
+    for (size_t child = idx * 2 + 1; child <= idx * 2 + 2 && child < heap_.size(); child++) {
+      frontier.emplace(heap_[child].first, child);
+    }
+  }
+}
+
+void LRUKFrameHeap::SiftUp(size_t idx) {
+  auto entry = heap_[idx];
+  while (idx > 0) {
+    size_t parent = (idx - 1) / 2;
+    if (heap_[parent].first <= entry.first) {
+      break;
+    }
+    Place(idx, heap_[parent]);
+    idx = parent;
+  }
+  Place(idx, entry);
+}
+
+void LRUKFrameHeap::SiftDown(size_t idx) {
+  auto entry = heap_[idx];
+  size_t size = heap_.size();
+  while (true) {
+    size_t child = idx * 2 + 1;
+    if (child >= size) {
+      break;
+    }
+    if (child + 1 < size && heap_[child + 1].first < heap_[child].first) {
+      child++;
+    }
+    if (entry.first <= heap_[child].first) {
+      break;
+    }
+    Place(idx, heap_[child]);
+    idx = child;
+  }
+  Place(idx, entry);
+}
+
+void LRUKFrameHeap::Place(size_t idx, std::pair<size_t, frame_id_t> entry) {
+  heap_[idx] = entry;
+  pos_[entry.second] = idx;
+}
+
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : node_store_(num_frames),
+      history_(num_frames * k),
+      scan_(num_frames),
+      below_k_(num_frames),
+      over_k_(num_frames),
+      replacer_size_(num_frames),
+      k_(k) {
+  BUSTUB_ASSERT(k > 0, "k must be positive");
+  for (size_t i = 0; i < num_frames; i++) {
+    node_store_[i].fid_ = static_cast<frame_id_t>(i);
+  }
+}
+
+void LRUKReplacer::CheckFrame(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id is out of the replacer's range");
+  }
+}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
-  // latch_.lock();
   std::lock_guard<std::mutex> lock(latch_);
   if (curr_size_ < 1) {
     return false;
   }
-  frame_id_t temp_t;
-  if (!below_.empty()) {  // 选择 below  中最小的删除
-    temp_t = *below_.begin();
-    below_k_.erase(temp_t);
-    below_.pop_front();
-  } else {  // 选择 over  中 最大的删除
-    temp_t = *over_.begin();
-    over_k_.erase(temp_t);
-    over_.pop_front();
+  // 先淘汰只被扫描过的帧，再淘汰距离为 +inf 的帧，最后淘汰第 k 次访问最早的帧
+  auto *pool = &scan_;
+  if (pool->Empty()) {
+    pool = below_k_.Empty() ? &over_k_ : &below_k_;
   }
-  node_store_.erase(temp_t);
+  frame_id_t victim = pool->Top();
+  pool->Erase(victim);
+  ResetNode(&node_store_[victim]);
 
-  *frame_id = temp_t;
+  *frame_id = victim;
   curr_size_--;
-
   return true;
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {
-  if (frame_id < 0 || frame_id >= static_cast<int>(replacer_size_)) {
-    exit(-1);  // 帧的大小 小于0 或者 大于了 替换器大小，无法访问。
-  }
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, [[maybe_unused]] page_id_t page_id) {
+  CheckFrame(frame_id);
   std::lock_guard<std::mutex> lock(latch_);
-  if (node_store_.find(frame_id) != node_store_.end()) {
-    node_store_[frame_id].history_.push_back(current_timestamp_);
-    if (node_store_[frame_id].is_evictable_) {
-      // current frame is evictable
-      size_t dis;
-      if (node_store_[frame_id].k_ < k_) {
-        node_store_[frame_id].k_++;
-        if (node_store_[frame_id].k_ == k_) {
-          // node_store_[frame_id].history_.begin()
-          dis = below_k_[frame_id];
-          std::pair<frame_id_t, size_t> new_temp = std::make_pair(frame_id, dis);
-          below_k_.erase(frame_id);
-          below_.remove(frame_id);  // 删掉，纯净一些
-          auto it = over_.begin();
-          while (it != over_.end()) {
-            if (over_k_.find(*it)->second > new_temp.second) {
-              over_.insert(it, frame_id);
-              break;
-            }
-            it++;
-          }
-          if (it == over_.end()) {
-            over_.push_back(frame_id);
-          }
-          over_k_.insert(new_temp);
-        }
-      } else if (node_store_[frame_id].k_ == k_) {
-        node_store_[frame_id].history_.pop_front();
-        dis = static_cast<size_t>(*node_store_[frame_id].history_.begin());
-        std::pair<frame_id_t, size_t> new_temp = std::make_pair(frame_id, dis);
-        over_.remove(frame_id);
-        over_k_.erase(frame_id);
-        auto it = over_.begin();
-        while (it != over_.end()) {
-          if (over_k_.find(*it)->second > new_temp.second) {
-            over_.insert(it, frame_id);
-            break;
-          }
-          it++;
-        }
-        if (it == over_.end()) {
-          over_.push_back(frame_id);
-        }
-        over_k_.insert(new_temp);
-      }
-
-    } else {
-      if (node_store_[frame_id].k_ < k_) {
-        node_store_[frame_id].k_++;
-      } else if (node_store_[frame_id].k_ == k_) {
-        node_store_[frame_id].history_.pop_front();
-      }
-    }
+  auto &node = node_store_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (is_scan && node.k_ > 0) {
+    // 扫描不会提升已在缓冲池中的页
+    return;
+  }
+  if (node.is_scan_ && node.is_evictable_) {
+    // 第一次非扫描访问：离开扫描池，下面按普通帧重新入堆
+    scan_.Erase(frame_id);
+  }
+  node.is_scan_ = is_scan;
+
+  size_t *ring = &history_[frame_id * k_];
+  auto &old_pool = PoolOf(node);
+  if (node.k_ < k_) {
+    ring[(node.head_ + node.k_) % k_] = current_timestamp_;
+    node.k_++;
   } else {
-    auto *node = new LRUKNode();
-    node->history_.push_back(current_timestamp_);
-    node->k_++;
-    node->fid_ = frame_id;
-    // node_store_[frame_id]=*node;
-    node_store_.insert(std::make_pair(frame_id, *node));
-    delete node;
+    // 覆盖最旧的时间戳，新的最旧时间戳就是第 k 次最近访问
+    ring[node.head_] = current_timestamp_;
+    node.head_ = (node.head_ + 1) % k_;
   }
   current_timestamp_++;
+
+  if (!node.is_evictable_) {
+    return;
+  }
+  auto &new_pool = PoolOf(node);
+  if (!old_pool.Contains(frame_id)) {
+    new_pool.Push(frame_id, Key(node));
+  } else if (&old_pool != &new_pool) {
+    // 第 k 次访问：从 +inf 池移到 k-distance 池
+    old_pool.Erase(frame_id);
+    new_pool.Push(frame_id, Key(node));
+  } else if (&new_pool == &over_k_) {
+    over_k_.Update(frame_id, Key(node));
+  }
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
-  if (frame_id < 0 || frame_id >= static_cast<int>(replacer_size_)) {
-    exit(-1);  // 帧的大小 小于0 或者 大于了 替换器大小，无法访问。
-  }
+  CheckFrame(frame_id);
   std::lock_guard<std::mutex> lock(latch_);
-  if (node_store_.find(frame_id) == node_store_.end()) {
-    // node_store_ don't include such frameid
-    exit(-1);
-  }
-  if (node_store_[frame_id].is_evictable_ ^ set_evictable) {
-    node_store_[frame_id].is_evictable_ = set_evictable;
-    if (set_evictable) {
-      curr_size_++;
-      if (node_store_[frame_id].k_ < k_) {
-        // insert into below_k_
-        std::pair<frame_id_t, size_t> new_temp =
-            std::make_pair(frame_id, static_cast<size_t>(*node_store_[frame_id].history_.begin()));
-        auto it = below_.begin();
-        while (it != below_.end()) {
-          if (below_k_.find(*it)->second > new_temp.second) {
-            below_.insert(it, frame_id);
-            break;
-          }
-          it++;
-        }
-        if (it == below_.end()) {
-          below_.push_back(frame_id);
-        }
-        below_k_.insert(new_temp);
-      } else {
-        // insert into over_k_
-        std::pair<frame_id_t, size_t> new_temp =
-            std::make_pair(frame_id, static_cast<size_t>(*node_store_[frame_id].history_.begin()));
-        auto it = over_.begin();
-        while (it != over_.end()) {
-          if (over_k_.find(*it)->second > new_temp.second) {
-            over_.insert(it, frame_id);
-            break;
-          }
-          it++;
-        }
-        if (it == over_.end()) {
-          over_.push_back(frame_id);
-        }
-        over_k_.insert(new_temp);
-      }
-    } else {
-      curr_size_--;
-      if (node_store_[frame_id].k_ < k_) {
-        below_k_.erase(frame_id);
-        below_.remove(frame_id);
-      } else {
-        over_k_.erase(frame_id);
-        over_.remove(frame_id);
-      }
-    }
+  auto &node = node_store_[frame_id];
+  if (node.k_ == 0 || node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    PoolOf(node).Push(frame_id, Key(node));
+    curr_size_++;
+  } else {
+    PoolOf(node).Erase(frame_id);
+    curr_size_--;
   }
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
-  if (frame_id < 0 || frame_id >= static_cast<int>(replacer_size_)) {
-    exit(-1);  // 帧的大小 小于0 或者 大于了 替换器大小，无法访问。
-  }
+  CheckFrame(frame_id);
   std::lock_guard<std::mutex> lock(latch_);
-  if (node_store_.find(frame_id) == node_store_.end()) {
-    // this frame_id is non-evictable;
+  auto &node = node_store_[frame_id];
+  if (node.k_ == 0) {
     return;
   }
-  if (!node_store_.find(frame_id)->second.is_evictable_) {
-    // this frame_id is non-evictable;
-    exit(-1);
+  if (!node.is_evictable_) {
+    throw Exception(ExceptionType::INVALID, "cannot remove a non-evictable frame");
   }
-  if (node_store_[frame_id].k_ < k_) {
-    below_k_.erase(frame_id);
-    below_.remove(frame_id);
-  } else {
-    over_k_.erase(frame_id);
-    over_.remove(frame_id);
+  PoolOf(node).Erase(frame_id);
+  ResetNode(&node);
+  curr_size_--;
+}
+
+auto LRUKReplacer::EvictionCandidates(size_t n) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  candidates.reserve(std::min(n, curr_size_));
+  for (const auto *pool : {&scan_, &below_k_, &over_k_}) {
+    pool->Smallest(n - candidates.size(), &candidates);
   }
-  node_store_.erase(frame_id);
+  return candidates;
+}
 
-  curr_size_--;
+void LRUKReplacer::ResetNode(LRUKNode *node) {
+  node->head_ = 0;
+  node->k_ = 0;
+  node->is_evictable_ = false;
+  node->is_scan_ = false;
 }
 
 auto LRUKReplacer::Size() -> size_t {
   std::lock_guard<std::mutex> lock(latch_);
   return curr_size_;
 }
-auto LRUKReplacer::MyCmp(std::pair<frame_id_t, size_t> elem1, std::pair<frame_id_t, size_t> elem2) -> bool {
-  return elem1.second >= elem2.second;
-}
 
 void LRUKReplacer::Eroll(frame_id_t frame_id) {
-  auto cont = node_store_[frame_id].history_;
-  for (auto &it : cont) {
-    std::cout << static_cast<size_t>(it) << std::endl;
-  }
-  // for (auto &it : over_) {
-  //   std::cout << it;
-  // }
-  // std::cout << std::endl;
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  const auto &node = node_store_[frame_id];
+  for (size_t i = 0; i < node.k_; i++) {
+    std::cout << history_[frame_id * k_ + (node.head_ + i) % k_] << std::endl;
+  }
 }
 }  // namespace bustub
@@ -12,18 +12,102 @@
 
 #include "buffer/lru_replacer.h"
 
+#include "common/exception.h"
+
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : pos_(num_pages), tracked_(num_pages), evictable_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void LRUReplacer::CheckFrame(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= tracked_.size()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id is out of the replacer's range");
+  }
+}
+
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  for (auto it = lru_list_.begin(); it != lru_list_.end(); ++it) {
+    if (evictable_[*it]) {
+      *frame_id = *it;
+      tracked_[*it] = false;
+      evictable_[*it] = false;
+      lru_list_.erase(it);
+      curr_size_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+void LRUReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type,
+                               [[maybe_unused]] page_id_t page_id) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  if (tracked_[frame_id]) {
+    lru_list_.splice(lru_list_.end(), lru_list_, pos_[frame_id]);
+    return;
+  }
+  tracked_[frame_id] = true;
+  pos_[frame_id] = lru_list_.insert(lru_list_.end(), frame_id);
+}
+
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  if (!tracked_[frame_id] || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  if (!tracked_[frame_id]) {
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    throw Exception(ExceptionType::INVALID, "cannot remove a non-evictable frame");
+  }
+  lru_list_.erase(pos_[frame_id]);
+  tracked_[frame_id] = false;
+  evictable_[frame_id] = false;
+  curr_size_--;
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+auto LRUReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return curr_size_;
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+auto LRUReplacer::EvictionCandidates(size_t n) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  for (auto it = lru_list_.begin(); it != lru_list_.end() && candidates.size() < n; ++it) {
+    if (evictable_[*it]) {
+      candidates.push_back(*it);
+    }
+  }
+  return candidates;
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+void LRUReplacer::Unpin(frame_id_t frame_id) {
+  CheckFrame(frame_id);
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    if (evictable_[frame_id]) {
+      return;
+    }
+  }
+  RecordAccess(frame_id);
+  SetEvictable(frame_id, true);
+}
 
 }  // namespace bustub
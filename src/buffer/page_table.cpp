@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <utility>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) { Reserve(num_frames); }
+
+void PageTable::Reserve(size_t num_frames) {
+  // Keep the load factor at or below 1/2, so that probe sequences stay short.
+  size_t capacity = 2;
+  while (capacity < num_frames * 2) {
+    capacity *= 2;
+  }
+  Table *old_table = table_.load(std::memory_order_relaxed);
+  if (old_table != nullptr && capacity <= old_table->mask_ + 1) {
+    return;
+  }
+  auto table = std::make_unique<Table>(Table{std::make_unique<std::atomic<uint64_t>[]>(capacity), capacity - 1});
+  for (size_t i = 0; i < capacity; i++) {
+    table->slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+  for (size_t slot = 0; old_table != nullptr && slot <= old_table->mask_; slot++) {
+    uint64_t entry = old_table->slots_[slot].load(std::memory_order_relaxed);
+    if (entry != EMPTY) {
+      InsertInto(table.get(), entry);
+    }
+  }
+  table_.store(table.get(), std::memory_order_release);
+  tables_.push_back(std::move(table));
+}
+
+auto PageTable::Find(page_id_t page_id) const -> frame_id_t {
+  const Table *table = table_.load(std::memory_order_acquire);
+  if (table == nullptr) {
+    return -1;
+  }
+  // Bound the probe: while a writer shifts entries around, a lookup is not guaranteed to meet an empty slot.
+  const size_t mask = table->mask_;
+  size_t slot = Home(page_id, mask);
+  for (size_t probes = 0; probes <= mask; probes++, slot = (slot + 1) & mask) {
+    uint64_t entry = table->slots_[slot].load(std::memory_order_acquire);
+    if (entry == EMPTY) {
+      return -1;
+    }
+    if (PageOf(entry) == page_id) {
+      return FrameOf(entry);
+    }
+  }
+  return -1;
+}
+
+void PageTable::InsertInto(Table *table, uint64_t entry) {
+  size_t slot = Home(PageOf(entry), table->mask_);
+  while (table->slots_[slot].load(std::memory_order_relaxed) != EMPTY) {
+    slot = (slot + 1) & table->mask_;
+  }
+  table->slots_[slot].store(entry, std::memory_order_release);
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  Table *table = table_.load(std::memory_order_relaxed);
+  BUSTUB_ASSERT(table != nullptr && size_ < table->mask_, "page table is full");
+  InsertInto(table, Encode(page_id, frame_id));
+  size_++;
+}
+
+void PageTable::Erase(page_id_t page_id) {
+  Table *table = table_.load(std::memory_order_relaxed);
+  if (table == nullptr) {
+    return;
+  }
+  auto &slots = table->slots_;
+  const size_t mask = table->mask_;
+  size_t hole = Home(page_id, mask);
+  while (true) {
+    uint64_t entry = slots[hole].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      return;
+    }
+    if (PageOf(entry) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask;
+  }
+  size_--;
+
+  // Backward-shift deletion: pull later entries of the cluster into the hole when their probe passes through it,
+  // so that the table never needs tombstones.
+  for (size_t slot = (hole + 1) & mask;; slot = (slot + 1) & mask) {
+    uint64_t entry = slots[slot].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      break;
+    }
+    size_t home = Home(PageOf(entry), mask);
+    bool stays = hole <= slot ? (hole < home && home <= slot) : (hole < home || home <= slot);
+    if (!stays) {
+      slots[hole].store(entry, std::memory_order_release);
+      hole = slot;
+    }
+  }
+  slots[hole].store(EMPTY, std::memory_order_release);
+}
+
+auto PageTable::PageIds() const -> std::vector<page_id_t> {
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(size_);
+  const Table *table = table_.load(std::memory_order_relaxed);
+  for (size_t slot = 0; table != nullptr && slot <= table->mask_; slot++) {
+    uint64_t entry = table->slots_[slot].load(std::memory_order_relaxed);
+    if (entry != EMPTY) {
+      page_ids.push_back(PageOf(entry));
+    }
+  }
+  return page_ids;
+}
+
+}  // namespace bustub
@@ -0,0 +1,212 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <string>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager)
+    : BufferPoolManager(num_instances * pool_size), disk_manager_(disk_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "a parallel buffer pool needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(std::make_unique<BufferPoolManager>(
+        pool_size, static_cast<uint32_t>(num_instances), static_cast<uint32_t>(i), disk_manager, replacer_k,
+        log_manager));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
+  size_t pool_size = 0;
+  for (auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::GetPages() -> Page * {
+  throw NotImplementedException("a parallel buffer pool has no single page array, ask each instance for its pages");
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager * {
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+auto ParallelBufferPoolManager::NewPage(page_id_t *page_id, segment_id_t segment) -> Page * {
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; i++) {
+    auto *page = instances_[(start + i) % num_instances]->NewPage(page_id, segment);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::NewPageGuarded(page_id_t *page_id, segment_id_t segment) -> BasicPageGuard {
+  auto *page = NewPage(page_id, segment);
+  return {page == nullptr ? nullptr : GetBufferPoolManager(*page_id), page};
+}
+
+auto ParallelBufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
+  return GetBufferPoolManager(page_id)->FetchPageBasic(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+  return GetBufferPoolManager(page_id)->FetchPageRead(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
+  return GetBufferPoolManager(page_id)->FetchPageWrite(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::FetchPageOptimistic(page_id_t page_id, AccessType access_type) -> OptimisticPageGuard {
+  return GetBufferPoolManager(page_id)->FetchPageOptimistic(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type) -> bool {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty, access_type);
+}
+
+auto ParallelBufferPoolManager::FlushPage(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPages() {
+  std::vector<BufferPoolManager *> instances;
+  instances.reserve(instances_.size());
+  for (auto &instance : instances_) {
+    instances.push_back(instance.get());
+  }
+  CheckpointPools(instances);
+}
+
+auto ParallelBufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+auto ParallelBufferPoolManager::PrefetchPage(page_id_t page_id, AccessType access_type) -> bool {
+  return GetBufferPoolManager(page_id)->PrefetchPage(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type)
+    -> size_t {
+  disk_manager_->AdvisePages(first_page_id, num_pages,
+                             access_type == AccessType::Scan ? DiskAccessHint::Sequential : DiskAccessHint::WillNeed);
+  size_t prefetched = 0;
+  for (size_t i = 0; i < num_pages; i++) {
+    const page_id_t page_id = first_page_id + static_cast<page_id_t>(i);
+    if (GetBufferPoolManager(page_id)->PrefetchPage(page_id, access_type)) {
+      prefetched++;
+    }
+  }
+  return prefetched;
+}
+
+void ParallelBufferPoolManager::CreateSegment(segment_id_t segment, const std::string &directory) {
+  // The instances share the disk manager.
+  instances_[0]->CreateSegment(segment, directory);
+}
+
+auto ParallelBufferPoolManager::DropSegment(segment_id_t segment) -> bool {
+  if (segment == DEFAULT_SEGMENT_ID) {
+    throw Exception("the default segment can't be dropped");
+  }
+  bool discarded = true;
+  for (size_t i = 1; i < instances_.size(); i++) {
+    discarded = instances_[i]->DiscardSegment(segment) && discarded;
+  }
+  return instances_[0]->DropSegment(segment) && discarded;
+}
+
+auto ParallelBufferPoolManager::DiscardSegment(segment_id_t segment) -> bool {
+  bool discarded = true;
+  for (auto &instance : instances_) {
+    discarded = instance->DiscardSegment(segment) && discarded;
+  }
+  return discarded;
+}
+
+void ParallelBufferPoolManager::StartBackgroundFlusher(const BackgroundFlusherOptions &options) {
+  for (auto &instance : instances_) {
+    instance->StartBackgroundFlusher(options);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundFlusher() {
+  for (auto &instance : instances_) {
+    instance->StopBackgroundFlusher();
+  }
+}
+
+auto ParallelBufferPoolManager::GetBackgroundFlusherStats() -> BackgroundFlusherStats {
+  BackgroundFlusherStats stats;
+  for (auto &instance : instances_) {
+    auto instance_stats = instance->GetBackgroundFlusherStats();
+    stats.pages_cleaned_ += instance_stats.pages_cleaned_;
+    stats.write_backs_avoided_ += instance_stats.write_backs_avoided_;
+    stats.foreground_write_backs_ += instance_stats.foreground_write_backs_;
+  }
+  return stats;
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+auto ParallelBufferPoolManager::GetShardStats() -> std::vector<BufferPoolStats> {
+  std::vector<BufferPoolStats> stats;
+  stats.reserve(instances_.size());
+  for (auto &instance : instances_) {
+    stats.push_back(instance->GetStats());
+  }
+  return stats;
+}
+
+void ParallelBufferPoolManager::SetReplacer(const std::string &policy) {
+  // Reject an unknown policy before any instance has switched.
+  MakeReplacer(policy, 1, 1);
+  for (auto &instance : instances_) {
+    instance->SetReplacer(policy);
+  }
+}
+
+void ParallelBufferPoolManager::Resize(size_t pool_size) {
+  const size_t num_instances = instances_.size();
+  if (pool_size < num_instances) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "invalid buffer pool size: " + std::to_string(pool_size));
+  }
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_[i]->Resize(pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0));
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.cpp
+//
+// Identification: src/buffer/read_ahead.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+void ReadAhead::OnHop(page_id_t from, page_id_t to) {
+  if (bpm_ == nullptr || from == INVALID_PAGE_ID || to == INVALID_PAGE_ID) {
+    return;
+  }
+  page_id_t stride = to - from;
+  if (stride <= 0 || stride != stride_) {
+    stride_ = stride;
+    next_prefetch_ = INVALID_PAGE_ID;
+    return;
+  }
+
+  const auto window = static_cast<page_id_t>(read_ahead_window.load());
+  if (window == 0) {
+    return;
+  }
+  // Keep pages (to, to + window * stride] in flight. Pages issued by earlier hops are not issued again.
+  page_id_t end = to + window * stride_;
+  if (last_page_id_ != INVALID_PAGE_ID) {
+    end = std::min(end, last_page_id_);
+  }
+  page_id_t first = std::max(next_prefetch_, to + stride_);
+  if (stride_ == 1 && first <= end) {
+    bpm_->PrefetchRange(first, end - first + 1, access_type_);
+  } else {
+    for (page_id_t page_id = first; page_id <= end; page_id += stride_) {
+      bpm_->PrefetchPage(page_id, access_type_);
+    }
+  }
+  next_prefetch_ = std::max(next_prefetch_, end + stride_);
+}
+
+}  // namespace bustub
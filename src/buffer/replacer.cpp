@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.cpp
+//
+// Identification: src/buffer/replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_q_replacer.h"
+#include "common/exception.h"
+#include "common/util/string_util.h"
+
+namespace bustub {
+
+auto MakeReplacer(const std::string &policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer> {
+  auto name = StringUtil::Lower(policy);
+  if (name == "lru_k") {
+    return std::make_unique<LRUKReplacer>(num_frames, k);
+  }
+  if (name == "lru") {
+    return std::make_unique<LRUReplacer>(num_frames);
+  }
+  if (name == "clock") {
+    return std::make_unique<ClockReplacer>(num_frames);
+  }
+  if (name == "2q") {
+    return std::make_unique<TwoQReplacer>(num_frames);
+  }
+  if (name == "arc") {
+    return std::make_unique<ARCReplacer>(num_frames);
+  }
+  throw Exception(ExceptionType::INVALID, "unknown replacement policy '" + policy + "', expected one of lru_k, lru, "
+                                          "clock, 2q and arc");
+}
+
+}  // namespace bustub
@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.cpp
+//
+// Identification: src/buffer/two_q_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_q_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TwoQReplacer::TwoQReplacer(size_t num_frames)
+    : frames_(num_frames), kin_(std::max<size_t>(1, num_frames / 4)), kout_(std::max<size_t>(1, num_frames / 2)) {}
+
+void TwoQReplacer::CheckFrame(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= frames_.size()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id is out of the replacer's range");
+  }
+}
+
+auto TwoQReplacer::PickVictims(size_t n) const -> std::vector<frame_id_t> {
+  std::vector<frame_id_t> victims;
+  auto a1in_it = a1in_.begin();
+  auto am_it = am_.begin();
+  auto next_evictable = [this](std::list<frame_id_t>::const_iterator it, const std::list<frame_id_t> &list) {
+    while (it != list.end() && !frames_[*it].evictable_) {
+      ++it;
+    }
+    return it;
+  };
+  size_t a1in_size = a1in_.size();
+  while (victims.size() < n) {
+    a1in_it = next_evictable(a1in_it, a1in_);
+    am_it = next_evictable(am_it, am_);
+    bool from_a1in = a1in_it != a1in_.end() && (a1in_size > kin_ || am_it == am_.end());
+    if (from_a1in) {
+      victims.push_back(*a1in_it++);
+      a1in_size--;
+    } else if (am_it != am_.end()) {
+      victims.push_back(*am_it++);
+    } else {
+      break;
+    }
+  }
+  return victims;
+}
+
+void TwoQReplacer::Detach(frame_id_t frame_id) {
+  auto &entry = frames_[frame_id];
+  if (entry.in_am_) {
+    am_.erase(entry.pos_);
+  } else {
+    a1in_.erase(entry.pos_);
+    if (entry.page_id_ != INVALID_PAGE_ID && a1out_index_.count(entry.page_id_) == 0) {
+      a1out_index_[entry.page_id_] = a1out_.insert(a1out_.end(), entry.page_id_);
+      if (a1out_.size() > kout_) {
+        a1out_index_.erase(a1out_.front());
+        a1out_.pop_front();
+      }
+    }
+  }
+  if (entry.evictable_) {
+    curr_size_--;
+  }
+  entry = FrameEntry{};
+}
+
+auto TwoQReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto victims = PickVictims(1);
+  if (victims.empty()) {
+    return false;
+  }
+  *frame_id = victims[0];
+  Detach(victims[0]);
+  return true;
+}
+
+void TwoQReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  auto &entry = frames_[frame_id];
+  if (entry.tracked_) {
+    // Accesses to a frame in A1in are assumed to be correlated with the one that loaded it, and are ignored.
+    if (entry.in_am_) {
+      am_.splice(am_.end(), am_, entry.pos_);
+    }
+    return;
+  }
+
+  entry.tracked_ = true;
+  entry.page_id_ = page_id;
+  auto ghost = page_id == INVALID_PAGE_ID ? a1out_index_.end() : a1out_index_.find(page_id);
+  if (ghost != a1out_index_.end()) {
+    entry.in_am_ = access_type != AccessType::Scan;
+    a1out_.erase(ghost->second);
+    a1out_index_.erase(ghost);
+  }
+  auto &list = entry.in_am_ ? am_ : a1in_;
+  entry.pos_ = list.insert(list.end(), frame_id);
+}
+
+void TwoQReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  auto &entry = frames_[frame_id];
+  if (!entry.tracked_ || entry.evictable_ == set_evictable) {
+    return;
+  }
+  entry.evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void TwoQReplacer::Remove(frame_id_t frame_id) {
+  CheckFrame(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  auto &entry = frames_[frame_id];
+  if (!entry.tracked_) {
+    return;
+  }
+  if (!entry.evictable_) {
+    throw Exception(ExceptionType::INVALID, "cannot remove a non-evictable frame");
+  }
+  Detach(frame_id);
+}
+
+auto TwoQReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+auto TwoQReplacer::EvictionCandidates(size_t n) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  return PickVictims(n);
+}
+
+}  // namespace bustub
@@ -1,20 +1,25 @@
-// DDL (Data Definition Language) statement handling in BusTub, including create table, create index, and set/show
-// variable.
+// DDL (Data Definition Language) statement handling in BusTub, including create table, create index, drop table,
+// drop index, and set/show variable.
 
+#include <algorithm>
 #include <optional>
 #include <shared_mutex>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
 #include "binder/bound_statement.h"
 #include "binder/statement/create_statement.h"
+#include "binder/statement/drop_statement.h"
 #include "binder/statement/explain_statement.h"
 #include "binder/statement/index_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/bustub_instance.h"
@@ -51,13 +56,39 @@ void BustubInstance::HandleCreateStatement(Transaction *txn, const CreateStateme
   WriteOneCell(fmt::format("Table created with id = {}", info->oid_), writer);
 }
 
+void BustubInstance::HandleDropStatement(Transaction *txn, const DropStatement &stmt, ResultWriter &writer) {
+  std::unique_lock<std::shared_mutex> l(catalog_lock_);
+  bool dropped = false;
+  if (stmt.is_index_) {
+    // Index names are per table: drop the index of that name, whichever table it is on.
+    for (const auto &table_name : catalog_->GetTableNames()) {
+      if (catalog_->GetIndex(stmt.name_, table_name) != nullptr) {
+        dropped = catalog_->DropIndex(stmt.name_, table_name);
+        break;
+      }
+    }
+  } else {
+    dropped = catalog_->DropTable(stmt.name_);
+  }
+  l.unlock();
+
+  const auto *object = stmt.is_index_ ? "Index" : "Table";
+  if (!dropped && !stmt.if_exists_) {
+    throw bustub::Exception(fmt::format("{} {} does not exist", object, stmt.name_));
+  }
+  WriteOneCell(dropped ? fmt::format("{} {} dropped", object, stmt.name_)
+                       : fmt::format("{} {} does not exist", object, stmt.name_),
+               writer);
+}
+
 void BustubInstance::HandleIndexStatement(Transaction *txn, const IndexStatement &stmt, ResultWriter &writer) {
   std::vector<uint32_t> col_ids;
   for (const auto &col : stmt.cols_) {
     auto idx = stmt.table_->schema_.GetColIdx(col->col_name_.back());
     col_ids.push_back(idx);
-    if (stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
-      throw NotImplementedException("only support creating index on integer column");
+    const TypeId type = stmt.table_->schema_.GetColumn(idx).GetType();
+    if (type != TypeId::INTEGER && type != TypeId::BIGINT) {
+      throw NotImplementedException("only support creating index on integer or bigint column");
     }
   }
   auto key_schema = Schema::CopySchema(&stmt.table_->schema_, col_ids);
@@ -72,9 +103,9 @@ void BustubInstance::HandleIndexStatement(Transaction *txn, const IndexStatement
   }
 
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
-  auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-      txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
-      IntegerHashFunctionType{});
+  // The key type is picked from the key schema: native integers for one or two integer columns.
+  auto info =
+      catalog_->CreateIndex(txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids);
   l.unlock();
 
   if (info == nullptr) {
@@ -127,12 +158,83 @@ void BustubInstance::HandleExplainStatement(Transaction *txn, const ExplainState
 
 void BustubInstance::HandleVariableShowStatement(Transaction *txn, const VariableShowStatement &stmt,
                                                  ResultWriter &writer) {
+  if (stmt.variable_ == "buffer_pool_stats") {
+    if (buffer_pool_manager_ == nullptr) {
+      throw Exception("buffer pool is not available");
+    }
+    std::vector<std::pair<std::string, BufferPoolStats>> rows;
+    if (auto *parallel = dynamic_cast<ParallelBufferPoolManager *>(buffer_pool_manager_); parallel != nullptr) {
+      auto shard_stats = parallel->GetShardStats();
+      for (size_t i = 0; i < shard_stats.size(); i++) {
+        rows.emplace_back(fmt::format("shard {}", i), shard_stats[i]);
+      }
+    }
+    rows.emplace_back("total", buffer_pool_manager_->GetStats());
+
+    writer.BeginTable(false);
+    writer.BeginHeader();
+    for (const auto *header : {"pool", "hits", "misses", "hit_ratio", "evictions", "dirty_write_backs", "pin_waits",
+                               "avg_pin_us", "frames_unknown", "frames_lookup", "frames_scan", "frames_index",
+                               "frames_get"}) {
+      writer.WriteHeaderCell(header);
+    }
+    writer.EndHeader();
+    for (const auto &[pool, stats] : rows) {
+      writer.BeginRow();
+      writer.WriteCell(pool);
+      writer.WriteCell(fmt::format("{}", stats.hits_));
+      writer.WriteCell(fmt::format("{}", stats.misses_));
+      writer.WriteCell(fmt::format("{:.4f}", stats.HitRatio()));
+      writer.WriteCell(fmt::format("{}", stats.evictions_));
+      writer.WriteCell(fmt::format("{}", stats.dirty_write_backs_));
+      writer.WriteCell(fmt::format("{}", stats.pin_waits_));
+      writer.WriteCell(fmt::format("{:.3f}", static_cast<double>(stats.AveragePinDuration().count()) / 1000));
+      for (auto frames : stats.frames_by_access_type_) {
+        writer.WriteCell(fmt::format("{}", frames));
+      }
+      writer.EndRow();
+    }
+    writer.EndTable();
+    return;
+  }
   auto content = GetSessionVariable(stmt.variable_);
   WriteOneCell(fmt::format("{}={}", stmt.variable_, content), writer);
 }
 
 void BustubInstance::HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt,
                                                 ResultWriter &writer) {
+  if (stmt.variable_ == "read_ahead_window") {
+    try {
+      read_ahead_window = std::stoul(stmt.value_);
+    } catch (const std::logic_error &e) {
+      throw Exception(fmt::format("invalid read_ahead_window: {}", stmt.value_));
+    }
+  }
+  if (stmt.variable_ == "checkpoint_writers") {
+    try {
+      checkpoint_writers = std::max<size_t>(1, std::stoul(stmt.value_));
+    } catch (const std::logic_error &e) {
+      throw Exception(fmt::format("invalid checkpoint_writers: {}", stmt.value_));
+    }
+  }
+  if (stmt.variable_ == "buffer_pool_size") {
+    if (buffer_pool_manager_ == nullptr) {
+      throw Exception("buffer_pool_size: there is no buffer pool");
+    }
+    size_t pool_size;
+    try {
+      pool_size = std::stoul(stmt.value_);
+    } catch (const std::logic_error &e) {
+      throw Exception(fmt::format("invalid buffer_pool_size: {}", stmt.value_));
+    }
+    buffer_pool_manager_->Resize(pool_size);
+  }
+  if (stmt.variable_ == "buffer_replacer") {
+    if (buffer_pool_manager_ == nullptr) {
+      throw Exception("buffer_replacer: there is no buffer pool");
+    }
+    buffer_pool_manager_->SetReplacer(stmt.value_);
+  }
   session_variables_[stmt.variable_] = stmt.value_;
 }
 
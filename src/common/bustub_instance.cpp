@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -7,11 +8,13 @@
 #include "binder/bound_expression.h"
 #include "binder/bound_statement.h"
 #include "binder/statement/create_statement.h"
+#include "binder/statement/drop_statement.h"
 #include "binder/statement/explain_statement.h"
 #include "binder/statement/index_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/bustub_instance.h"
@@ -34,6 +37,7 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_mmap.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -42,23 +46,37 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn, bool is_modify) -> st
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_, is_modify);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+auto BustubInstance::MakeBufferPoolManager() -> BufferPoolManager * {
+  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
+  // buffer pool size specified in `config.h`.
+  const size_t pool_size = 128;
+  const size_t num_instances = std::clamp<size_t>(buffer_pool_instances, 1, pool_size);
+  try {
+    if (num_instances > 1) {
+      return new ParallelBufferPoolManager(num_instances, (pool_size + num_instances - 1) / num_instances,
+                                           disk_manager_, LRUK_REPLACER_K, log_manager_);
+    }
+    return new BufferPoolManager(pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_);
+  } catch (NotImplementedException &e) {
+    std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
+    return nullptr;
+  }
+}
+
+BustubInstance::BustubInstance(const std::string &db_file_name, DiskManagerKind disk_manager_kind) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  if (disk_manager_kind == DiskManagerKind::Mmap) {
+    disk_manager_ = new DiskManagerMmap(db_file_name);
+  } else {
+    disk_manager_ = new DiskManager(db_file_name, enable_direct_io.load());
+  }
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
-  try {
-    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
-  } catch (NotImplementedException &e) {
-    std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
-    buffer_pool_manager_ = nullptr;
-  }
+  buffer_pool_manager_ = MakeBufferPoolManager();
 
   // Transaction (txn) related.
 
@@ -82,23 +100,18 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
 
-BustubInstance::BustubInstance() {
+BustubInstance::BustubInstance() : BustubInstance(std::make_unique<DiskManagerUnlimitedMemory>()) {}
+
+BustubInstance::BustubInstance(std::unique_ptr<DiskManager> disk_manager) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManagerUnlimitedMemory();
+  disk_manager_ = disk_manager.release();
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
-  try {
-    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
-  } catch (NotImplementedException &e) {
-    std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
-    buffer_pool_manager_ = nullptr;
-  }
+  buffer_pool_manager_ = MakeBufferPoolManager();
 
   // Transaction (txn) related.
 
@@ -177,6 +190,10 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 \dt: show all tables
 \di: show all indices
 \help: show this message again
+SHOW buffer_pool_stats: show the counters of the buffer pool, per shard with --buffer-pool-instances
+SET buffer_replacer = 'arc': switch the replacement policy (lru_k, lru, clock, 2q, arc)
+SET checkpoint_writers = 4: number of threads that write a checkpoint of the buffer pool
+SET buffer_pool_size = 256: grow or shrink the buffer pool to this many frames
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
 up a doc describing the current status later. It will silently ignore some parts
@@ -246,6 +263,11 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         HandleIndexStatement(txn, index_stmt, writer);
         continue;
       }
+      case StatementType::DROP_STATEMENT: {
+        const auto &drop_stmt = dynamic_cast<const DropStatement &>(*statement);
+        HandleDropStatement(txn, drop_stmt, writer);
+        continue;
+      }
       case StatementType::VARIABLE_SHOW_STATEMENT: {
         const auto &show_stmt = dynamic_cast<const VariableShowStatement &>(*statement);
         HandleVariableShowStatement(txn, show_stmt, writer);
@@ -20,4 +20,16 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::atomic<size_t> read_ahead_window(8);
+
+std::atomic<size_t> checkpoint_writers(1);
+
+std::atomic<size_t> disk_io_depth(1);
+
+std::atomic<size_t> buffer_pool_instances(1);
+
+std::atomic<bool> buffer_pool_huge_pages(false);
+
+std::atomic<bool> enable_direct_io(false);
+
 }  // namespace bustub
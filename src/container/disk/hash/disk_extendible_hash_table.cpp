@@ -134,5 +134,10 @@ template class DiskExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>
 template class DiskExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
 template class DiskExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class DiskExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+template class DiskExtendibleHashTable<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class DiskExtendibleHashTable<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class DiskExtendibleHashTable<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class DiskExtendibleHashTable<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class DiskExtendibleHashTable<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 
 }  // namespace bustub
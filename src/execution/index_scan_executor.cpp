@@ -11,6 +11,10 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <optional>
+
+#include "common/exception.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx) {
@@ -21,21 +25,54 @@ void IndexScanExecutor::Init() {
   // table，index，所以需要一个table iterator
   auto des_index_id = plan_->index_oid_;
   auto des_index_info = exec_ctx_->GetCatalog()->GetIndex(des_index_id);
-  b_tree_index_ = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(des_index_info->index_.get());
-  // 保存一个迭代器
-  iter_ = b_tree_index_->GetBeginIterator();
+  // 保存一个迭代器: the index type is the one the catalog picked for the key schema
+  // The bounds of the key range, as key tuples of the index; an index of one column when the plan has any.
+  const Schema &key_schema = des_index_info->key_schema_;
+  std::optional<Tuple> lower;
+  std::optional<Tuple> upper;
+  if (plan_->lower_bound_.has_value()) {
+    lower.emplace(std::vector<Value>{*plan_->lower_bound_}, &key_schema);
+  }
+  if (plan_->upper_bound_.has_value()) {
+    upper.emplace(std::vector<Value>{*plan_->upper_bound_}, &key_schema);
+  }
+  const bool is_b_plus_tree = VisitBPlusTreeIndexType(key_schema, [&](auto tag) {
+    auto *b_tree_index = dynamic_cast<typename decltype(tag)::Type *>(des_index_info->index_.get());
+    if (b_tree_index == nullptr) {
+      return false;
+    }
+    next_batch_ = [iter = b_tree_index->ScanRange(lower.has_value() ? &*lower : nullptr, plan_->lower_inclusive_,
+                                                  upper.has_value() ? &*upper : nullptr, plan_->upper_inclusive_)](
+                      std::vector<RID> *rids) mutable { return iter.NextBatch(rids); };
+    return true;
+  });
+  if (!is_b_plus_tree) {
+    throw Exception("index " + des_index_info->name_ + " is not a B+ tree index that can be scanned");
+  }
 
   tableinfo_ = exec_ctx_->GetCatalog()->GetTable(des_index_info->table_name_);
+  batch_.clear();
+  batch_pos_ = 0;
 }
 
 auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   // 在一个表上进行索引扫描？
-  if (iter_.IsEnd()) {
-    return false;
+  while (true) {
+    if (batch_pos_ == batch_.size()) {
+      batch_pos_ = 0;
+      if (!next_batch_(&batch_)) {
+        return false;
+      }
+    }
+    *tuple = tableinfo_->table_->GetTuple(batch_[batch_pos_++], AccessType::Lookup).second;
+    *rid = tuple->GetRid();
+    if (plan_->filter_predicate_ == nullptr) {
+      return true;
+    }
+    auto value = plan_->filter_predicate_->Evaluate(tuple, tableinfo_->schema_);
+    if (!value.IsNull() && value.GetAs<bool>()) {
+      return true;
+    }
   }
-  *tuple = tableinfo_->table_->GetTuple((*iter_).second).second;
-  *rid = tuple->GetRid();
-  ++iter_;
-  return true;
 }
 }  // namespace bustub
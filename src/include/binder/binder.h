@@ -77,6 +77,7 @@ class BoundExpressionListRef;
 class BoundOrderBy;
 class BoundSubqueryRef;
 class CreateStatement;
+class DropStatement;
 class ExplainStatement;
 class IndexStatement;
 class DeleteStatement;
@@ -194,6 +195,8 @@ class Binder {
 
   auto BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<IndexStatement>;
 
+  auto BindDrop(duckdb_libpgquery::PGDropStmt *stmt) -> std::unique_ptr<DropStatement>;
+
   auto BindDelete(duckdb_libpgquery::PGDeleteStmt *stmt) -> std::unique_ptr<DeleteStatement>;
 
   auto BindUpdate(duckdb_libpgquery::PGUpdateStmt *stmt) -> std::unique_ptr<UpdateStatement>;
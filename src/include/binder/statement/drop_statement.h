@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//                         BusTub
+//
+// binder/drop_statement.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "binder/bound_statement.h"
+#include "common/enums/statement_type.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+class DropStatement : public BoundStatement {
+ public:
+  explicit DropStatement(bool is_index, std::string name, bool if_exists)
+      : BoundStatement(StatementType::DROP_STATEMENT),
+        is_index_(is_index),
+        name_(std::move(name)),
+        if_exists_(if_exists) {}
+
+  /** Whether an index is dropped, rather than a table */
+  bool is_index_;
+
+  /** Name of the table or index */
+  std::string name_;
+
+  /** Whether it is fine for the table or index not to exist */
+  bool if_exists_;
+
+  auto ToString() const -> std::string override {
+    return fmt::format("BoundDrop {{ type={}, name={}, if_exists={} }}", is_index_ ? "index" : "table", name_,
+                       if_exists_);
+  }
+};
+
+}  // namespace bustub
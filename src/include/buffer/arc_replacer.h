@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy of Megiddo and Modha.
+ *
+ * Resident frames live in two LRU lists: T1 holds frames that were accessed once since they were loaded, T2 frames
+ * that were accessed again. The pages of frames evicted from T1 and T2 are remembered in the ghost lists B1 and B2.
+ * Loading a page that is still in B1 means T1 was too small, and grows the target size `p` of T1; loading a page
+ * that is still in B2 shrinks it. Evict() takes the least recently used evictable frame of T1 while T1 is larger
+ * than its target, and of T2 otherwise.
+ *
+ * Scan accesses neither promote a frame from T1 to T2 nor adapt the target, so a sequential scan only cycles through
+ * T1. Remove() is treated like an eviction, since the buffer pool picks its victims among EvictionCandidates().
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ARCReplacer.
+   * @param num_frames the number of frames of the buffer pool, which is also the number of pages ARC remembers in
+   * its ghost lists
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  /**
+   * @brief Record an access to a frame. The first access to an untracked frame loads it into T1, or into T2 if its
+   * page is in a ghost list. A later access moves the frame to the most recently used end of T2.
+   */
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t n) -> std::vector<frame_id_t> override;
+
+  /** @return the current target size of T1 */
+  auto GetTarget() -> size_t;
+
+ private:
+  struct FrameEntry {
+    bool tracked_{false};
+    bool evictable_{false};
+    /** Whether the frame is in T2 rather than T1. */
+    bool in_t2_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  struct GhostEntry {
+    /** Whether the page is in B2 rather than B1. */
+    bool in_b2_;
+    std::list<page_id_t>::iterator pos_;
+  };
+
+  void CheckFrame(frame_id_t frame_id) const;
+  /** Up to n victims in eviction order, without modifying anything. */
+  auto PickVictims(size_t n) const -> std::vector<frame_id_t>;
+  /** Stop tracking a frame and remember its page in the ghost list matching the frame's list. */
+  void Detach(frame_id_t frame_id);
+  /** Forget ghost pages until |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c. */
+  void TrimGhosts();
+  void EraseGhost(page_id_t page_id);
+
+  /** Resident lists, least recently used first. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  /** Ghost lists of evicted pages, least recently evicted first. */
+  std::list<page_id_t> b1_;
+  std::list<page_id_t> b2_;
+  std::unordered_map<page_id_t, GhostEntry> ghosts_;
+  std::vector<FrameEntry> frames_;
+  /** Target size of T1, between 0 and c. */
+  size_t p_{0};
+  size_t capacity_;
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -12,22 +12,69 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
-#include "buffer/lru_k_replacer.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/frame_arena.h"
+#include "buffer/frame_array.h"
+#include "buffer/free_page_map.h"
+#include "buffer/replacer.h"
+#include "buffer/page_table.h"
 #include "common/config.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+/** Settings of the background flusher, see BufferPoolManager::StartBackgroundFlusher(). */
+struct BackgroundFlusherOptions {
+  /** How long the flusher sleeps between two rounds. */
+  std::chrono::milliseconds interval_{10};
+  /** Fraction of the frames, counted from the eviction end of the replacer, that the flusher tries to keep clean. */
+  double target_clean_ratio_{0.25};
+  /** Most pages the flusher writes back per second, 0 for no limit. */
+  size_t max_pages_per_sec_{0};
+  /** Most pages the flusher writes back in one round. */
+  size_t max_pages_per_round_{64};
+};
+
+/** Counters of the background flusher. */
+struct BackgroundFlusherStats {
+  /** Pages written back by the flusher. */
+  uint64_t pages_cleaned_{0};
+  /** Evictions whose victim was clean because the flusher had written it back. */
+  uint64_t write_backs_avoided_{0};
+  /** Evictions that had to write back a dirty victim on the fetching thread. */
+  uint64_t foreground_write_backs_{0};
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * All page I/O is issued through a DiskScheduler, and the pool latch is released while a read or a write-back is
+ * outstanding. A frame whose page is still being read in is tracked as in-flight, so concurrent fetchers of the same
+ * page wait on the same read instead of issuing their own.
+ *
+ * Fetching and unpinning a resident page does not take the pool latch. The page is looked up in a lock-free page
+ * table and pinned with an atomic increment, and the access is put in a lossy log that is replayed into the replacer
+ * in batches. Frames are therefore left evictable in the replacer while they are pinned; an eviction checks the pin
+ * count when it claims its victim, and moves on to the next candidate if the frame is in use.
  */
 class BufferPoolManager {
  public:
@@ -41,16 +88,31 @@ class BufferPoolManager {
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
                     LogManager *log_manager = nullptr);
 
+  /**
+   * @brief Creates a new BufferPoolManager that is one instance of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of instances in the parallel buffer pool
+   * @param instance_index index of this instance; it only allocates page ids equal to this index modulo num_instances
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   */
+  BufferPoolManager(size_t pool_size, uint32_t num_instances, uint32_t instance_index, DiskManager *disk_manager,
+                    size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr);
+
   /**
    * @brief Destroy an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager();
 
   /** @brief Return the size (number of frames) of the buffer pool. */
-  auto GetPoolSize() -> size_t { return pool_size_; }
+  virtual auto GetPoolSize() -> size_t { return pool_size_; }
 
-  /** @brief Return the pointer to all the pages in the buffer pool. */
-  auto GetPages() -> Page * { return pages_; }
+  /**
+   * @brief Return the pointer to the pages of the frames the pool was created with. Frames added later by Resize() are
+   * not part of this array.
+   */
+  virtual auto GetPages() -> Page * { return pages_.Data(); }
 
   /**
    * TODO(P1): Add implementation
@@ -67,9 +129,11 @@ class BufferPoolManager {
    * Also, remember to record the access history of the frame in the replacer for the lru-k algorithm to work.
    *
    * @param[out] page_id id of created page
-   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   * @param segment segment to allocate the page in, see CreateSegment()
+   * @return nullptr if no new pages could be created, e.g. because the write-back of the victim failed, otherwise
+   * pointer to new page
    */
-  auto NewPage(page_id_t *page_id) -> Page *;
+  virtual auto NewPage(page_id_t *page_id, segment_id_t segment = DEFAULT_SEGMENT_ID) -> Page *;
 
   /**
    * TODO(P1): Add implementation
@@ -81,9 +145,10 @@ class BufferPoolManager {
    * BasicPageGuard structure.
    *
    * @param[out] page_id, the id of the new page
+   * @param segment segment to allocate the page in
    * @return BasicPageGuard holding a new page
    */
-  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+  virtual auto NewPageGuarded(page_id_t *page_id, segment_id_t segment = DEFAULT_SEGMENT_ID) -> BasicPageGuard;
 
   /**
    * TODO(P1): Add implementation
@@ -100,9 +165,10 @@ class BufferPoolManager {
    *
    * @param page_id id of page to be fetched
    * @param access_type type of access to the page, only needed for leaderboard tests.
-   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   * @return nullptr if page_id cannot be fetched, e.g. because reading it or writing back the victim failed, otherwise
+   * pointer to the requested page
    */
-  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
+  virtual auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
 
   /**
    * TODO(P1): Add implementation
@@ -115,11 +181,23 @@ class BufferPoolManager {
    * the returned page already has a read or write latch held, respectively.
    *
    * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page, passed on to the replacer
    * @return PageGuard holding the fetched page
    */
-  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
-  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
-  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  virtual auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard;
+  virtual auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+  virtual auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard;
+
+  /**
+   * @brief Fetch a page for an optimistic read, without pinning or latching it. A resident page is served from the
+   * page table alone, and only writes to per-thread counters; a missing page is read in first.
+   *
+   * @param page_id the id of the page to fetch
+   * @param access_type type of access to the page, passed on to the replacer
+   * @return a guard to validate after reading, or an invalid guard if the page is being written or could not be fetched
+   */
+  virtual auto FetchPageOptimistic(page_id_t page_id, AccessType access_type = AccessType::Unknown)
+      -> OptimisticPageGuard;
 
   /**
    * TODO(P1): Add implementation
@@ -135,7 +213,7 @@ class BufferPoolManager {
    * @param access_type type of access to the page, only needed for leaderboard tests.
    * @return false if the page is not in the page table or its pin count is <= 0 before this call, true otherwise
    */
-  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
+  virtual auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
 
   /**
    * TODO(P1): Add implementation
@@ -143,19 +221,27 @@ class BufferPoolManager {
    * @brief Flush the target page to disk.
    *
    * Use the DiskManager::WritePage() method to flush a page to disk, REGARDLESS of the dirty flag.
-   * Unset the dirty flag of the page after flushing.
+   * Unset the dirty flag of the page after flushing. The write is made durable with DiskManager::SyncPages(), which
+   * lets concurrent flushes share one fdatasync.
    *
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
-   * @return false if the page could not be found in the page table, true otherwise
+   * @return false if the page could not be found in the page table or the write failed, in which case the page stays
+   * dirty, true otherwise
    */
-  auto FlushPage(page_id_t page_id) -> bool;
+  virtual auto FlushPage(page_id_t page_id) -> bool;
 
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the dirty pages in the buffer pool to disk, along with the free-page map. This is a checkpoint:
+   * it also waits for the write-backs of evicted pages that are still outstanding.
+   *
+   * The dirty frames are pinned and marked clean under the latch, and then written in page id order, with runs of
+   * consecutive pages coalesced into one vectored write, spread over `checkpoint_writers` threads. The latch is not
+   * held while writing, and clean frames are never pinned, so fetches of clean pages go on as usual. A page that is
+   * dirtied again while it is being written stays dirty. The checkpoint ends with a single DiskManager::SyncPages().
    */
-  void FlushAllPages();
+  virtual void FlushAllPages();
 
   /**
    * TODO(P1): Add implementation
@@ -165,48 +251,389 @@ class BufferPoolManager {
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
    * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
-   * imitate freeing the page on the disk.
+   * free the page on the disk. A page that is not in the buffer pool is freed on the disk as well.
    *
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  auto DeletePage(page_id_t page_id) -> bool;
+  virtual auto DeletePage(page_id_t page_id) -> bool;
+
+  /**
+   * @brief Create a segment for the pages of one table or index, with a file of its own: see
+   * DiskManager::CreateSegment(). Pages are then allocated in it with NewPage(page_id, segment), lowest page number
+   * first. The pages freed in a segment are reused until the segment is dropped, but are not kept on disk like the
+   * free-page map of the default segment.
+   *
+   * @param directory where to put the file of the segment, next to the database file if empty
+   */
+  virtual void CreateSegment(segment_id_t segment, const std::string &directory = "");
+
+  /**
+   * @brief Drop a segment with all its pages, and unlink its file. Nobody may use the pages of the segment any more;
+   * their contents are discarded rather than written back. See DiscardSegment().
+   * @return whether every page of the segment is gone from the buffer pool; until it is, the segment id must not be
+   * created again, or a stale frame would alias a page of the new segment
+   * @throws Exception for the default segment
+   */
+  virtual auto DropSegment(segment_id_t segment) -> bool;
+
+  /**
+   * @brief Remove the pages of a segment from the buffer pool without writing them back, and forget its allocations.
+   * Waits for the reads and write-backs of its pages that are in flight. Pages that are still pinned are left to
+   * their holders, so that a later call can discard them once they are unpinned. The file of the segment is left
+   * alone.
+   * @return whether every page of the segment is gone from the buffer pool
+   */
+  virtual auto DiscardSegment(segment_id_t segment) -> bool;
+
+  /**
+   * @brief Start reading a page into the buffer pool without pinning it, and return without waiting for the read.
+   *
+   * A later FetchPage of the page finds it resident, or waits for the outstanding read. The prefetch is dropped if it
+   * would need a dirty victim to be written back first, or if the page has never been allocated.
+   *
+   * @param page_id id of the page to read
+   * @param access_type type of the access that the page is prefetched for, passed on to the replacer
+   * @return true if the page is resident or being read in, false if the prefetch was dropped
+   */
+  virtual auto PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> bool;
+
+  /**
+   * @brief Prefetch the pages first_page_id, first_page_id + 1, ..., first_page_id + num_pages - 1.
+   * @return the number of pages that are resident or being read in
+   */
+  virtual auto PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type = AccessType::Unknown)
+      -> size_t;
+
+  /**
+   * @brief Start a background thread that writes back dirty pages before they are chosen for eviction.
+   *
+   * Every round, the flusher looks at the `target_clean_ratio_ * pool_size` evictable frames that the replacer would
+   * evict next, and writes back the dirty ones, within the rate limits of `options`. The fetching threads then mostly
+   * find clean victims and do not have to wait for a write-back. Eviction order is not affected.
+   * Does nothing if the flusher is already running.
+   *
+   * @param options how much and how often the flusher writes
+   */
+  virtual void StartBackgroundFlusher(const BackgroundFlusherOptions &options = {});
+
+  /** @brief Stop the background flusher and wait for its current round to finish. */
+  virtual void StopBackgroundFlusher();
+
+  /** @return the counters of the background flusher */
+  virtual auto GetBackgroundFlusherStats() -> BackgroundFlusherStats;
+
+  /**
+   * @brief Return the counters of the buffer pool. The counters are cumulative since the pool was created; the frames
+   * by access type describe the pool at the time of the call. Cheap enough to be polled.
+   */
+  virtual auto GetStats() -> BufferPoolStats;
+
+  /**
+   * @brief Switch to another replacement policy. The new replacer has no history; it starts out with one access to
+   * every resident page. Pinned pages stay pinned.
+   *
+   * @param policy one of "lru_k", "lru", "clock", "2q" and "arc", case-insensitive
+   * @throws Exception if the policy is unknown, in which case the current replacer is kept
+   */
+  virtual void SetReplacer(const std::string &policy);
+
+  /**
+   * @brief Change the number of frames of the pool while it is in use.
+   *
+   * Growing adds frames to the free list. Shrinking takes the frames at the end of the pool out of use: their pages
+   * are evicted, dirty ones written back, and the call waits until every pin on them is dropped, so it must not be
+   * called by a thread that holds a page of this pool. The memory of the removed frames goes back to the kernel, but
+   * their Page objects stay, so that a stale pointer to one of them is still safe to validate.
+   *
+   * @param pool_size the new number of frames, at least 1
+   * @throws Exception if pool_size is 0 or larger than the pool can grow
+   */
+  virtual void Resize(size_t pool_size);
+
+ protected:
+  /**
+   * @brief Creates a buffer pool manager that owns no frames of its own. Used by ParallelBufferPoolManager, which
+   * forwards every call to one of its instances.
+   * @param pool_size the total number of frames behind this buffer pool manager
+   */
+  explicit BufferPoolManager(size_t pool_size);
+
+  /**
+   * @brief Write the dirty pages of several buffer pools, which share one disk manager, as one checkpoint. See
+   * FlushAllPages(). Runs are coalesced across the pools, so the instances of a parallel pool get sequential writes
+   * even though each of them only holds every n-th page.
+   */
+  static void CheckpointPools(const std::vector<BufferPoolManager *> &pools);
 
  private:
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
+  /** A write-back of an evicted dirty page that has been scheduled but may not have reached the disk yet. */
+  struct WriteBack {
+    /** Id of the page being written back. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** Sequence number telling apart successive write-backs of the same page. */
+    uint64_t seq_{0};
+    /** Completed with whether the page reached the disk. */
+    std::shared_future<bool> done_;
+  };
+
+  /** Number of frames in use. Frames at or above it are being drained by Resize(), or wait to be added back. */
+  std::atomic<size_t> pool_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+  /** One past the highest page id handed out so far. Pages below it may have old contents on disk. */
   std::atomic<page_id_t> next_page_id_ = 0;
+  /** Which pages of this instance are in use. Loaded from the disk manager, and written back by FlushAllPages(). */
+  std::unique_ptr<FreePageMap> free_page_map_;
+  /** Pages allocated in free_page_map_ but not handed out, highest first. Protected by latch_. */
+  std::vector<page_id_t> allocation_batch_;
+  /** How many pages AllocatePage() takes from free_page_map_ at a time. */
+  static constexpr size_t ALLOCATION_BATCH_SIZE = 16;
+
+  /** The pages that this instance allocated in a segment other than the default one. */
+  struct SegmentAllocation {
+    /** Page number of the next page to hand out past the ones handed out so far. */
+    page_id_t next_page_number_;
+    /** Pages handed out and then deallocated, highest first. */
+    std::vector<page_id_t> free_;
+  };
+  /** Allocations of every segment that this instance allocated pages in. Protected by latch_. */
+  std::unordered_map<segment_id_t, SegmentAllocation> segments_;
+  /** Longest run of consecutive pages a checkpoint writes with one call. */
+  static constexpr size_t CHECKPOINT_RUN_PAGES = 64;
 
-  /** Array of buffer pool pages. */
-  Page *pages_;
+  /** The data of the frames: one page-aligned block for the initial frames, then one per chunk added by Resize(). */
+  std::vector<std::unique_ptr<FrameArena>> arenas_;
+  /** The pages of all the frames ever created. Their data points into arenas_. */
+  FrameArray<Page> pages_;
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_ __attribute__((__unused__)){nullptr};
   /** Pointer to the log manager. Please ignore this for P1. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUKReplacer> replacer_;
+  LogManager *log_manager_ __attribute__((__unused__)){nullptr};
+  /** Page table for keeping track of buffer pool pages. Read without the latch, written under it. */
+  PageTable page_table_;
+  /** Replacer to find unpinned pages for replacement. Swapped by SetReplacer() under latch_. */
+  std::unique_ptr<Replacer> replacer_;
+  /** The lookback constant k, for when the policy is switched back to LRU-K. */
+  size_t replacer_k_{LRUK_REPLACER_K};
+  /** Policy of replacer_, for rebuilding it when the pool grows. Protected by resize_latch_. */
+  std::string replacer_policy_{"lru_k"};
+  /** Serializes Resize() and SetReplacer(). Taken before latch_. */
+  std::mutex resize_latch_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch serializes the writers of page_table_, and protects free_list_, in_flight_ and write_backs_. The page id
+   * of a frame only changes under it; pin counts and dirty flags are also updated without it. It is never held across
+   * disk I/O.
+   */
   std::mutex latch_;
+  /** Scheduler that performs all reads and write-backs of the pool. */
+  std::unique_ptr<DiskScheduler> disk_scheduler_;
+  /** Pages whose frame is still being read in from disk, mapped to the completion of that read. */
+  std::unordered_map<page_id_t, std::shared_future<bool>> in_flight_;
+  /**
+   * Write-backs of evicted dirty pages that are still outstanding. A read of such a page must wait for them, and must
+   * not read the page if the write failed: its evictor then puts it back into its old frame, see RestoreVictim().
+   */
+  std::unordered_map<page_id_t, WriteBack> write_backs_;
+  /** Sequence number handed to the next write-back. */
+  uint64_t next_write_back_seq_{0};
+
+  /** The background flusher, if it is running. */
+  std::optional<std::thread> flusher_thread_;
+  /** Settings of the running background flusher. */
+  BackgroundFlusherOptions flusher_options_;
+  /** Tells the flusher to exit. Protected by latch_. */
+  bool flusher_stop_{false};
+  /** Wakes up the flusher early, either to stop or because a foreground thread had to write back a victim. */
+  std::condition_variable flusher_cv_;
+  /** Frames whose current page was last written back by the flusher. Protected by latch_. */
+  std::vector<bool> cleaned_by_flusher_;
+  std::atomic<uint64_t> pages_cleaned_{0};
+  std::atomic<uint64_t> write_backs_avoided_{0};
+
+  /** Counters reported by GetStats(). */
+  BufferPoolCounters counters_;
+  /** Latest access type of every frame. */
+  FrameArray<std::atomic<uint8_t>> frame_access_type_;
+  /** When every frame was last pinned from an unpinned state, in nanoseconds of the steady clock, 0 if unknown. */
+  FrameArray<std::atomic<uint64_t>> pinned_since_;
+
+  /** How many eviction candidates a prefetch looks at to find a clean victim. */
+  static constexpr size_t PREFETCH_VICTIM_CANDIDATES = 8;
+  /** Frames holding a prefetched page that no fetch has used yet. */
+  FrameArray<std::atomic<bool>> prefetched_;
+
+  /** How many eviction candidates AcquireFrame() asks the replacer for at first; doubled while they are all pinned. */
+  static constexpr size_t EVICTION_CANDIDATES = 8;
+
+  /** Number of access log stripes. Each thread appends to one of them, picked by its thread id. */
+  static constexpr size_t ACCESS_LOG_STRIPES = 16;
+  /** Number of entries in one stripe of the access log. */
+  static constexpr size_t ACCESS_LOG_STRIPE_SIZE = 64;
+
+  /**
+   * One stripe of the access log: a ring of encoded (page id, frame id, access type) entries, 0 meaning empty.
+   * Appending only touches the stripe, so threads on different stripes do not share cache lines.
+   */
+  struct alignas(64) AccessLogStripe {
+    /** Number of entries ever appended to the stripe. */
+    std::atomic<uint64_t> head_{0};
+    /** Number of entries replayed into the replacer, or skipped. Protected by latch_. */
+    uint64_t tail_{0};
+    std::array<std::atomic<uint64_t>, ACCESS_LOG_STRIPE_SIZE> entries_{};
+  };
+  /** Hits that have not been recorded in the replacer yet. Entries may be overwritten before they are replayed. */
+  std::unique_ptr<AccessLogStripe[]> access_log_;
 
   /**
    * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   *
+   * Pages come from the free-page map, lowest first, so freed pages are reused before the file grows. They are taken
+   * ALLOCATION_BATCH_SIZE at a time by NewPage(), which keeps the map latch and the bitmap scan off most allocations,
+   * and which refuses a page once the default segment is full: the page ids past it belong to other segments.
+   *
+   * Pages of other segments come from segments_: freed pages first, lowest first, then past the highest page handed
+   * out so far, mod-aligned with the instance index like the pages of the default segment.
+   *
+   * @param[out] reused set to true if the page may have old contents on disk
+   * @param segment the segment to allocate the page in
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(bool *reused, segment_id_t segment = DEFAULT_SEGMENT_ID) -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @return whether a page was handed out by AllocatePage() and not deallocated since, as far as this instance knows.
+   * Caller should acquire the latch.
+   */
+  auto IsAllocated(page_id_t page_id) -> bool;
+
+  /**
+   * @brief Give an unpinned, claimed frame back to the free list, dropping its contents. Its page must be out of the
+   * page table already. Caller should acquire the latch.
+   */
+  void FreeFrame(frame_id_t frame_id);
+
+  /**
+   * @brief Free a frame whose page could not be read in. The fetches that shared the read drop their pins without the
+   * latch once they see it fail, so wait for them first. Caller should hold `lock` on latch_ and one pin on the frame,
+   * and must have taken its page out of the page table and out of in_flight_.
+   */
+  void AbandonFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * @brief Put the page of a failed write-back back into the frame it was evicted from, dirty, as that frame holds its
+   * only good copy. The frame must not have been given another page yet. Caller should hold `lock` on latch_, which is
+   * released while a fetch of the page that saw the write fail backs off.
+   * @return false if the page was deleted in the meantime, in which case the frame is left without a page
+   */
+  auto RestoreVictim(frame_id_t frame_id, const WriteBack &write_back, std::unique_lock<std::mutex> *lock) -> bool;
+
+  /**
+   * @brief Deallocate a page on disk, so that AllocatePage() can hand it out again. Caller should acquire the latch
+   * before calling this function.
+   *
+   * The page joins the pages held back by AllocatePage(), which hands out the lowest of them first. Only when more
+   * than twice ALLOCATION_BATCH_SIZE pages are held back does the highest one go back to the free-page map. Pages that
+   * are not allocated are ignored.
+   *
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * @brief Take a frame from the free list, or evict one through the replacer. Caller should acquire the latch.
+   *
+   * If the victim holds a dirty page, its write-back is scheduled and returned through `write_back`; the frame must
+   * not be overwritten until the write-back has completed.
+   *
+   * @param[out] frame_id the frame that can be reused
+   * @param[out] write_back the outstanding write-back of the evicted page, if any
+   * @return false if every frame is pinned
+   */
+  auto AcquireFrame(frame_id_t *frame_id, std::optional<WriteBack> *write_back) -> bool;
 
-  // TODO(student): You may add additional private members and helper functions
+  /**
+   * @brief Detach an evicted frame from its page, scheduling the write-back of a dirty page like AcquireFrame() does.
+   * Caller should acquire the latch, must have claimed the frame and taken it out of the replacer.
+   * @param page_id the page that the frame held, as returned by TryClaimVictim()
+   */
+  void ReleaseVictim(frame_id_t frame_id, page_id_t page_id, std::optional<WriteBack> *write_back);
+
+  /** @brief Forget a completed write-back, unless it was superseded by a newer one. Caller should acquire the latch. */
+  void FinishWriteBack(const WriteBack &write_back);
+
+  /** @brief Give back the pages held back by AllocatePage(), and write the free-page map to disk. */
+  void FlushFreePageMap();
+
+  /** @brief Add a chunk of FrameArray::CHUNK_SIZE frames, backed by a new arena. Caller should hold resize_latch_. */
+  void AddFrameChunk();
+
+  /**
+   * @brief Take frame_id out of use for a shrink: evict its page, and wait until its pins are gone and its write-back,
+   * if any, is on disk. Caller should hold `lock` on latch_, which is released while waiting.
+   */
+  void DrainFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * @brief Replace replacer_ with `replacer`, seeded with one access to every resident page. Caller should acquire the
+   * latch.
+   */
+  void InstallReplacer(std::unique_ptr<Replacer> replacer);
+
+  /** @brief Pin the frame and record the access to page_id in the replacer. Caller should acquire the latch. */
+  void PinFrame(frame_id_t frame_id, AccessType access_type, page_id_t page_id);
+
+  /**
+   * @brief Update the statistics for a new pin of a frame. Does not need the latch.
+   * @param pin_count the pin count of the frame before the pin
+   */
+  void CountPin(frame_id_t frame_id, int pin_count, AccessType access_type);
+
+  /**
+   * @brief Drop one pin of a frame, marking its page dirty first if asked to. The pin count never goes below 0.
+   * Does not need the latch.
+   */
+  void UnpinFrame(frame_id_t frame_id, bool is_dirty);
+
+  /**
+   * @brief Take an unpinned frame away from its page, so that no fetch can pin it any more. A fetch that pins the
+   * frame concurrently either makes the claim fail, or sees the cleared page id and retries under the latch.
+   * Caller should acquire the latch.
+   *
+   * @param clean_only fail as well if the page is dirty
+   * @return the id of the page that the frame held, or INVALID_PAGE_ID if the frame could not be claimed
+   */
+  auto TryClaimVictim(frame_id_t frame_id, bool clean_only) -> page_id_t;
+
+  /** @brief Log a hit served without the latch. Replays the log when a stripe fills up and the latch is free. */
+  void LogAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type);
+
+  /**
+   * @brief Record the logged accesses in the replacer, skipping those whose frame has moved on to another page.
+   * Caller should acquire the latch.
+   */
+  void DrainAccessLog();
+
+  /**
+   * @brief Hand a read or write of one page to the disk scheduler.
+   * @param priority queue of the scheduler to wait in: Foreground if a fetch waits for the request
+   * @param on_complete optional hook that the scheduler runs on its worker thread once the request is done
+   */
+  auto ScheduleIo(bool is_write, char *data, page_id_t page_id, DiskRequestPriority priority,
+                  std::function<void(bool)> on_complete = {}) -> std::future<bool>;
+
+  /** @brief Body of the background flusher thread. */
+  void RunBackgroundFlusher();
+
+  /**
+   * @brief Write back the dirty, unpinned pages among `frames`, at most `budget` of them. Pages that are latched for
+   * writing are skipped. Caller must not hold the latch.
+   * @return the number of pages written
+   */
+  auto CleanFrames(const std::vector<frame_id_t> &frames, size_t budget) -> size_t;
 };
 }  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+
+#include "buffer/lru_k_replacer.h"
+
+namespace bustub {
+
+/** A snapshot of the counters of a buffer pool, see BufferPoolManager::GetStats(). */
+struct BufferPoolStats {
+  /** Fetches of a page that was already in the pool. */
+  uint64_t hits_{0};
+  /** Fetches that had to read the page from disk. */
+  uint64_t misses_{0};
+  /** Pages that were evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Evicted pages that were dirty and had to be written back. */
+  uint64_t dirty_write_backs_{0};
+  /** Fetches that had to wait for another thread's read of the page, or for a write-back of it, to complete. */
+  uint64_t pin_waits_{0};
+  /** How many times a frame went from unpinned to pinned and back. */
+  uint64_t pin_intervals_{0};
+  /** Total time that frames stayed pinned over all of those intervals. */
+  std::chrono::nanoseconds pinned_time_{0};
+  /** Number of resident pages, by the type of their latest access. */
+  std::array<uint64_t, NUM_ACCESS_TYPES> frames_by_access_type_{};
+
+  /** @return the fraction of fetches that were hits, 0 if there were no fetches */
+  auto HitRatio() const -> double;
+
+  /** @return the average time that a frame stays pinned */
+  auto AveragePinDuration() const -> std::chrono::nanoseconds;
+
+  /** @brief Add the counters of another pool, e.g. of another shard of the same pool. */
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats &;
+};
+
+/**
+ * The live counters behind BufferPoolStats. The counters are striped by thread, and every stripe has a cache line to
+ * itself, so that counting on the hit path neither takes a latch nor bounces a shared cache line between cores.
+ * Reading a counter sums all the stripes with relaxed loads, so a snapshot is not atomic across counters.
+ */
+class BufferPoolCounters {
+ public:
+  enum Counter { HITS = 0, MISSES, EVICTIONS, DIRTY_WRITE_BACKS, PIN_WAITS, PIN_INTERVALS, PINNED_NS, NUM_COUNTERS };
+
+  /** Number of counter stripes. */
+  static constexpr size_t STRIPES = 16;
+
+  /** @brief Add n to a counter, in the stripe of the calling thread. */
+  void Add(Counter counter, uint64_t n = 1) {
+    stripes_[ThreadStripe()].counters_[counter].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /** @return the value of a counter, summed over all stripes */
+  auto Get(Counter counter) const -> uint64_t;
+
+  /** @return a snapshot of the counters. frames_by_access_type_ is left empty. */
+  auto Snapshot() const -> BufferPoolStats;
+
+  /** @return the stripe that the calling thread uses, in [0, STRIPES) */
+  static auto ThreadStripe() -> size_t;
+
+ private:
+  struct alignas(64) Stripe {
+    std::array<std::atomic<uint64_t>, NUM_COUNTERS> counters_{};
+  };
+  std::array<Stripe, STRIPES> stripes_{};
+};
+
+}  // namespace bustub
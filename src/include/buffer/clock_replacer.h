@@ -23,6 +23,9 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every access sets the frame's reference bit. The clock hand sweeps over the evictable frames, clearing reference
+ * bits, and evicts the first frame whose bit is already clear.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -37,16 +40,32 @@ class ClockReplacer : public Replacer {
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  auto EvictionCandidates(size_t n) -> std::vector<frame_id_t> override;
+
+  /** Unpinning a frame that is already unpinned does not count as an access. */
+  void Unpin(frame_id_t frame_id) override;
+
  private:
-  // TODO(student): implement me!
+  void CheckFrame(frame_id_t frame_id) const;
+
+  /** Per-frame state, indexed by frame id. The clock hand sweeps over the frames in frame id order. */
+  std::vector<bool> tracked_;
+  std::vector<bool> evictable_;
+  std::vector<bool> referenced_;
+  size_t hand_{0};
+  size_t curr_size_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the data of every frame of a buffer pool in one contiguous, page-aligned block of memory, so that
+ * frames can be handed to O_DIRECT reads and writes as they are.
+ *
+ * The arena is an anonymous mmap, which is always page-aligned. If huge pages are requested, the mapping is rounded up
+ * to a whole number of huge pages and advised with MADV_HUGEPAGE; whether the kernel backs it with transparent huge
+ * pages is up to its THP settings. If the mapping fails, the arena falls back to an aligned heap allocation.
+ */
+class FrameArena {
+ public:
+  /** Alignment of every frame, which is also the alignment that O_DIRECT needs. */
+  static constexpr size_t FRAME_ALIGNMENT = 4096;
+
+  /**
+   * @brief Allocate a zeroed arena.
+   * @param num_frames number of frames of BUSTUB_PAGE_SIZE bytes each
+   * @param huge_pages true to ask for transparent huge pages
+   */
+  FrameArena(size_t num_frames, bool huge_pages);
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the data of frame frame_id */
+  auto GetFrame(frame_id_t frame_id) -> char * {
+    return data_ + static_cast<size_t>(frame_id) * static_cast<size_t>(BUSTUB_PAGE_SIZE);
+  }
+
+  /**
+   * @brief Give the memory of `count` frames, starting at first, back to the kernel. The frames stay usable, and read
+   * as zeroes until they are written again.
+   */
+  void Discard(frame_id_t first, size_t count);
+
+  /** @return true if the arena is an mmap, false if it fell back to the heap */
+  auto IsMapped() const -> bool { return mapped_; }
+
+ private:
+  char *data_{nullptr};
+  /** Size of the allocation in bytes; may be larger than the frames need. */
+  size_t size_{0};
+  bool mapped_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_array.h
+//
+// Identification: src/include/buffer/frame_array.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArray holds one element per frame of a buffer pool, and can grow while other threads index it without a latch.
+ *
+ * The frames the pool is created with are one contiguous block. Every later growth adds a chunk of CHUNK_SIZE
+ * elements, found through a fixed directory of chunk pointers. Elements never move and are only destroyed with the
+ * array, so a reference to an element stays valid after the pool shrinks and grows again.
+ *
+ * Indexing must stay below Capacity(). Init() and AddChunk() must be serialized by the caller.
+ */
+template <typename T>
+class FrameArray {
+ public:
+  /** Number of elements added by AddChunk(). */
+  static constexpr size_t CHUNK_SIZE = 1024;
+  /** Most chunks an array can add after its first block. */
+  static constexpr size_t MAX_CHUNKS = 1024;
+
+  FrameArray() = default;
+
+  ~FrameArray() {
+    Destroy(first_, first_size_);
+    for (size_t c = 0; c < num_chunks_; c++) {
+      Destroy(chunks_[c].load(std::memory_order_relaxed), CHUNK_SIZE);
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(FrameArray);
+
+  auto operator[](size_t frame_id) -> T & {
+    if (frame_id < first_size_) {
+      return first_[frame_id];
+    }
+    frame_id -= first_size_;
+    return chunks_[frame_id / CHUNK_SIZE].load(std::memory_order_acquire)[frame_id % CHUNK_SIZE];
+  }
+
+  /** @return the first block, which holds elements [0, FirstBlockSize()) */
+  auto Data() -> T * { return first_; }
+
+  auto FirstBlockSize() const -> size_t { return first_size_; }
+
+  /** @return the number of elements; growing the array raises it, nothing lowers it */
+  auto Capacity() const -> size_t { return capacity_.load(std::memory_order_acquire); }
+
+  /** @return the largest capacity the array can grow to */
+  auto MaxCapacity() const -> size_t { return first_size_ + MAX_CHUNKS * CHUNK_SIZE; }
+
+  /**
+   * @brief Create the first block of `size` elements. `make(element, frame_id)` constructs each element in place.
+   */
+  template <typename Make>
+  void Init(size_t size, Make make) {
+    BUSTUB_ASSERT(first_ == nullptr && num_chunks_ == 0, "frame array is already initialized");
+    first_ = Create(0, size, make);
+    first_size_ = size;
+    capacity_.store(size, std::memory_order_release);
+  }
+
+  /** @brief Create the first block of `size` value-initialized elements. */
+  void Init(size_t size) {
+    Init(size, [](T *element, size_t) { new (element) T(); });
+  }
+
+  /** @brief Append a chunk of CHUNK_SIZE elements, constructed by `make(element, frame_id)`. */
+  template <typename Make>
+  void AddChunk(Make make) {
+    BUSTUB_ASSERT(num_chunks_ < MAX_CHUNKS, "frame array is full");
+    const size_t capacity = capacity_.load(std::memory_order_relaxed);
+    chunks_[num_chunks_++].store(Create(capacity, CHUNK_SIZE, make), std::memory_order_release);
+    capacity_.store(capacity + CHUNK_SIZE, std::memory_order_release);
+  }
+
+  /** @brief Append a chunk of CHUNK_SIZE value-initialized elements. */
+  void AddChunk() {
+    AddChunk([](T *element, size_t) { new (element) T(); });
+  }
+
+ private:
+  template <typename Make>
+  static auto Create(size_t first_frame_id, size_t size, Make &make) -> T * {
+    auto *elements = static_cast<T *>(::operator new[](sizeof(T) * size));
+    for (size_t i = 0; i < size; i++) {
+      make(&elements[i], first_frame_id + i);
+    }
+    return elements;
+  }
+
+  static void Destroy(T *elements, size_t size) {
+    for (size_t i = 0; elements != nullptr && i < size; i++) {
+      elements[i].~T();
+    }
+    ::operator delete[](elements);
+  }
+
+  T *first_{nullptr};
+  size_t first_size_{0};
+  std::atomic<size_t> capacity_{0};
+  /** Number of chunks in use. Only changed by AddChunk(). */
+  size_t num_chunks_{0};
+  std::array<std::atomic<T *>, MAX_CHUNKS> chunks_{};
+};
+
+}  // namespace bustub
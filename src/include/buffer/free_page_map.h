@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.h
+//
+// Identification: src/include/buffer/free_page_map.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * FreePageMap tracks which pages of a buffer pool instance are in use, one bit per page, so that the pages given back
+ * by DeletePage() are handed out again before the database file grows.
+ *
+ * An instance owns the page ids `instance_index + i * num_instances`; bit `i` of the map stands for the i-th of them.
+ * The bits are kept in map pages of BUSTUB_PAGE_SIZE bytes. Map page `k` of the instance is stored by the disk manager
+ * as free-map page `k * num_instances + instance_index`, so the instances of a parallel buffer pool share one map file.
+ * The map is loaded when it is created and written back by Flush(). It only hands out page ids of the default segment,
+ * below DEFAULT_SEGMENT_PAGES, since the page ids above them belong to other segments.
+ */
+class FreePageMap {
+ public:
+  /** Number of pages described by one map page. */
+  static constexpr size_t PAGES_PER_MAP_PAGE = BUSTUB_PAGE_SIZE * 8;
+
+  /**
+   * @brief Load the map of an instance.
+   * @param disk_manager where the map is stored, nullptr to keep it in memory only
+   * @param num_instances number of instances sharing the disk manager
+   * @param instance_index index of the instance that owns the map
+   */
+  FreePageMap(DiskManager *disk_manager, uint32_t num_instances, uint32_t instance_index);
+
+  /**
+   * @brief Allocate up to `count` pages in one pass over the map. The lowest free pages come first, so that freed
+   * pages are reused before the file is extended and the file stays as dense as possible.
+   * @return the allocated page ids, in ascending order; fewer than `count`, or none, once the default segment is full
+   */
+  auto Allocate(size_t count) -> std::vector<page_id_t>;
+
+  /** @brief Mark page_id as free. Freeing a page that is not allocated, or INVALID_PAGE_ID, has no effect. */
+  void Free(page_id_t page_id);
+
+  /** @return true if page_id is allocated */
+  auto IsAllocated(page_id_t page_id) -> bool;
+
+  /** @return one past the highest allocated page id of the instance, or the instance index if nothing is allocated */
+  auto End() -> page_id_t;
+
+  /** @return the number of allocated pages */
+  auto NumAllocated() -> size_t;
+
+  /** @brief Write the map pages changed since the last flush to the disk manager. */
+  void Flush();
+
+ private:
+  static constexpr size_t WORDS_PER_MAP_PAGE = BUSTUB_PAGE_SIZE / sizeof(uint64_t);
+
+  auto ToPageId(size_t slot) const -> page_id_t {
+    return static_cast<page_id_t>(slot * num_instances_ + instance_index_);
+  }
+
+  DiskManager *disk_manager_;
+  const uint32_t num_instances_;
+  const uint32_t instance_index_;
+  /** Number of page ids of the instance in the default segment, the most bits the map hands out. */
+  const size_t max_slots_;
+
+  /** Serializes Flush(), so that an older copy of a map page never overwrites a newer one. */
+  std::mutex flush_latch_;
+  /** Protects everything below. */
+  std::mutex latch_;
+  /** The bitmap, map page after map page. A set bit is an allocated page. */
+  std::vector<uint64_t> words_;
+  /** Map pages changed since the last flush. */
+  std::vector<bool> dirty_;
+  /** No word before this one has a free bit. */
+  size_t first_free_word_{0};
+  size_t num_allocated_{0};
+};
+
+}  // namespace bustub
@@ -12,29 +12,62 @@
 
 #pragma once
 
-#include <algorithm>
 #include <iostream>
 #include <limits>
-#include <list>
-#include <map>
 #include <mutex>  // NOLINT
-#include <unordered_map>
 #include <utility>
 #include <vector>
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 namespace bustub {
 
-enum class AccessType { Unknown = 0, Lookup, Scan, Index, Get };
-
+/**
+ * Per-frame bookkeeping of the LRU-K replacer. One node is preallocated for every frame; the node's last K access
+ * timestamps live in a ring of K slots owned by the replacer (see LRUKReplacer::history_).
+ */
 class LRUKNode {
  public:
-  /** History of last seen K timestamps of this page. Least recent timestamp stored in front. */
-  // Remove maybe_unused if you start using them. Feel free to change the member variables as you want.
-  std::list<size_t> history_;
+  /** Ring slot holding the least recent of the recorded timestamps. */
+  size_t head_{0};
+  /** Number of recorded timestamps, at most K. A node with k_ == 0 is not tracked by the replacer. */
   size_t k_{0};
-  frame_id_t fid_;
+  frame_id_t fid_{-1};
   bool is_evictable_{false};
+  /** True while every access to the frame since it was loaded has been a Scan. */
+  bool is_scan_{false};
+};
+
+/**
+ * LRUKFrameHeap is a binary min-heap of (key, frame id) pairs that also remembers where every frame sits in the heap,
+ * so that a frame can be erased or re-keyed in O(log n). All storage is allocated up front for `num_frames` frames.
+ */
+class LRUKFrameHeap {
+ public:
+  explicit LRUKFrameHeap(size_t num_frames) : pos_(num_frames, NPOS) { heap_.reserve(num_frames); }
+
+  auto Empty() const -> bool { return heap_.empty(); }
+  auto Contains(frame_id_t frame_id) const -> bool { return pos_[frame_id] != NPOS; }
+  /** @return the frame with the smallest key. The heap must not be empty. */
+  auto Top() const -> frame_id_t { return heap_.front().second; }
+
+  void Push(frame_id_t frame_id, size_t key);
+  void Erase(frame_id_t frame_id);
+  /** Change the key of a frame that is already in the heap. */
+  void Update(frame_id_t frame_id, size_t key);
+  /** Append up to n frames with the smallest keys to `out`, smallest first. Takes O(n log n). */
+  void Smallest(size_t n, std::vector<frame_id_t> *out) const;
+
+ private:
+  static constexpr size_t NPOS = std::numeric_limits<size_t>::max();
+
+  void SiftUp(size_t idx);
+  void SiftDown(size_t idx);
+  void Place(size_t idx, std::pair<size_t, frame_id_t> entry);
+
+  std::vector<std::pair<size_t, frame_id_t>> heap_;
+  /** Index of each frame in heap_, or NPOS if the frame is not in the heap. */
+  std::vector<size_t> pos_;
 };
 
 /**
@@ -47,13 +80,19 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Evictable frames are kept in two indexed min-heaps: frames with +inf distance keyed by their first access, and
+ * frames with k accesses keyed by their kth most recent access. Recording an access, toggling evictability, removing
+ * and evicting are all O(log n) and never allocate.
+ *
+ * The replacer is scan resistant. A frame loaded by an AccessType::Scan access does not gain history from further
+ * scans, and such scan-only frames are evicted before any other frame, oldest first. A sequential scan therefore
+ * recycles its own frames instead of pushing hot index and lookup pages out of the pool. The first non-scan access
+ * turns a scan-only frame into a regular one.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief a new LRUKReplacer.
    * @param num_frames the maximum number of frames the LRUReplacer will be required to store
    */
@@ -62,15 +101,11 @@ class LRUKReplacer {
   DISALLOW_COPY_AND_MOVE(LRUKReplacer);
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Find the frame with largest backward k-distance and evict that frame. Only frames
    * that are marked as 'evictable' are candidates for eviction.
    *
@@ -84,26 +119,24 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Record the event that the given frame id is accessed at current timestamp.
    * Create a new entry for access history if frame id has not been seen before.
    *
-   * If frame id is invalid (ie. larger than replacer_size_), throw an exception. You can
-   * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
+   * If frame id is invalid (ie. larger than replacer_size_), throw an exception.
+   *
+   * A Scan access to a frame that is already tracked is not recorded, see the class comment.
    *
    * @param frame_id id of frame that received a new access.
-   * @param access_type type of access that was received. This parameter is only needed for
-   * leaderboard tests.
+   * @param access_type type of access that was received.
+   * @param page_id unused, LRU-K forgets a frame's history when the frame is evicted.
    */
-  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Toggle whether a frame is evictable or non-evictable. This function also
    * controls replacer's size. Note that size is equal to number of evictable entries.
    *
@@ -111,18 +144,16 @@ class LRUKReplacer {
    * decrement. If a frame was previously non-evictable and is to be set to evictable,
    * then size should increment.
    *
-   * If frame id is invalid, throw an exception or abort the process.
+   * If frame id is invalid, throw an exception.
    *
    * For other scenarios, this function should terminate without modifying anything.
    *
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Remove an evictable frame from replacer, along with its access history.
    * This function should also decrement replacer's size if removal is successful.
    *
@@ -130,49 +161,66 @@ class LRUKReplacer {
    * with largest backward k-distance. This function removes specified frame id,
    * no matter what its backward k-distance is.
    *
-   * If Remove is called on a non-evictable frame, throw an exception or abort the
-   * process.
+   * If Remove is called on a non-evictable frame, throw an exception.
    *
    * If specified frame is not found, directly return from this function.
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Return replacer's size, which tracks the number of evictable frames.
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
 
   /**
+   * @brief List the evictable frames that Evict() would pick next, without evicting them.
    *
-   * @brief Enroll the map.
+   * @param n the maximum number of frames to return
+   * @return up to n frames, the next victim first
+   */
+  auto EvictionCandidates(size_t n) -> std::vector<frame_id_t> override;
+
+  /**
+   *
+   * @brief Print the recorded access history of a frame, least recent first.
    *
    * @return non
    */
   void Eroll(frame_id_t frame_id);
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  std::unordered_map<frame_id_t, LRUKNode> node_store_;
-  // TO save the evitable frames whose his-len is over k_
-  std::map<frame_id_t, size_t> over_k_;
-  std::list<frame_id_t> over_;
-  // TO save the evitable frames whose his-len is lower than k_
-  std::map<frame_id_t, size_t> below_k_;
-  std::list<frame_id_t> below_;
-  [[maybe_unused]] size_t current_timestamp_{0};
-  [[maybe_unused]] size_t curr_size_{0};
-  [[maybe_unused]] size_t replacer_size_;
-  [[maybe_unused]] size_t k_;
-  [[maybe_unused]] std::mutex latch_;
-  [[maybe_unused]] bool *evictable_;
-  static auto MyCmp(std::pair<frame_id_t, size_t> elem1, std::pair<frame_id_t, size_t> elem2) -> bool;
+  /** @return the eviction key of a tracked node: its first access if it has < k accesses, its kth last otherwise. */
+  auto Key(const LRUKNode &node) const -> size_t { return history_[node.fid_ * k_ + node.head_]; }
+  /** @return the heap a tracked node belongs to while it is evictable. */
+  auto PoolOf(const LRUKNode &node) -> LRUKFrameHeap & {
+    if (node.is_scan_) {
+      return scan_;
+    }
+    return node.k_ < k_ ? below_k_ : over_k_;
+  }
+  /** Forget the access history of a node that has left the replacer. */
+  static void ResetNode(LRUKNode *node);
+  void CheckFrame(frame_id_t frame_id) const;
+
+  /** One node per frame, indexed by frame id. */
+  std::vector<LRUKNode> node_store_;
+  /** Ring buffers of the last k timestamps, k slots per frame. */
+  std::vector<size_t> history_;
+  /** Evictable scan-only frames, keyed by the time they were loaded. */
+  LRUKFrameHeap scan_;
+  /** Evictable frames with fewer than k accesses (+inf backward k-distance). */
+  LRUKFrameHeap below_k_;
+  /** Evictable frames with k accesses. */
+  LRUKFrameHeap over_k_;
+  size_t current_timestamp_{0};
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  size_t k_;
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -22,7 +22,8 @@
 namespace bustub {
 
 /**
- * LRUReplacer implements the Least Recently Used replacement policy.
+ * LRUReplacer implements the Least Recently Used replacement policy. Evicting skips over the non-evictable frames at
+ * the least recently used end, so it is O(1) as long as few frames are pinned.
  */
 class LRUReplacer : public Replacer {
  public:
@@ -37,16 +38,33 @@ class LRUReplacer : public Replacer {
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  auto EvictionCandidates(size_t n) -> std::vector<frame_id_t> override;
+
+  /** Unpinning a frame that is already unpinned does not count as an access. */
+  void Unpin(frame_id_t frame_id) override;
+
  private:
-  // TODO(student): implement me!
+  void CheckFrame(frame_id_t frame_id) const;
+
+  /** Tracked frames, least recently used first. */
+  std::list<frame_id_t> lru_list_;
+  /** Position of every tracked frame in lru_list_, indexed by frame id. */
+  std::vector<std::list<frame_id_t>::iterator> pos_;
+  std::vector<bool> tracked_;
+  std::vector<bool> evictable_;
+  size_t curr_size_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
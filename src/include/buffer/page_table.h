@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the pages resident in a buffer pool to their frames. It is an open-addressing hash table with linear
+ * probing, sized for the pool so that it never has to grow while pages come and go. Reserve() grows it when the pool
+ * itself grows.
+ *
+ * Lookups are lock-free and may run concurrently with a writer. Inserts and erases must be serialized by the caller;
+ * the buffer pool does them under its latch. A lookup that races with a writer may miss an entry that is being moved,
+ * or find an entry that is being removed. The buffer pool validates every hit against the frame's page id and retries
+ * a miss under its latch, so neither outcome is visible to its callers.
+ */
+class PageTable {
+ public:
+  PageTable() = default;
+
+  /** @brief Create a table for a pool of `num_frames` frames. */
+  explicit PageTable(size_t num_frames);
+
+  PageTable(const PageTable &) = delete;
+  auto operator=(const PageTable &) -> PageTable & = delete;
+
+  /**
+   * @brief Make room for a pool of `num_frames` frames, rehashing the entries into a larger array if needed. Must be
+   * serialized with the writers. The old array is kept until the table is destroyed, so that a lookup still walking
+   * it stays safe; it only misses the entries changed after the switch.
+   */
+  void Reserve(size_t num_frames);
+
+  /** @return the frame holding page_id, or -1 if the page is not in the table */
+  auto Find(page_id_t page_id) const -> frame_id_t;
+
+  /** @brief Map page_id to frame_id. The page must not be in the table already. */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /** @brief Remove page_id from the table, if it is there. */
+  void Erase(page_id_t page_id);
+
+  /** @return the number of pages in the table */
+  auto Size() const -> size_t { return size_; }
+
+  /** @return the ids of all the pages in the table. Must be serialized with the writers. */
+  auto PageIds() const -> std::vector<page_id_t>;
+
+ private:
+  static constexpr uint64_t EMPTY = UINT64_MAX;
+
+  /** An array of slots. Readers load the current one once per lookup. */
+  struct Table {
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+    size_t mask_;
+  };
+
+  static auto Encode(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageOf(uint64_t entry) -> page_id_t { return static_cast<page_id_t>(entry >> 32); }
+  static auto FrameOf(uint64_t entry) -> frame_id_t { return static_cast<frame_id_t>(entry & UINT32_MAX); }
+
+  /** @return the slot at which the probe for page_id starts */
+  static auto Home(page_id_t page_id, size_t mask) -> size_t {
+    uint64_t hash = static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL;
+    return (hash ^ (hash >> 32)) & mask;
+  }
+
+  static void InsertInto(Table *table, uint64_t entry);
+
+  /** The array in use. Changed only by Reserve(). */
+  std::atomic<Table *> table_{nullptr};
+  /** Every array the table has used, the current one last. */
+  std::vector<std::unique_ptr<Table>> tables_;
+  size_t size_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager splits the buffer pool into several independent BufferPoolManager instances, each with its
+ * own latch, page table and replacer. A page always lives in the instance `page_id % num_instances`, and new pages are
+ * allocated from the instances in a round-robin fashion.
+ *
+ * It exposes the same interface as BufferPoolManager, so it can be handed to anything that takes a
+ * `BufferPoolManager *`. Page guards returned by it are bound to the owning instance.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @brief Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManager instances
+   * @param pool_size the size of each instance's buffer pool
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr);
+
+  /**
+   * @brief Destroy an existing ParallelBufferPoolManager and all of its instances.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @brief Return the total size (number of frames) of all the instances. */
+  auto GetPoolSize() -> size_t override;
+
+  /** @brief Return the number of instances. */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+  /** @brief Return the instance at `index`, which holds the pages `page_id % num_instances == index`. */
+  auto GetInstance(size_t index) -> BufferPoolManager * { return instances_[index].get(); }
+
+  /**
+   * @brief A parallel pool has no single page array: each instance owns its own frames.
+   * @throws NotImplementedException always; use GetInstance(i)->GetPages() instead
+   */
+  auto GetPages() -> Page * override;
+
+  /**
+   * @brief Create a new page in one of the instances. Instances are tried in round-robin order, starting one past
+   * the instance that served the previous call, until one of them has a frame to spare.
+   *
+   * @param[out] page_id id of created page
+   * @param segment segment to allocate the page in
+   * @return nullptr if no instance could create a new page, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id, segment_id_t segment = DEFAULT_SEGMENT_ID) -> Page * override;
+
+  auto NewPageGuarded(page_id_t *page_id, segment_id_t segment = DEFAULT_SEGMENT_ID) -> BasicPageGuard override;
+
+  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page * override;
+
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard override;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard override;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard override;
+  auto FetchPageOptimistic(page_id_t page_id, AccessType access_type = AccessType::Unknown)
+      -> OptimisticPageGuard override;
+
+  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool override;
+
+  auto FlushPage(page_id_t page_id) -> bool override;
+
+  /** @brief Flush the dirty pages of all the instances as one checkpoint, in page id order across the instances. */
+  void FlushAllPages() override;
+
+  auto DeletePage(page_id_t page_id) -> bool override;
+
+  auto PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> bool override;
+
+  /** @brief Advise the shared disk manager of the range once, then prefetch every page in its own instance. */
+  auto PrefetchRange(page_id_t first_page_id, size_t num_pages, AccessType access_type = AccessType::Unknown)
+      -> size_t override;
+
+  void CreateSegment(segment_id_t segment, const std::string &directory = "") override;
+
+  /** @brief Discard the pages of the segment in every instance, then drop it. */
+  auto DropSegment(segment_id_t segment) -> bool override;
+
+  /** @brief Discard the pages of the segment in every instance. */
+  auto DiscardSegment(segment_id_t segment) -> bool override;
+
+  /** @brief Start a background flusher in every instance. The rate limits in `options` apply to each instance. */
+  void StartBackgroundFlusher(const BackgroundFlusherOptions &options = {}) override;
+
+  void StopBackgroundFlusher() override;
+
+  /** @return the flusher counters summed over all instances */
+  auto GetBackgroundFlusherStats() -> BackgroundFlusherStats override;
+
+  /** @return the counters of all the instances, summed */
+  auto GetStats() -> BufferPoolStats override;
+
+  /** @return the counters of every instance, in instance order */
+  auto GetShardStats() -> std::vector<BufferPoolStats>;
+
+  /** @brief Switch every instance to another replacement policy. */
+  void SetReplacer(const std::string &policy) override;
+
+  /**
+   * @brief Resize every instance, splitting pool_size evenly among them; the first instances get one frame more when
+   * it does not divide. GetPoolSize() reports the new total afterwards.
+   * @throws Exception if pool_size is smaller than the number of instances
+   */
+  void Resize(size_t pool_size) override;
+
+ private:
+  /** @return the instance responsible for page_id */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager *;
+
+  /** The disk manager shared by all the instances. */
+  DiskManager *disk_manager_;
+  /** The individual buffer pool manager instances. */
+  std::vector<std::unique_ptr<BufferPoolManager>> instances_;
+  /** Index of the instance that NewPage tries first on its next call. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.h
+//
+// Identification: src/include/buffer/read_ahead.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/lru_k_replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ReadAhead watches an iterator walk a chain of pages (table heap pages, B+ tree leaves) and, once the walk looks
+ * sequential, keeps the next `read_ahead_window` pages of the chain in flight through BufferPoolManager::PrefetchPage.
+ *
+ * A walk is sequential when two hops in a row advance the page id by the same positive stride. The chain itself can
+ * only be followed one page at a time, so the read-ahead bets that the pages after the current one continue with the
+ * same stride; a wrong guess costs a wasted read, never a wrong result.
+ */
+class ReadAhead {
+ public:
+  ReadAhead() = default;
+
+  /**
+   * @param bpm the buffer pool to prefetch into
+   * @param access_type the access type passed along with every prefetch
+   * @param last_page_id the last page of the chain that may be prefetched, or INVALID_PAGE_ID for no bound
+   */
+  ReadAhead(BufferPoolManager *bpm, AccessType access_type, page_id_t last_page_id = INVALID_PAGE_ID)
+      : bpm_(bpm), access_type_(access_type), last_page_id_(last_page_id) {}
+
+  /**
+   * @brief Tell the read-ahead that the iterator moved from page `from` to page `to`, and prefetch if the walk is
+   * sequential.
+   */
+  void OnHop(page_id_t from, page_id_t to);
+
+ private:
+  BufferPoolManager *bpm_{nullptr};
+  AccessType access_type_{AccessType::Unknown};
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+  /** Distance between the page ids of the last hop. */
+  page_id_t stride_{0};
+  /** The next page id to prefetch. */
+  page_id_t next_prefetch_{INVALID_PAGE_ID};
+};
+
+}  // namespace bustub
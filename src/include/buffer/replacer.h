@@ -12,39 +12,100 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+enum class AccessType { Unknown = 0, Lookup, Scan, Index, Get };
+
+/** Number of values of AccessType. */
+static constexpr size_t NUM_ACCESS_TYPES = 5;
+
 /**
  * Replacer is an abstract class that tracks page usage.
+ *
+ * The buffer pool records every access to a frame, marks frames evictable or not, and asks for victims. It may also
+ * pick a victim itself among EvictionCandidates() and Remove() it, which a policy must treat like an eviction of that
+ * frame.
  */
 class Replacer {
  public:
   Replacer() = default;
   virtual ~Replacer() = default;
 
+  /**
+   * Evict the frame that the replacement policy picks among the evictable frames, and stop tracking it.
+   * @param[out] frame_id id of the evicted frame
+   * @return true if a frame was evicted, false if no frame is evictable
+   */
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * Record an access to a frame, and start tracking the frame as non-evictable if it is not tracked yet.
+   * @param frame_id id of the accessed frame
+   * @param access_type type of the access
+   * @param page_id the page held by the frame, for policies that remember pages after they have been evicted
+   */
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                            page_id_t page_id = INVALID_PAGE_ID) = 0;
+
+  /**
+   * Mark a tracked frame evictable or not. Does nothing if the frame is not tracked.
+   * @param frame_id id of the frame
+   * @param set_evictable whether the frame may be evicted
+   */
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
+
+  /**
+   * Stop tracking an evictable frame. Does nothing if the frame is not tracked, and throws if it is not evictable.
+   * @param frame_id id of the frame
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
+
+  /** @return the number of elements in the replacer that can be victimized */
+  virtual auto Size() -> size_t = 0;
+
+  /**
+   * List the evictable frames in the order the policy would evict them, without evicting them.
+   * @param n the maximum number of frames to return
+   * @return up to n frames, the next victim first
+   */
+  virtual auto EvictionCandidates(size_t n) -> std::vector<frame_id_t> = 0;
+
   /**
    * Remove the victim frame as defined by the replacement policy.
    * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
    * @return true if a victim frame was found, false otherwise
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual auto Victim(frame_id_t *frame_id) -> bool { return Evict(frame_id); }
 
   /**
    * Pins a frame, indicating that it should not be victimized until it is unpinned.
    * @param frame_id the id of the frame to pin
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void Pin(frame_id_t frame_id) { SetEvictable(frame_id, false); }
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
+   * Unpins a frame, indicating that it can now be victimized. Unpinning counts as an access to the frame.
    * @param frame_id the id of the frame to unpin
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
-
-  /** @return the number of elements in the replacer that can be victimized */
-  virtual auto Size() -> size_t = 0;
+  virtual void Unpin(frame_id_t frame_id) {
+    RecordAccess(frame_id);
+    SetEvictable(frame_id, true);
+  }
 };
 
+/**
+ * Create a replacer for a buffer pool.
+ * @param policy one of "lru_k", "lru", "clock", "2q" and "arc", case-insensitive
+ * @param num_frames number of frames of the buffer pool
+ * @param k the lookback constant of "lru_k"
+ * @throws Exception if the policy is unknown
+ */
+auto MakeReplacer(const std::string &policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer>;
+
 }  // namespace bustub
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.h
+//
+// Identification: src/include/buffer/two_q_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQReplacer implements the full 2Q policy of Johnson and Shasha.
+ *
+ * A newly loaded frame enters the FIFO queue A1in, and further accesses leave it there. When a frame leaves A1in, its
+ * page is remembered in the ghost FIFO A1out. A page that is loaded again while it is still in A1out has proven to be
+ * hot and goes to the LRU list Am. Evict() takes from A1in while A1in holds more than Kin = c / 4 frames, and from Am
+ * otherwise. A1out remembers up to Kout = c / 2 pages.
+ *
+ * A page reloaded by a Scan access goes back to A1in, so scans never pollute Am. Remove() is treated like an eviction,
+ * since the buffer pool picks its victims among EvictionCandidates().
+ */
+class TwoQReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new TwoQReplacer.
+   * @param num_frames the number of frames of the buffer pool
+   */
+  explicit TwoQReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQReplacer);
+
+  ~TwoQReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t n) -> std::vector<frame_id_t> override;
+
+ private:
+  struct FrameEntry {
+    bool tracked_{false};
+    bool evictable_{false};
+    /** Whether the frame is in Am rather than A1in. */
+    bool in_am_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  void CheckFrame(frame_id_t frame_id) const;
+  /** Up to n victims in eviction order, without modifying anything. */
+  auto PickVictims(size_t n) const -> std::vector<frame_id_t>;
+  /** Stop tracking a frame, and remember its page in A1out if it leaves A1in. */
+  void Detach(frame_id_t frame_id);
+
+  /** FIFO of frames accessed in one burst, oldest first. */
+  std::list<frame_id_t> a1in_;
+  /** LRU list of hot frames, least recently used first. */
+  std::list<frame_id_t> am_;
+  /** FIFO of pages evicted from A1in, oldest first. */
+  std::list<page_id_t> a1out_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> a1out_index_;
+  std::vector<FrameEntry> frames_;
+  size_t kin_;
+  size_t kout_;
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -70,15 +70,17 @@ struct IndexInfo {
    * @param index_oid The unique OID for the index
    * @param table_name The name of the table on which the index is created
    * @param key_size The size of the index key, in bytes
+   * @param segment The segment that the pages of the index are in
    */
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, segment_id_t segment = DEFAULT_SEGMENT_ID)
       : key_schema_{std::move(key_schema)},
         name_{std::move(name)},
         index_{std::move(index)},
         index_oid_{index_oid},
         table_name_{std::move(table_name)},
-        key_size_{key_size} {}
+        key_size_{key_size},
+        segment_{segment} {}
   /** The schema for the index key */
   Schema key_schema_;
   /** The name of the index */
@@ -91,12 +93,18 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The segment that the pages of the index are in */
+  const segment_id_t segment_;
 };
 
 /**
  * The Catalog is a non-persistent catalog that is designed for
  * use by executors within the DBMS execution engine. It handles
  * table creation, table lookup, index creation, and index lookup.
+ *
+ * Every table and every index gets a segment of its own, so that its pages are in a file of their own, and dropping it
+ * unlinks the file. Once all segment ids are in use, new tables and indexes share the default segment, and their pages
+ * are not freed when they are dropped.
  */
 class Catalog {
  public:
@@ -136,7 +144,7 @@ class Catalog {
     // When create_table_heap == false, it means that we're running binder tests (where no txn will be provided) or
     // we are running shell without buffer pool. We don't need to create TableHeap in this case.
     if (create_table_heap) {
-      table = std::make_unique<TableHeap>(bpm_);
+      table = std::make_unique<TableHeap>(bpm_, CreateSegment());
     }
 
     // Fetch the table OID for the new table
@@ -226,21 +234,29 @@ class Catalog {
     // just the key, value, and comparator types
 
     // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    const segment_id_t segment = CreateSegment();
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_, segment);
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap, sorted and loaded bottom-up rather than inserted one by one
     auto *table_meta = GetTable(table_name);
-    for (auto iter = table_meta->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto iter = table_meta->table_->MakeIterator();
+    index->BulkLoad([&](Tuple *key, RID *rid) {
+      if (iter.IsEnd()) {
+        return false;
+      }
       auto [meta, tuple] = iter.GetTuple();
-      index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
-    }
+      *key = tuple.KeyFromTuple(schema, key_schema, key_attrs);
+      *rid = tuple.GetRid();
+      ++iter;
+      return true;
+    });
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
 
     // Construct index information; IndexInfo takes ownership of the Index itself
     auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize, segment);
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -250,6 +266,27 @@ class Catalog {
     return tmp;
   }
 
+  /**
+   * Create a new B+ tree index with the key type that fits the key schema, see VisitBPlusTreeIndexType(), populate
+   * existing data of the table and return its metadata.
+   * @param txn The transaction in which the table is being created
+   * @param index_name The name of the new index
+   * @param table_name The name of the table
+   * @param schema The schema of the table
+   * @param key_schema The schema of the key
+   * @param key_attrs Key attributes
+   * @return A (non-owning) pointer to the metadata of the new table
+   */
+  auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
+                   const Schema &key_schema, const std::vector<uint32_t> &key_attrs) -> IndexInfo * {
+    return VisitBPlusTreeIndexType(key_schema, [&](auto tag) {
+      using Tag = decltype(tag);
+      return CreateIndex<typename Tag::KeyType, typename Tag::ValueType, typename Tag::KeyComparator>(
+          txn, index_name, table_name, schema, key_schema, key_attrs, sizeof(typename Tag::KeyType),
+          HashFunction<typename Tag::KeyType>{});
+    });
+  }
+
   /**
    * Get the index `index_name` for table `table_name`.
    * @param index_name The name of the index for which to query
@@ -298,7 +335,7 @@ class Catalog {
    * @param index_oid The OID of the index for which to query
    * @return A (non-owning) pointer to the metadata for the index
    */
-  auto GetIndex(index_oid_t index_oid) -> IndexInfo * {
+  auto GetIndex(index_oid_t index_oid) const -> IndexInfo * {
     auto index = indexes_.find(index_oid);
     if (index == indexes_.end()) {
       return NULL_INDEX_INFO;
@@ -341,7 +378,90 @@ class Catalog {
     return result;
   }
 
+  /**
+   * Drop the index `index_name` of table `table_name`, and its segment.
+   * @return false if there is no such index
+   */
+  auto DropIndex(const std::string &index_name, const std::string &table_name) -> bool {
+    auto table = index_names_.find(table_name);
+    if (table == index_names_.end()) {
+      return false;
+    }
+    auto index_oid = table->second.find(index_name);
+    if (index_oid == table->second.end()) {
+      return false;
+    }
+    auto index = indexes_.find(index_oid->second);
+    BUSTUB_ASSERT((index != indexes_.end()), "Broken Invariant");
+    const segment_id_t segment = index->second->segment_;
+    indexes_.erase(index);
+    table->second.erase(index_oid);
+    DropSegment(segment);
+    return true;
+  }
+
+  /**
+   * Drop the table `table_name` with all its indexes, and their segments.
+   * @return false if there is no such table
+   */
+  auto DropTable(const std::string &table_name) -> bool {
+    auto table_oid = table_names_.find(table_name);
+    if (table_oid == table_names_.end()) {
+      return false;
+    }
+    for (auto *index : GetTableIndexes(table_name)) {
+      DropIndex(index->name_, table_name);
+    }
+    auto table = tables_.find(table_oid->second);
+    BUSTUB_ASSERT((table != tables_.end()), "Broken Invariant");
+    const segment_id_t segment =
+        table->second->table_ == nullptr ? DEFAULT_SEGMENT_ID : table->second->table_->GetSegment();
+    tables_.erase(table);
+    table_names_.erase(table_oid);
+    index_names_.erase(table_name);
+    DropSegment(segment);
+    return true;
+  }
+
  private:
+  /** @return a new segment for a table or an index, or the default segment once there are no segment ids left */
+  auto CreateSegment() -> segment_id_t {
+    // A dropped segment is reused only once none of its pages are left in the buffer pool.
+    for (auto it = dropped_segments_.begin(); it != dropped_segments_.end();) {
+      if (bpm_->DiscardSegment(*it)) {
+        free_segments_.push_back(*it);
+        it = dropped_segments_.erase(it);
+      } else {
+        it++;
+      }
+    }
+    segment_id_t segment = DEFAULT_SEGMENT_ID;
+    if (!free_segments_.empty()) {
+      segment = free_segments_.back();
+      free_segments_.pop_back();
+    } else if (next_segment_id_ <= MAX_SEGMENT_ID) {
+      segment = next_segment_id_++;
+    }
+    if (segment != DEFAULT_SEGMENT_ID) {
+      bpm_->CreateSegment(segment);
+    }
+    return segment;
+  }
+
+  /**
+   * @brief Drop the segment of a dropped table or index, so that its id can be reused: at once, or once the pages of it
+   * that are still pinned are discarded.
+   */
+  void DropSegment(segment_id_t segment) {
+    if (segment != DEFAULT_SEGMENT_ID) {
+      if (bpm_->DropSegment(segment)) {
+        free_segments_.push_back(segment);
+      } else {
+        dropped_segments_.push_back(segment);
+      }
+    }
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
@@ -371,6 +491,15 @@ class Catalog {
 
   /** The next index identifier to be used. */
   std::atomic<index_oid_t> next_index_oid_{0};
+
+  /** The next segment id that was never used. */
+  segment_id_t next_segment_id_{DEFAULT_SEGMENT_ID + 1};
+
+  /** Segments of dropped tables and indexes, to be reused. */
+  std::vector<segment_id_t> free_segments_;
+
+  /** Segments of dropped tables and indexes with pages still pinned in the buffer pool, not to be reused yet. */
+  std::vector<segment_id_t> dropped_segments_;
 };
 
 }  // namespace bustub
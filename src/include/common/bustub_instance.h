@@ -43,6 +43,7 @@ class Catalog;
 class ExecutionEngine;
 
 class CreateStatement;
+class DropStatement;
 class IndexStatement;
 class VariableSetStatement;
 class VariableShowStatement;
@@ -210,6 +211,14 @@ class FortTableWriter : public ResultWriter {
   std::vector<std::string> tables_;
 };
 
+/** The disk manager that a BustubInstance with a database file stores its pages with. */
+enum class DiskManagerKind {
+  /** pread and pwrite on the file, see DiskManager. */
+  Pread,
+  /** The file mapped into memory, see DiskManagerMmap. Saves a system call per read on read-mostly replicas. */
+  Mmap,
+};
+
 class BustubInstance {
  private:
   /**
@@ -217,11 +226,24 @@ class BustubInstance {
    */
   auto MakeExecutorContext(Transaction *txn, bool is_modify) -> std::unique_ptr<ExecutorContext>;
 
+  /**
+   * Create the buffer pool on disk_manager_ and log_manager_: a ParallelBufferPoolManager with the frames split over
+   * `buffer_pool_instances` instances when that is more than 1, a single BufferPoolManager otherwise. nullptr if the
+   * buffer pool is not implemented.
+   */
+  auto MakeBufferPoolManager() -> BufferPoolManager *;
+
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  explicit BustubInstance(const std::string &db_file_name, DiskManagerKind disk_manager_kind = DiskManagerKind::Pread);
 
   BustubInstance();
 
+  /**
+   * Creates an instance on the given disk manager, without a database file, e.g. on a DiskManagerSimulated for
+   * benchmarks. The instance owns the disk manager.
+   */
+  explicit BustubInstance(std::unique_ptr<DiskManager> disk_manager);
+
   ~BustubInstance();
 
   /**
@@ -283,6 +305,7 @@ class BustubInstance {
 
   void HandleCreateStatement(Transaction *txn, const CreateStatement &stmt, ResultWriter &writer);
   void HandleIndexStatement(Transaction *txn, const IndexStatement &stmt, ResultWriter &writer);
+  void HandleDropStatement(Transaction *txn, const DropStatement &stmt, ResultWriter &writer);
   void HandleExplainStatement(Transaction *txn, const ExplainStatement &stmt, ResultWriter &writer);
   void HandleVariableShowStatement(Transaction *txn, const VariableShowStatement &stmt, ResultWriter &writer);
   void HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt, ResultWriter &writer);
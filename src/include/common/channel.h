@@ -51,6 +51,22 @@ class Channel {
     return element;
   }
 
+  /**
+   * @brief Gets an element from the shared queue if there is one, without blocking.
+   *
+   * @param[out] element the element taken from the queue
+   * @return false if the queue was empty
+   */
+  auto TryGet(T *element) -> bool {
+    std::lock_guard<std::mutex> lk(m_);
+    if (q_.empty()) {
+      return false;
+    }
+    *element = std::move(q_.front());
+    q_.pop();
+    return true;
+  }
+
  private:
   std::mutex m_;
   std::condition_variable cv_;
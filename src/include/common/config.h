@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -27,6 +28,33 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** True if buffer pools ask for transparent huge pages to back their frames. Read when a buffer pool is created. */
+extern std::atomic<bool> buffer_pool_huge_pages;
+
+/** True if BustubInstance opens its database file with O_DIRECT, bypassing the OS page cache. */
+extern std::atomic<bool> enable_direct_io;
+
+/** Number of pages that sequential table and index scans keep in flight ahead of them. 0 disables read-ahead. */
+extern std::atomic<size_t> read_ahead_window;
+
+/** Number of threads that FlushAllPages() spreads its writes over. */
+extern std::atomic<size_t> checkpoint_writers;
+
+/**
+ * Number of requests the disk scheduler of a buffer pool keeps in flight. 1 keeps a single worker thread; more submits
+ * through io_uring, or to as many pread/pwrite worker threads where io_uring is not available. Read when a buffer pool
+ * is created, so it is set before the BustubInstance, e.g. by the --disk-io-depth flag of the shell and of
+ * bustub-sqllogictest.
+ */
+extern std::atomic<size_t> disk_io_depth;
+
+/**
+ * Number of instances a BustubInstance splits its buffer pool into, see ParallelBufferPoolManager. 1 keeps a single
+ * BufferPoolManager. Read when the BustubInstance is created, e.g. from the --buffer-pool-instances flag of the shell
+ * and of bustub-sqllogictest.
+ */
+extern std::atomic<size_t> buffer_pool_instances;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
@@ -43,6 +71,42 @@ using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
+using segment_id_t = int32_t;  // segment id type
+
+/**
+ * Page ids are split into segments. Each segment but the default one has a file of its own, so that a table or an
+ * index can live, and be dropped, apart from the rest of the database. The default segment, the database file, keeps
+ * the lower half of the page ids: 2^30 pages, 4 TB. The upper half holds segments 1 to MAX_SEGMENT_ID, of SEGMENT_PAGES
+ * pages, 16 GB, each. A table or an index in a segment of its own is therefore limited to 16 GB; once the segment ids
+ * are used up, the catalog puts new ones in the default segment.
+ */
+static constexpr int SEGMENT_PAGE_BITS = 22;                                    // page number bits of a segment
+static constexpr page_id_t SEGMENT_PAGES = 1 << SEGMENT_PAGE_BITS;              // pages in a segment
+static constexpr page_id_t DEFAULT_SEGMENT_PAGES = 1 << 30;                     // pages in the default segment
+static constexpr segment_id_t DEFAULT_SEGMENT_ID = 0;                           // segment of the database file
+static constexpr segment_id_t MAX_SEGMENT_ID = 1 << (30 - SEGMENT_PAGE_BITS);  // highest segment id
+
+/** @return the segment that a page belongs to */
+constexpr auto SegmentOf(page_id_t page_id) -> segment_id_t {
+  return page_id < DEFAULT_SEGMENT_PAGES ? DEFAULT_SEGMENT_ID
+                                         : ((page_id - DEFAULT_SEGMENT_PAGES) >> SEGMENT_PAGE_BITS) + 1;
+}
+
+/** @return the number of pages that a segment can hold */
+constexpr auto SegmentPages(segment_id_t segment) -> page_id_t {
+  return segment == DEFAULT_SEGMENT_ID ? DEFAULT_SEGMENT_PAGES : SEGMENT_PAGES;
+}
+
+/** @return the number of a page within its segment */
+constexpr auto SegmentPageNumber(page_id_t page_id) -> page_id_t {
+  return page_id < DEFAULT_SEGMENT_PAGES ? page_id : (page_id - DEFAULT_SEGMENT_PAGES) & (SEGMENT_PAGES - 1);
+}
+
+/** @return the id of page `page_number` of `segment` */
+constexpr auto MakeSegmentPageId(segment_id_t segment, page_id_t page_number) -> page_id_t {
+  return segment == DEFAULT_SEGMENT_ID ? page_number
+                                       : DEFAULT_SEGMENT_PAGES + ((segment - 1) << SEGMENT_PAGE_BITS) + page_number;
+}
 
 static constexpr int VARCHAR_DEFAULT_LENGTH = 128;  // default length for varchar when constructing the column
 
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <functional>
 #include <vector>
 
 #include "common/rid.h"
@@ -44,8 +45,14 @@ class IndexScanExecutor : public AbstractExecutor {
  private:
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
-  BPlusTreeIndexForTwoIntegerColumn *b_tree_index_;
-  IndexIterator<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>> iter_{nullptr, -1, -1};
+  /**
+   * Replaces its argument with the RIDs of the next leaf of the key range, in key order, or returns false at the end
+   * of the range; set by Init() for the type of the index.
+   */
+  std::function<bool(std::vector<RID> *)> next_batch_;
+  /** The RIDs of the leaf being read, and the next one to return. */
+  std::vector<RID> batch_;
+  size_t batch_pos_{0};
   TableInfo *tableinfo_;
 };
 }  // namespace bustub
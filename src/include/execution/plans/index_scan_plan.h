@@ -12,12 +12,14 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <utility>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "type/value.h"
 
 namespace bustub {
 /**
@@ -28,10 +30,23 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /**
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
-   * @param table_oid the identifier of table to be scanned
+   * @param index_oid the identifier of the index to be scanned
+   * @param filter_predicate the predicate that the tuples scanned must satisfy, or nullptr for none
+   * @param lower_bound the key to scan from, or std::nullopt to scan from the first key of the index
+   * @param lower_inclusive whether the key `lower_bound` itself is scanned
+   * @param upper_bound the key to scan to, or std::nullopt to scan to the last key of the index
+   * @param upper_inclusive whether the key `upper_bound` itself is scanned
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, AbstractExpressionRef filter_predicate = nullptr,
+                    std::optional<Value> lower_bound = std::nullopt, bool lower_inclusive = true,
+                    std::optional<Value> upper_bound = std::nullopt, bool upper_inclusive = true)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        filter_predicate_(std::move(filter_predicate)),
+        lower_bound_(std::move(lower_bound)),
+        lower_inclusive_(lower_inclusive),
+        upper_bound_(std::move(upper_bound)),
+        upper_inclusive_(upper_inclusive) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
@@ -43,11 +58,30 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /** The predicate that the tuples scanned must satisfy, checked on each one the key range leaves; may be nullptr. */
+  AbstractExpressionRef filter_predicate_;
+
+  /**
+   * The range of keys to scan, on an index of one column: the entries of each leaf in range are read at once, and the
+   * scan stops at the first key past the upper bound.
+   */
+  std::optional<Value> lower_bound_;
+  bool lower_inclusive_;
+  std::optional<Value> upper_bound_;
+  bool upper_inclusive_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    std::string range;
+    if (lower_bound_.has_value() || upper_bound_.has_value()) {
+      range = fmt::format(", range={}{}, {}{}", lower_inclusive_ ? "[" : "(",
+                          lower_bound_.has_value() ? lower_bound_->ToString() : "-inf",
+                          upper_bound_.has_value() ? upper_bound_->ToString() : "+inf", upper_inclusive_ ? "]" : ")");
+    }
+    if (filter_predicate_) {
+      return fmt::format("IndexScan {{ index_oid={}{}, filter={} }}", index_oid_, range, filter_predicate_);
+    }
+    return fmt::format("IndexScan {{ index_oid={}{} }}", index_oid_, range);
   }
 };
 
@@ -83,6 +83,12 @@ class Optimizer {
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief optimize a filter on a seq scan as a scan of a range of an index, if the filter bounds the column of an
+   * index on one integer column, e.g. `WHERE v BETWEEN 1 AND 5` or `WHERE v > 3`
+   */
+  auto OptimizeRangeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /** @brief check if the index can be matched */
   auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
       -> std::optional<std::tuple<index_oid_t, std::string>>;
@@ -12,35 +12,61 @@
 
 #pragma once
 
+#include <sys/types.h>
 #include <atomic>
+#include <condition_variable>  // NOLINT
 #include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "common/config.h"
 
 namespace bustub {
 
+/** How pages of the database file are about to be read, see DiskManager::AdvisePages(). */
+enum class DiskAccessHint {
+  /** No particular pattern. */
+  Normal,
+  /** In page id order, e.g. by a scan: read far ahead, and drop the pages from the cache soon after. */
+  Sequential,
+  /** Soon, e.g. by a prefetch: start reading them in now. */
+  WillNeed,
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are accessed with pread/pwrite on a single file descriptor. There is no shared file offset and no latch around
+ * page I/O, so concurrent reads and writes, from the disk scheduler or from several buffer pools, reach the device in
+ * parallel. ShutDown() must not race with page I/O.
+ *
+ * The pages of the default segment are in the database file. Every other segment that was created has a file of its
+ * own, where its pages are numbered from 0, see SegmentOf(). I/O on the pages of such a segment shares a latch with
+ * CreateSegment() and DropSegment() only.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io true to open the database file with O_DIRECT, so that pages are not cached by the OS a second
+   * time. Falls back to the page cache if the file system does not support O_DIRECT. The log file is not affected.
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
-   * Shut down the disk manager and close all the file resources.
+   * Shut down the disk manager and close all the file resources. The segment files are removed, like the destructor
+   * does: CreateSegment() empties them anyway, so nothing in them outlives the disk manager.
    */
   void ShutDown();
 
@@ -58,6 +84,69 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Write a run of pages with consecutive ids to the database file, with a single vectored write where possible.
+   * @param page_id id of the first page of the run
+   * @param pages raw data of the pages, for page_id, page_id + 1, ...
+   */
+  virtual void WritePages(page_id_t page_id, const std::vector<const char *> &pages);
+
+  /**
+   * Write a page of the free-page map. The map is kept apart from the pages themselves, in `<db>.fsm` next to the
+   * database file, or in memory if there is no database file. Either way it starts out empty with a new database.
+   * @param index index of the map page
+   * @param data raw page data
+   */
+  virtual void WriteFreeMapPage(size_t index, const char *data);
+
+  /**
+   * Read a page of the free-page map.
+   * @param index index of the map page
+   * @param[out] data output buffer
+   * @return false if the page was never written, in which case `data` is left untouched
+   */
+  virtual auto ReadFreeMapPage(size_t index, char *data) -> bool;
+
+  /**
+   * Make the pages and free-page map pages written so far durable with fdatasync. Concurrent calls are batched: a
+   * call that finds a sync in progress waits for it, and one more sync then covers all the calls that waited, so any
+   * number of concurrent callers costs at most two syncs.
+   */
+  virtual void SyncPages();
+
+  /**
+   * Tell the OS how a range of pages is about to be read, so that it can read ahead. A hint only: it never changes
+   * what is read, and does nothing without a database file or with O_DIRECT.
+   * @param page_id id of the first page of the range
+   * @param num_pages number of pages in the range
+   */
+  virtual void AdvisePages(page_id_t page_id, size_t num_pages, DiskAccessHint hint);
+
+  /**
+   * Create the file of a segment, `<database file>.<segment>`, in `directory` if given, e.g. to put a hot index on a
+   * faster volume, or next to the database file otherwise. An existing file of the segment is emptied. Does nothing
+   * without a database file. Pages of a segment that has no file read as zeroes, and writes to them are dropped. The
+   * file is removed by ShutDown() or when the disk manager is destroyed.
+   * @throw Exception if the segment id is out of range, or the file can't be created
+   */
+  virtual void CreateSegment(segment_id_t segment, const std::string &directory = "");
+
+  /**
+   * Close and unlink the file of a segment, which frees its space at once. Nothing may be reading or writing its pages.
+   * @throw Exception for the default segment
+   */
+  virtual void DropSegment(segment_id_t segment);
+
+  /** @return the path of the file of a segment, or an empty string if it has none */
+  auto GetSegmentFileName(segment_id_t segment) -> std::string;
+
+  /**
+   * @return the descriptor of the file that holds a page, and the offset of the page in it through `offset`, for
+   * schedulers that issue page I/O themselves, or -1 if there is no such file. The segment of the page must not be
+   * dropped while the descriptor is in use.
+   */
+  virtual auto GetPageFile(page_id_t page_id, off_t *offset) -> int;
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -74,6 +163,15 @@ class DiskManager {
    */
   auto ReadLog(char *log_data, int size, int offset) -> bool;
 
+  /**
+   * @return the descriptor of the database file, for schedulers that issue page reads and writes on it themselves, or
+   * -1 if pages must go through ReadPage() and WritePage(). Writes issued that way are not counted by GetNumWrites().
+   */
+  virtual auto GetFileDescriptor() const -> int { return db_fd_; }
+
+  /** @return true if the database file is open with O_DIRECT */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
 
@@ -83,6 +181,9 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of fdatasync calls made by SyncPages(), one per file synced */
+  auto GetNumSyncs() const -> int { return num_syncs_.load(); }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -94,18 +195,49 @@ class DiskManager {
 
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
+
+  /**
+   * @return the descriptor of the file that holds a page and its offset, or -1. Caller should hold segment_latch_ for
+   * a page outside of the default segment, see LockSegmentOf().
+   */
+  auto LocatePage(page_id_t page_id, off_t *offset) -> int;
+
+  /** @return a shared lock on segment_latch_ if the page is outside of the default segment, else an empty one */
+  auto LockSegmentOf(page_id_t page_id) -> std::shared_lock<std::shared_mutex>;
+
+  /** Close and unlink the file of every segment. Caller holds segment_latch_ exclusively, or is the destructor. */
+  void RemoveSegmentFiles();
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the db file
+  int db_fd_{-1};
+  bool direct_io_{false};
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+  // group commit of SyncPages(): syncs_started_ counts the syncs issued, syncs_done_ those completed
+  std::mutex sync_latch_;
+  std::condition_variable sync_cv_;
+  bool syncing_{false};
+  uint64_t syncs_started_{0};
+  uint64_t syncs_done_{0};
+  std::atomic<int> num_syncs_{0};
+  // file descriptor of the free-page map file, -1 if the map is kept in free_map_pages_
+  int fsm_fd_{-1};
+  std::unordered_map<size_t, std::vector<char>> free_map_pages_;
+  std::mutex free_map_latch_;
+  // file of every segment that has one, but the default one, with its path
+  struct SegmentFile {
+    int fd_;
+    std::string file_name_;
+  };
+  std::unordered_map<segment_id_t, SegmentFile> segments_;
+  // shared by the I/O on pages of segments_, exclusive to open and close their files
+  std::shared_mutex segment_latch_;
 };
 
 }  // namespace bustub
@@ -9,6 +9,9 @@
 // Copyright (c) 2015-2020, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+
+#pragma once
+
 #include <array>
 #include <cstring>
 #include <fstream>
@@ -19,6 +22,7 @@
 #include <shared_mutex>
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -76,13 +80,15 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     }
 
     std::unique_lock<std::mutex> l(mutex_);
-    if (page_id >= static_cast<int>(data_.size())) {
-      data_.resize(page_id + 1);
+    auto &data = data_[SegmentOf(page_id)];
+    const page_id_t page_number = SegmentPageNumber(page_id);
+    if (page_number >= static_cast<int>(data.size())) {
+      data.resize(page_number + 1);
     }
-    if (data_[page_id] == nullptr) {
-      data_[page_id] = std::make_shared<ProtectedPage>();
+    if (data[page_number] == nullptr) {
+      data[page_number] = std::make_shared<ProtectedPage>();
     }
-    std::shared_ptr<ProtectedPage> ptr = data_[page_id];
+    std::shared_ptr<ProtectedPage> ptr = data[page_number];
     std::unique_lock<std::shared_mutex> l_page(ptr->second);
     l.unlock();
 
@@ -100,28 +106,38 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     }
 
     std::unique_lock<std::mutex> l(mutex_);
-    if (page_id >= static_cast<int>(data_.size()) || page_id < 0) {
+    auto segment = data_.find(SegmentOf(page_id));
+    const page_id_t page_number = SegmentPageNumber(page_id);
+    if (segment == data_.end() || page_number >= static_cast<int>(segment->second.size()) || page_id < 0) {
       // LOG_WARN("page not exist");
       return;
     }
-    if (data_[page_id] == nullptr) {
+    if (segment->second[page_number] == nullptr) {
       // LOG_WARN("page not exist");
       return;
     }
-    std::shared_ptr<ProtectedPage> ptr = data_[page_id];
+    std::shared_ptr<ProtectedPage> ptr = segment->second[page_number];
     std::shared_lock<std::shared_mutex> l_page(ptr->second);
     l.unlock();
 
     memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
   }
 
+  /** Free the pages of a segment. */
+  void DropSegment(segment_id_t segment) override {
+    DiskManager::DropSegment(segment);
+    std::unique_lock<std::mutex> l(mutex_);
+    data_.erase(segment);
+  }
+
   void SetLatency(size_t latency_ms) { latency_ = latency_ms; }
 
  private:
   std::mutex mutex_;
   using Page = std::array<char, BUSTUB_PAGE_SIZE>;
   using ProtectedPage = std::pair<Page, std::shared_mutex>;
-  std::vector<std::shared_ptr<ProtectedPage>> data_;
+  /** The pages of every segment, indexed by page number. */
+  std::unordered_map<segment_id_t, std::vector<std::shared_ptr<ProtectedPage>>> data_;
   size_t latency_{0};
 };
 
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMmap maps the database file into memory, for read-mostly deployments: a page is read with a memcpy out
+ * of the OS page cache instead of a pread system call, and AdvisePages() becomes madvise on the mapping.
+ *
+ * The file is mapped in extents of EXTENT_PAGES pages, each its own mapping, so that growing the file never moves
+ * the pages mapped so far and readers need no latch. Opening a database maps the file as it is, without changing its
+ * size. The file is extended to the end of an extent when a page past its end is first written; the pages in between
+ * read as zeroes and take no disk space until written.
+ *
+ * Only the default segment is mapped: the files of the other segments are read and written as by DiskManager. The log
+ * and the free-page map are kept as by DiskManager too, and so are the durability rules: a page written is only
+ * durable after SyncPages(), whose fdatasync also writes back the pages dirtied through the mapping. Pages are never
+ * handed to a scheduler as a file descriptor, so every page goes through the mapping.
+ */
+class DiskManagerMmap : public DiskManager {
+ public:
+  /** Pages per extent: 64 MB. */
+  static constexpr size_t EXTENT_PAGES = 16384;
+  /** Most extents a file can have: 256 GB. */
+  static constexpr size_t MAX_EXTENTS = 4096;
+
+  /**
+   * Creates a new disk manager that maps the specified database file. O_DIRECT does not apply to a mapping.
+   * @param db_file the file name of the database file to write to
+   */
+  explicit DiskManagerMmap(const std::string &db_file);
+
+  ~DiskManagerMmap() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void WritePages(page_id_t page_id, const std::vector<const char *> &pages) override;
+
+  /** @brief madvise the mapped part of the range: MADV_SEQUENTIAL, MADV_WILLNEED or MADV_NORMAL. */
+  void AdvisePages(page_id_t page_id, size_t num_pages, DiskAccessHint hint) override;
+
+  /** @return -1: pages must go through the mapping */
+  auto GetFileDescriptor() const -> int override { return -1; }
+
+  /** @return the number of pages of the file that are mapped */
+  auto GetMappedPages() const -> size_t { return num_extents_.load() * EXTENT_PAGES; }
+
+ private:
+  /** @return the mapped page, or nullptr if it is past the end of the file */
+  auto MappedPage(page_id_t page_id) -> char *;
+
+  /** @brief Extend the file and the mapping up to the end of the extent of page_id, unless the file holds it. */
+  void ExtendFileTo(page_id_t page_id);
+
+  /** @brief Map the extents up to the one of page_id. Caller should hold grow_latch_. */
+  void MapExtentsUpTo(page_id_t page_id);
+
+  /** Extents mapped so far, each at EXTENT_PAGES * BUSTUB_PAGE_SIZE times its index in the file. */
+  std::array<std::atomic<char *>, MAX_EXTENTS> extents_{};
+  /** Extents [0, num_extents_) are mapped. */
+  std::atomic<size_t> num_extents_{0};
+  /** Pages [0, file_pages_) are in the file, and mapped: they can be touched. */
+  std::atomic<size_t> file_pages_{0};
+  /** Serializes the growth of the file and of the mapping. */
+  std::mutex grow_latch_;
+};
+
+}  // namespace bustub
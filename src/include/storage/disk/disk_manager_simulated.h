@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_simulated.h
+//
+// Identification: src/include/storage/disk/disk_manager_simulated.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** Performance characteristics of a storage device, see DiskManagerSimulated. */
+struct DeviceProfile {
+  /** Service time of a read or write of a page that does not follow the page accessed last, e.g. with a seek. */
+  std::chrono::microseconds random_read_latency_{0};
+  std::chrono::microseconds random_write_latency_{0};
+  /** Service time of a read or write of the page right after the page accessed last. */
+  std::chrono::microseconds sequential_read_latency_{0};
+  std::chrono::microseconds sequential_write_latency_{0};
+  /** Requests the device serves at the same time, e.g. the flash channels of an SSD. A disk has one. */
+  size_t channels_{1};
+  /** Transfer rate of the bus that all channels share, in MB/s. 0 for no limit. */
+  double bandwidth_mb_per_sec_{0};
+
+  /**
+   * @brief Parse a profile of the form `preset[,key=value]...`. The presets are nvme, ssd, hdd and none; the keys
+   * override one field of the preset: read_us, write_us, seq_read_us, seq_write_us, channels and bandwidth_mb. The
+   * sequential latencies default to the random ones, except for hdd. E.g. `ssd,channels=2` or `none,read_us=100`.
+   * @throw Exception if the preset or a key is unknown, or a value is not a number
+   */
+  static auto Parse(const std::string &spec) -> DeviceProfile;
+
+  /** @return the profile in the form that Parse() accepts, with every key */
+  auto ToString() const -> std::string;
+};
+
+/**
+ * DiskManagerSimulated keeps its pages in memory like DiskManagerUnlimitedMemory, and makes every read and write take
+ * as long as it would on the device of a DeviceProfile, for benchmarks that should see storage latency without the
+ * hardware.
+ *
+ * A request goes to the channel that frees up first, waits there for the requests before it, and holds the channel
+ * for its service time: random or sequential, depending on whether its page follows the page of the request before
+ * it. The page then crosses the shared bus at the profile's bandwidth. The calling thread sleeps until the simulated
+ * completion, so more threads, or a deeper disk scheduler, see more of the device's parallelism and more queueing.
+ */
+class DiskManagerSimulated : public DiskManagerUnlimitedMemory {
+ public:
+  explicit DiskManagerSimulated(const DeviceProfile &profile);
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  auto GetProfile() const -> const DeviceProfile & { return profile_; }
+
+  /** @return the number of requests whose page followed the page of the request before them */
+  auto GetNumSequential() const -> uint64_t { return num_sequential_.load(); }
+
+  /** @return the time that requests spent waiting for a channel or for the bus, summed over all requests */
+  auto GetQueueingTime() const -> std::chrono::nanoseconds { return std::chrono::nanoseconds(queueing_ns_.load()); }
+
+ private:
+  /** @brief Wait until the device would have completed a read or write of page_id issued now. */
+  void Access(page_id_t page_id, bool is_write);
+
+  DeviceProfile profile_;
+  /** Time that one page takes on the bus. */
+  std::chrono::nanoseconds transfer_time_{0};
+
+  /** Protects the state of the device below. */
+  std::mutex device_latch_;
+  /** When each channel is done with the requests given to it so far. */
+  std::vector<std::chrono::steady_clock::time_point> channel_free_at_;
+  std::chrono::steady_clock::time_point bus_free_at_;
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+
+  std::atomic<uint64_t> num_sequential_{0};
+  std::atomic<uint64_t> queueing_ns_{0};
+};
+
+}  // namespace bustub
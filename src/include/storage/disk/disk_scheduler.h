@@ -12,15 +12,45 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <future>  // NOLINT
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <optional>
+#include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "common/channel.h"
+#include "common/config.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/io_uring.h"
 
 namespace bustub {
 
+/** Which queue of the DiskScheduler a request waits in. Lower values are served first. */
+enum class DiskRequestPriority : uint8_t {
+  /** A request that a query is blocked on. */
+  Foreground = 0,
+  /** A read that nobody waits for yet. */
+  Prefetch,
+  /** A write-back that nobody waits for, e.g. by the background flusher. */
+  Background,
+};
+
+/** Number of DiskRequestPriority values. */
+static constexpr size_t NUM_DISK_REQUEST_PRIORITIES = 3;
+
 /**
  * @brief Represents a Write or Read request for the DiskManager to execute.
  */
@@ -40,6 +70,83 @@ struct DiskRequest {
 
   /** Callback used to signal to the request issuer when the request has been completed. */
   std::promise<bool> callback_;
+
+  /**
+   * Optional hook run on the worker thread after `callback_` has been set, for issuers that do not wait for the
+   * request, e.g. prefetches.
+   */
+  std::function<void(bool)> on_complete_{};
+
+  /** Queue the request waits in until it is issued. */
+  DiskRequestPriority priority_{DiskRequestPriority::Foreground};
+};
+
+/** How a DiskScheduler issues its requests. */
+enum class DiskSchedulerBackend {
+  /** One worker thread, one request at a time. */
+  Serial,
+  /** Batches of requests submitted through io_uring, many of them in flight. */
+  IoUring,
+  /** A pool of worker threads, each doing one request at a time through the disk manager. */
+  ThreadPool,
+};
+
+/** @return the name of a backend, for reports */
+auto DiskSchedulerBackendName(DiskSchedulerBackend backend) -> std::string;
+
+/** Settings of a DiskScheduler. */
+struct DiskSchedulerOptions {
+  DiskSchedulerBackend backend_{DiskSchedulerBackend::Serial};
+  /** Most requests in flight at once with io_uring, and the number of workers of the thread pool. */
+  size_t queue_depth_{32};
+  /**
+   * Longest a queued request is passed over by requests of higher priority. Past it, its queue is served every other
+   * request, so that a steady stream of foreground reads cannot starve write-backs.
+   */
+  std::chrono::microseconds max_queue_wait_{5000};
+
+  /** @return the options for `queue_depth` requests in flight: Serial for 1, io_uring for more */
+  static auto FromQueueDepth(size_t queue_depth) -> DiskSchedulerOptions {
+    if (queue_depth <= 1) {
+      return {DiskSchedulerBackend::Serial, 1};
+    }
+    return {DiskSchedulerBackend::IoUring, queue_depth};
+  }
+};
+
+/** Counters of one request queue of a DiskScheduler. */
+struct DiskQueueStats {
+  /** Requests scheduled into the queue. */
+  uint64_t scheduled_{0};
+  /** Writes that were merged into a queued write of the same page instead of being queued. */
+  uint64_t merged_{0};
+  /** Requests taken out of the queue to be issued. */
+  uint64_t dequeued_{0};
+  /** Requests in the queue right now. */
+  size_t depth_{0};
+  size_t max_depth_{0};
+  /** Time that the dequeued requests spent in the queue. */
+  std::chrono::nanoseconds total_wait_{0};
+  std::chrono::nanoseconds max_wait_{0};
+
+  /** @return the average time that a request spent in the queue, 0 if none was dequeued */
+  auto AverageWait() const -> std::chrono::nanoseconds {
+    return dequeued_ == 0 ? std::chrono::nanoseconds(0) : total_wait_ / static_cast<int64_t>(dequeued_);
+  }
+};
+
+/** A snapshot of the counters of a DiskScheduler, see DiskScheduler::GetStats(). */
+struct DiskSchedulerStats {
+  /** One entry per queue, indexed by DiskRequestPriority. */
+  std::array<DiskQueueStats, NUM_DISK_REQUEST_PRIORITIES> queues_{};
+  /** Requests served ahead of higher priority ones because they had waited for longer than max_queue_wait_. */
+  uint64_t starved_{0};
+  /** Requests served ahead of their priority because a more urgent request for the same page was queued behind. */
+  uint64_t promoted_{0};
+  /** Requests moved to the foreground queue by Expedite(). */
+  uint64_t expedited_{0};
+  /** Requests issued and not completed yet. */
+  size_t in_flight_{0};
 };
 
 /**
@@ -48,12 +155,31 @@ struct DiskRequest {
  * A request is scheduled by calling DiskScheduler::Schedule() with an appropriate DiskRequest object. The scheduler
  * maintains a background worker thread that processes the scheduled requests using the disk manager. The background
  * thread is created in the DiskScheduler constructor and joined in its destructor.
+ *
+ * With the io_uring and thread pool backends, the background thread is a dispatcher that keeps up to `queue_depth_`
+ * requests in flight, and completes them out of order. Requests for the same page still run in the order they were
+ * scheduled: one waits for the request before it to complete. io_uring needs the file descriptor of the disk manager;
+ * without it, or if the kernel refuses io_uring or lacks its read and write operations, the thread pool is used instead.
+ * The thread pool also takes over if a system call on the ring fails later on.
+ *
+ * Scheduled requests wait in one queue per DiskRequestPriority, and the next request to issue is taken from the most
+ * urgent non-empty queue, unless the head of a less urgent one has waited for longer than max_queue_wait_. A request
+ * never overtakes an earlier request for the same page: if the one picked has such a predecessor, the predecessor is
+ * issued first. A write scheduled right behind a queued write of the same page is merged into it: the queued write
+ * takes the newer data, and completes both requests.
  */
 class DiskScheduler {
  public:
-  explicit DiskScheduler(DiskManager *disk_manager);
+  explicit DiskScheduler(DiskManager *disk_manager,
+                         const DiskSchedulerOptions &options = DiskSchedulerOptions::FromQueueDepth(disk_io_depth));
   ~DiskScheduler();
 
+  /** @return the backend in use, which is the thread pool if io_uring was asked for but is not available */
+  auto GetBackend() const -> DiskSchedulerBackend { return backend_; }
+
+  /** @return a snapshot of the queue counters */
+  auto GetStats() -> DiskSchedulerStats;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -63,6 +189,12 @@ class DiskScheduler {
    */
   void Schedule(DiskRequest r);
 
+  /**
+   * @brief Move the queued requests for a page to the foreground queue, e.g. a prefetch that a query now waits for.
+   * Requests already issued are left alone.
+   */
+  void Expedite(page_id_t page_id);
+
   /**
    * TODO(P1): Add implementation
    *
@@ -84,12 +216,104 @@ class DiskScheduler {
   auto CreatePromise() -> DiskSchedulerPromise { return {}; };
 
  private:
+  /** A scheduled request waiting in its queue. */
+  struct QueuedRequest {
+    DiskRequest request_;
+    std::chrono::steady_clock::time_point enqueued_;
+  };
+  using RequestQueue = std::list<QueuedRequest>;
+
+  /**
+   * @brief Take the next request to issue out of the queues.
+   * @param wait whether to wait for a request when the queues are empty
+   * @return the request, or std::nullopt if there is none and either wait is false or the scheduler is shutting down
+   */
+  auto NextRequest(bool wait) -> std::optional<DiskRequest>;
+
+  /** @brief Wait until fewer than queue_depth_ requests are in flight. */
+  void WaitForSlot();
+
+  /** @brief Run requests one at a time, in the background thread. */
+  void RunSerial();
+
+  /** @brief Dispatch requests to io_uring or the worker threads, in the background thread. */
+  void RunDispatcher();
+
+  /** @brief Wait until `request` may be issued: no request for its page is in flight. Then take a slot for it. */
+  void Admit(const DiskRequest &request);
+
+  /** @brief Issue an admitted request. With io_uring it is only queued, until the next Submit(). */
+  void Issue(std::unique_ptr<DiskRequest> request);
+
+  /**
+   * @brief Send the requests queued in the ring to the kernel. If it fails, the ring is given up on: the requests the
+   * kernel did not take, and every one issued after them, go to the thread pool.
+   */
+  void SubmitRing();
+
+  /** @return true if `request` was in the ring, which it is taken out of: its completion is up to the caller */
+  auto TakeFromRing(DiskRequest *request) -> bool;
+
+  /** @brief Start the workers of the thread pool, unless they are running. */
+  void StartThreadPool();
+
+  /** @brief Run a request through the disk manager, in the calling thread, and complete it. */
+  void RunOnDiskManager(std::unique_ptr<DiskRequest> request);
+
+  /** @brief Fulfill the promise of an issued request, and free its slot. */
+  void Complete(std::unique_ptr<DiskRequest> request, bool ok);
+
+  /**
+   * @brief Reap io_uring completions until the dispatcher's wake-up entry comes back. If waiting for them fails, the
+   * ring is given up on, and the requests in it go to the thread pool: each page stays pinned or claimed for the whole
+   * request, so reading or writing it again is safe.
+   */
+  void RunCompleter();
+
+  /** @brief Take requests from work_queue_ and run them through the disk manager, until a nullptr. */
+  void RunWorker();
+
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
-  /** A shared queue to concurrently schedule and process requests. When the DiskScheduler's destructor is called,
-   * `std::nullopt` is put into the queue to signal to the background thread to stop execution. */
-  Channel<std::optional<DiskRequest>> request_queue_;
+  DiskSchedulerBackend backend_;
+  size_t queue_depth_;
+  std::chrono::microseconds max_queue_wait_;
+
+  /** Protects the request queues, queued_pages_, stats_ and stopping_. */
+  std::mutex queue_latch_;
+  std::condition_variable queue_cv_;
+  /** One queue of scheduled requests per DiskRequestPriority, oldest first. */
+  std::array<RequestQueue, NUM_DISK_REQUEST_PRIORITIES> queues_;
+  /** The queued requests of every page, in the order they were scheduled, with the priority of their queue. */
+  std::unordered_map<page_id_t, std::deque<std::pair<DiskRequestPriority, RequestQueue::iterator>>> queued_pages_;
+  DiskSchedulerStats stats_;
+  /** Whether the last request taken was served ahead of more urgent ones, see NextRequest(). */
+  bool last_pick_starved_{false};
+  /** Set by the destructor: the background thread exits once the queues are empty. */
+  bool stopping_{false};
   /** The background thread responsible for issuing scheduled requests to the disk manager. */
   std::optional<std::thread> background_thread_;
+
+  /** The ring of the io_uring backend. */
+  std::unique_ptr<IoUring> ring_;
+  /** Requests handed to the workers of the thread pool; nullptr tells a worker to exit. */
+  Channel<DiskRequest *> work_queue_;
+  /** Protects workers_ and num_pool_workers_, which the dispatcher and the completer may both add to. */
+  std::mutex pool_latch_;
+  /** The io_uring completion thread, and the workers of the thread pool. */
+  std::vector<std::thread> workers_;
+  /** Number of workers of the thread pool in workers_. */
+  size_t num_pool_workers_{0};
+  /** Set once a system call on the ring failed: the thread pool takes the requests from then on. */
+  std::atomic<bool> ring_failed_{false};
+
+  /** Protects in_flight_pages_, in_flight_ and in_ring_. */
+  std::mutex in_flight_latch_;
+  std::condition_variable in_flight_cv_;
+  /** Pages with a request in flight. */
+  std::unordered_set<page_id_t> in_flight_pages_;
+  size_t in_flight_{0};
+  /** Requests queued in the ring or submitted to it, and not completed yet. */
+  std::unordered_set<DiskRequest *> in_ring_;
 };
 }  // namespace bustub
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring.h
+//
+// Identification: src/include/storage/disk/io_uring.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * IoUring is a minimal Linux io_uring, set up with the raw system calls so that no liburing is needed.
+ *
+ * One thread fills and submits the submission queue, while another may wait on the completion queue; the two sides
+ * share nothing else. The caller must keep the number of requests in flight at or below Entries(), so that the
+ * completion queue, which is twice as large, never overflows.
+ */
+class IoUring {
+ public:
+  /**
+   * @brief Set up a ring. Check IsValid() afterwards: the kernel may not support io_uring, or may not allow it.
+   * @param entries size of the submission queue, rounded up to a power of two by the kernel
+   */
+  explicit IoUring(unsigned entries);
+
+  ~IoUring();
+
+  DISALLOW_COPY_AND_MOVE(IoUring);
+
+  /** @return true if the ring was set up */
+  auto IsValid() const -> bool { return ring_fd_ >= 0; }
+
+  /** @return the size of the submission queue */
+  auto Entries() const -> unsigned { return sq_entries_; }
+
+  /**
+   * @brief Queue a request, to be sent to the kernel by the next Submit().
+   * @param opcode IORING_OP_READ, IORING_OP_WRITE or IORING_OP_NOP
+   * @param user_data handed back with the completion
+   * @return false if the submission queue is full
+   */
+  auto Prepare(uint8_t opcode, int fd, void *buffer, uint32_t length, uint64_t offset, uint64_t user_data) -> bool;
+
+  /**
+   * @brief Send the queued requests to the kernel.
+   * @param[out] rejected user_data of the requests that the kernel did not take, appended; they are taken off the queue
+   * @return false if io_uring_enter failed, after which the ring should not be used any more
+   */
+  auto Submit(std::vector<uint64_t> *rejected) -> bool;
+
+  /**
+   * @brief Wait for at least one completion, then take all the available ones.
+   * @param[out] completions (user_data, result) of every completion taken, appended
+   * @return false if io_uring_enter failed, after which the ring should not be used any more
+   */
+  auto WaitCompletions(std::vector<std::pair<uint64_t, int32_t>> *completions) -> bool;
+
+ private:
+  /** @return whether the kernel of the ring supports IORING_OP_READ and IORING_OP_WRITE */
+  static auto SupportsReadWrite(int ring_fd) -> bool;
+
+  /** @brief Unmap whatever part of the queues is mapped. */
+  void Unmap();
+
+  int ring_fd_{-1};
+  unsigned sq_entries_{0};
+  /** Requests queued since the last Submit(). */
+  unsigned to_submit_{0};
+
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+}  // namespace bustub
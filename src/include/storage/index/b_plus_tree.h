@@ -12,7 +12,9 @@
 
 #include <algorithm>
 #include <deque>
+#include <functional>
 #include <iostream>
+#include <mutex>  // NOLINT
 #include <optional>
 #include <queue>
 #include <shared_mutex>
@@ -53,6 +55,9 @@ class Context {
   // You may want to use this when getting value, but not necessary.
   std::deque<ReadPageGuard> read_set_;
 
+  // Pages emptied by merges while removing. They are deleted from the buffer pool once their guards are dropped.
+  std::vector<page_id_t> deleted_pages_;
+
   auto IsRootPage(page_id_t page_id) -> bool { return page_id == root_page_id_; }
 };
 
@@ -65,6 +70,12 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
+  /** Fraction of a page that BulkLoad() fills by default, which leaves room for some inserts before pages split. */
+  static constexpr double DEFAULT_FILL_FACTOR = 0.9;
+
+  /** A source of entries for BulkLoad(): returns true with the next entry filled in, or false at the end. */
+  using EntrySource = std::function<bool(KeyType *, ValueType *)>;
+
   explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
                      const KeyComparator &comparator, int leaf_max_size = LEAF_PAGE_SIZE,
                      int internal_max_size = INTERNAL_PAGE_SIZE);
@@ -75,6 +86,16 @@ class BPlusTree {
   auto BinaryFind(const LeafPage *leaf_page, const KeyType &key) -> int;
   auto BinaryFind(const InternalPage *internal_page, const KeyType &key) -> int;
 
+  /**
+   * @brief Walk down to the leaf that covers `key` with optimistic reads, without latching or pinning any page.
+   *
+   * @param[out] parent the page that points to the leaf: its parent internal page, or the header page if the root is
+   * a leaf. As long as the parent validates, the leaf is the right one for the key.
+   * @param[out] leaf the leaf, which the caller still has to validate after reading it. Invalid if the tree is empty.
+   * @return false if a concurrent writer got in the way, in which case the walk should be retried
+   */
+  auto OptimisticFindLeaf(const KeyType &key, OptimisticPageGuard *parent, OptimisticPageGuard *leaf) -> bool;
+
   auto SplitLeaf(LeafPage *leaf, const KeyType &key, const ValueType &value, page_id_t *new_id) -> KeyType;
 
   auto SplitInternal(InternalPage *internal, const KeyType &key, page_id_t *new_id, page_id_t new_child_id) -> KeyType;
@@ -84,6 +105,21 @@ class BPlusTree {
 
   auto OptimalInsert(const KeyType &key, const ValueType &value, Transaction *txn = nullptr) -> int;
 
+  /**
+   * @brief Build an empty tree bottom-up from entries sorted by key, instead of inserting them one by one.
+   *
+   * The leaves are filled left to right up to `fill_factor` of their max size, and each level of internal pages is
+   * then built over the one below it, so that every page is written once and the pages end up full and in key order.
+   * Of entries with equal keys only the first is kept, as Insert() would. The root is published when the tree is
+   * complete; the header page stays latched until then.
+   *
+   * @param next the entries, in ascending key order, e.g. from an ExternalSorter
+   * @param fill_factor fraction of a page to fill, raised as needed to keep pages at least half full
+   * @return false if the tree is not empty, in which case nothing is read from `next`
+   * @throw Exception if the entries are not sorted, or the buffer pool has no frame for a new page
+   */
+  auto BulkLoad(const EntrySource &next, double fill_factor = DEFAULT_FILL_FACTOR) -> bool;
+
   void RemoveResGuardsPop(std::deque<WritePageGuard> &guards, std::deque<int> &keys_index, const KeyType &origin_key,
                           const KeyType &new_key);
 
@@ -105,6 +141,15 @@ class BPlusTree {
 
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  /**
+   * @brief Scan the keys between two bounds, a leaf at a time.
+   *
+   * @param lo the lower bound, or nullptr to scan from the first key; `lo_inclusive` tells whether it is in the range
+   * @param hi the upper bound, or nullptr to scan to the last key; `hi_inclusive` tells whether it is in the range
+   * @return an iterator over the values of the keys in range, in key order
+   */
+  auto ScanRange(const KeyType *lo, bool lo_inclusive, const KeyType *hi, bool hi_inclusive) -> INDEXRANGEITERATOR_TYPE;
+
   // Print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -124,7 +169,7 @@ class BPlusTree {
    */
   auto DrawBPlusTree() -> std::string;
 
-  // read data from file and insert one by one
+  // read data from file and insert it: bulk loaded if the tree is empty, otherwise one by one
   void InsertFromFile(const std::string &file_name, Transaction *txn = nullptr);
 
   // read data from file and remove one by one
@@ -144,6 +189,26 @@ class BPlusTree {
    */
   auto ToPrintableBPlusTree(page_id_t root_id) -> PrintableBPlusTree;
 
+  /**
+   * Walk down to the leaf that covers `key`, or to the leftmost leaf if `key` is nullptr, latching a page at a time.
+   * @return the leaf, or INVALID_PAGE_ID if the tree is empty
+   */
+  auto FindLeafPageId(const KeyType *key) -> page_id_t;
+
+  /**
+   * Give pages taken off the tree back to the buffer pool. A page that is still pinned, e.g. by a read-ahead or a
+   * scan about to hop to it, is kept and retried on the next call, so that it is not lost to the free-page map.
+   */
+  void DeletePages(const std::vector<page_id_t> &page_ids);
+
+  /** How many times a reader or an optimistic writer retries an optimistic walk before it takes latches. */
+  static constexpr int OPTIMISTIC_ATTEMPTS = 4;
+  /** Number of entries that fit in a leaf or internal page, the bound on a size read from a possibly torn page. */
+  static constexpr size_t LEAF_SLOTS =
+      (BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, ValueType>);
+  static constexpr size_t INTERNAL_SLOTS =
+      (BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, page_id_t>);
+
   // member variable
   std::string index_name_;
   BufferPoolManager *bpm_;
@@ -152,6 +217,12 @@ class BPlusTree {
   int leaf_max_size_;
   int internal_max_size_;
   page_id_t header_page_id_;
+  /** The segment of the header page, which the other pages of the tree are allocated in as well. */
+  segment_id_t segment_;
+  /** Protects pending_deletes_. */
+  std::mutex pending_deletes_latch_;
+  /** Pages off the tree that DeletePages() could not delete yet because they were pinned. */
+  std::vector<page_id_t> pending_deletes_;
 };
 
 /**
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -27,7 +28,12 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  using IndexKeyType = KeyType;
+  using IndexValueType = ValueType;
+  using IndexKeyComparator = KeyComparator;
+
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 segment_id_t segment = DEFAULT_SEGMENT_ID);
 
   auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool override;
 
@@ -35,12 +41,28 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * @brief Fill an empty index: the entries are sorted, spilling to temporary files if there are many, and the tree
+   * is built bottom-up from them. See BPlusTree::BulkLoad().
+   * @param next returns true with the next key tuple and RID filled in, or false at the end
+   * @return false if the index is not empty
+   */
+  auto BulkLoad(const std::function<bool(Tuple *, RID *)> &next,
+                double fill_factor = BPlusTree<KeyType, ValueType, KeyComparator>::DEFAULT_FILL_FACTOR) -> bool;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  /**
+   * @brief Scan the keys between two key tuples, a leaf at a time. See BPlusTree::ScanRange().
+   * @param lo the lower bound, or nullptr for none
+   * @param hi the upper bound, or nullptr for none
+   */
+  auto ScanRange(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive) -> INDEXRANGEITERATOR_TYPE;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
@@ -48,15 +70,58 @@ class BPlusTreeIndex : public Index {
   std::shared_ptr<BPlusTree<KeyType, ValueType, KeyComparator>> container_;
 };
 
-/** We only support index table with one integer key for now in BusTub. Hardcode everything here. */
+/**
+ * The B+ tree indexes that the catalog creates, picked from the key schema by VisitBPlusTreeIndexType(). An index on
+ * one integer column or on two INTEGER columns keeps its keys as native integers, compared with one instruction; any
+ * other index keeps normalized keys of up to 64 bytes.
+ */
 
-constexpr static const auto TWO_INTEGER_SIZE = 8;
-using IntegerKeyType = GenericKey<TWO_INTEGER_SIZE>;
 using IntegerValueType = RID;
-using IntegerComparatorType = GenericComparator<TWO_INTEGER_SIZE>;
-using BPlusTreeIndexForTwoIntegerColumn = BPlusTreeIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
-using BPlusTreeIndexIteratorForTwoIntegerColumn =
-    IndexIterator<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
-using IntegerHashFunctionType = HashFunction<IntegerKeyType>;
+using BPlusTreeIndexForOneIntegerColumn =
+    BPlusTreeIndex<IntegerKey<int32_t>, IntegerValueType, IntegerComparator<IntegerKey<int32_t>>>;
+using BPlusTreeIndexForOneBigintColumn =
+    BPlusTreeIndex<IntegerKey<int64_t>, IntegerValueType, IntegerComparator<IntegerKey<int64_t>>>;
+using BPlusTreeIndexForTwoIntegerColumn =
+    BPlusTreeIndex<IntegerPairKey, IntegerValueType, IntegerComparator<IntegerPairKey>>;
+using BPlusTreeIndexForNormalizedKey = BPlusTreeIndex<NormalizedKey<64>, IntegerValueType, NormalizedComparator<64>>;
+
+/** Names a BPlusTreeIndex type, for VisitBPlusTreeIndexType() to pass it around as a value. */
+template <typename IndexType>
+struct BPlusTreeIndexTag {
+  using Type = IndexType;
+  using KeyType = typename IndexType::IndexKeyType;
+  using ValueType = typename IndexType::IndexValueType;
+  using KeyComparator = typename IndexType::IndexKeyComparator;
+};
+
+/**
+ * @brief Call `f` with the BPlusTreeIndexTag of the index type for `key_schema`: one INTEGER or narrower column, one
+ * BIGINT column, two INTEGER or narrower columns, or a normalized key for anything else.
+ * @return what `f` returns
+ */
+template <typename F>
+auto VisitBPlusTreeIndexType(const Schema &key_schema, F &&f) -> decltype(auto) {
+  auto is_int32 = [&](uint32_t i) {
+    switch (key_schema.GetColumn(i).GetType()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+      case TypeId::SMALLINT:
+      case TypeId::INTEGER:
+        return true;
+      default:
+        return false;
+    }
+  };
+  if (key_schema.GetColumnCount() == 1 && is_int32(0)) {
+    return f(BPlusTreeIndexTag<BPlusTreeIndexForOneIntegerColumn>{});
+  }
+  if (key_schema.GetColumnCount() == 1 && key_schema.GetColumn(0).GetType() == TypeId::BIGINT) {
+    return f(BPlusTreeIndexTag<BPlusTreeIndexForOneBigintColumn>{});
+  }
+  if (key_schema.GetColumnCount() == 2 && is_int32(0) && is_int32(1)) {
+    return f(BPlusTreeIndexTag<BPlusTreeIndexForTwoIntegerColumn>{});
+  }
+  return f(BPlusTreeIndexTag<BPlusTreeIndexForNormalizedKey>{});
+}
 
 }  // namespace bustub
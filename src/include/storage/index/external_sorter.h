@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.h
+//
+// Identification: src/include/storage/index/external_sorter.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <queue>
+#include <type_traits>
+#include <vector>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+/**
+ * ExternalSorter sorts (key, value) entries by key, for more entries than should be held in memory, e.g. to bulk load
+ * an index on a large table.
+ *
+ * Entries are gathered into a run of at most `run_entries`. A full run is sorted and spilled to a temporary file, and
+ * Next() merges the runs as it reads them back, a block of entries per run at a time. If all entries fit in one run,
+ * nothing is spilled. Entries with equal keys come out in the order they were added.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExternalSorter {
+  static_assert(std::is_trivially_copyable_v<KeyType> && std::is_trivially_copyable_v<ValueType>,
+                "entries are spilled as raw bytes");
+
+ public:
+  /** Entries in a run by default: 1M, tens of MB for the keys of BusTub's indexes. */
+  static constexpr size_t DEFAULT_RUN_ENTRIES = 1 << 20;
+
+  explicit ExternalSorter(const KeyComparator &comparator, size_t run_entries = DEFAULT_RUN_ENTRIES)
+      : comparator_(comparator), run_entries_(std::max<size_t>(1, run_entries)) {}
+
+  ~ExternalSorter() {
+    for (auto &run : runs_) {
+      fclose(run.file_);
+    }
+  }
+
+  ExternalSorter(const ExternalSorter &) = delete;
+  auto operator=(const ExternalSorter &) -> ExternalSorter & = delete;
+
+  /** @brief Add an entry. Must not be called after Finish(). */
+  void Add(const KeyType &key, const ValueType &value) {
+    buffer_.push_back({key, value});
+    if (buffer_.size() == run_entries_) {
+      SpillRun();
+    }
+  }
+
+  /** @brief Sort what was added, after which Next() returns the entries in order. */
+  void Finish() {
+    if (!runs_.empty() && !buffer_.empty()) {
+      SpillRun();
+    }
+    if (runs_.empty()) {
+      SortBuffer();
+      return;
+    }
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    for (size_t i = 0; i < runs_.size(); i++) {
+      rewind(runs_[i].file_);
+      if (Refill(&runs_[i])) {
+        heads_.push(i);
+      }
+    }
+  }
+
+  /** @return false once every entry was returned, otherwise true with the next entry in `key` and `value` */
+  auto Next(KeyType *key, ValueType *value) -> bool {
+    if (runs_.empty()) {
+      if (next_ == buffer_.size()) {
+        return false;
+      }
+      *key = buffer_[next_].key_;
+      *value = buffer_[next_].value_;
+      next_++;
+      return true;
+    }
+    if (heads_.empty()) {
+      return false;
+    }
+    auto &run = runs_[heads_.top()];
+    heads_.pop();
+    *key = run.block_[run.next_].key_;
+    *value = run.block_[run.next_].value_;
+    run.next_++;
+    if (run.next_ < run.block_.size() || Refill(&run)) {
+      heads_.push(static_cast<size_t>(&run - runs_.data()));
+    }
+    return true;
+  }
+
+  /** @return the number of runs spilled to temporary files, 0 if the entries were sorted in memory */
+  auto GetNumRuns() const -> size_t { return runs_.size(); }
+
+ private:
+  /** Entries read back from a run at a time. */
+  static constexpr size_t BLOCK_ENTRIES = 4096;
+
+  struct Entry {
+    KeyType key_;
+    ValueType value_;
+  };
+
+  /** A sorted run in a temporary file, and the block of it being merged. */
+  struct Run {
+    FILE *file_;
+    std::vector<Entry> block_;
+    size_t next_{0};
+  };
+
+  /** Orders runs by their next entry, smallest first, and equal keys by run, so that the merge is stable. */
+  struct HeadGreater {
+    const ExternalSorter *sorter_;
+    auto operator()(size_t a, size_t b) const -> bool {
+      const auto &run_a = sorter_->runs_[a];
+      const auto &run_b = sorter_->runs_[b];
+      int cmp = sorter_->comparator_(run_a.block_[run_a.next_].key_, run_b.block_[run_b.next_].key_);
+      return cmp > 0 || (cmp == 0 && a > b);
+    }
+  };
+
+  void SortBuffer() {
+    std::stable_sort(buffer_.begin(), buffer_.end(),
+                     [this](const Entry &a, const Entry &b) { return comparator_(a.key_, b.key_) < 0; });
+  }
+
+  void SpillRun() {
+    SortBuffer();
+    FILE *file = std::tmpfile();
+    if (file == nullptr) {
+      throw Exception("can't create a temporary file to sort in");
+    }
+    runs_.push_back({file, {}, 0});
+    if (fwrite(buffer_.data(), sizeof(Entry), buffer_.size(), file) != buffer_.size()) {
+      throw Exception("can't write a sorted run to its temporary file");
+    }
+    buffer_.clear();
+  }
+
+  /** @return false if the run is exhausted, otherwise true with the next block of it read */
+  auto Refill(Run *run) -> bool {
+    run->block_.resize(BLOCK_ENTRIES);
+    run->block_.resize(fread(run->block_.data(), sizeof(Entry), BLOCK_ENTRIES, run->file_));
+    run->next_ = 0;
+    return !run->block_.empty();
+  }
+
+  KeyComparator comparator_;
+  size_t run_entries_;
+  /** The run being gathered, or all entries if none was spilled. */
+  std::vector<Entry> buffer_;
+  /** Next entry of buffer_ to return, if none was spilled. */
+  size_t next_{0};
+  std::vector<Run> runs_;
+  /** The runs that have entries left, by their next entry. */
+  std::priority_queue<size_t, std::vector<size_t>, HeadGreater> heads_{HeadGreater{this}};
+};
+
+}  // namespace bustub
@@ -35,6 +35,10 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  // The key tuple is kept as it is, so the schema is not needed; it is there for key types that encode the columns,
+  // such as NormalizedKey.
+  inline void SetFromKey(const Tuple &tuple, const Schema & /* key_schema */) { SetFromKey(tuple); }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
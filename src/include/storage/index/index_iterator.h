@@ -13,12 +13,23 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "buffer/read_ahead.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
+#define INDEXRANGEITERATOR_TYPE IndexRangeIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * IndexIterator holds no pin between entries, and follows the next-leaf link of a leaf it no longer holds. It is
+ * meant for a tree that is not being modified: after a concurrent merge the link may lead to a page that has been
+ * deleted, or reused for another node. IndexRangeIterator checks every hop instead.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
@@ -45,6 +56,57 @@ class IndexIterator {
   page_id_t cur_;
   int index_;
   MappingType item_;
+  /** Prefetches the leaves ahead of the iterator. */
+  ReadAhead read_ahead_;
+};
+
+/**
+ * IndexRangeIterator returns the values of the keys in a range, a leaf at a time: NextBatch() latches a leaf once and
+ * copies out every value in range it holds, where IndexIterator fetches the leaf again for every entry.
+ *
+ * No pin is held between batches, so the next leaf may have been merged away and its page deleted, or reused for
+ * another node, by the time the iterator gets to it. A hop that does not land on a leaf past the last key returned
+ * looks the leaf up again from the root, and resumes after that key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class IndexRangeIterator {
+ public:
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
+  /**
+   * @param leaf the leaf to start at, the one the lower bound would be in; INVALID_PAGE_ID for an empty range
+   * @param lo the lower bound, or std::nullopt for none; `lo_inclusive` tells whether it is in the range
+   * @param hi the upper bound, or std::nullopt for none; `hi_inclusive` tells whether it is in the range
+   * @param find_leaf looks up the leaf that a key would be in, or the leftmost leaf for nullptr
+   */
+  IndexRangeIterator(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator, page_id_t leaf,
+                     std::optional<KeyType> lo, bool lo_inclusive, std::optional<KeyType> hi, bool hi_inclusive,
+                     std::function<page_id_t(const KeyType *)> find_leaf);
+
+  /**
+   * @brief Replace `values` with the values in range of the next leaf that has any.
+   * @return false, with `values` empty, once the range is exhausted
+   */
+  auto NextBatch(std::vector<ValueType> *values) -> bool;
+
+ private:
+  /** @return whether `key` is past the upper bound */
+  auto AboveRange(const KeyType &key) const -> bool;
+
+  BufferPoolManager *bpm_;
+  KeyComparator comparator_;
+  /** The next leaf to read, INVALID_PAGE_ID at the end of the range. */
+  page_id_t next_leaf_;
+  /** Whether the lower bound is still to be searched for, in the first leaf. */
+  bool first_leaf_{true};
+  /** The lower bound, moved up to the last key returned after every batch. */
+  std::optional<KeyType> lo_;
+  bool lo_inclusive_;
+  std::optional<KeyType> hi_;
+  bool hi_inclusive_;
+  /** Prefetches the leaves ahead of the iterator. */
+  ReadAhead read_ahead_;
+  std::function<page_id_t(const KeyType *)> find_leaf_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// integer_key.h
+//
+// Identification: src/include/storage/index/integer_key.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** @return the value of an integer column widened to int64_t; a null is the smallest value of its type */
+inline auto IntegerKeyColumn(const Tuple &tuple, const Schema &key_schema, uint32_t column) -> int64_t {
+  const Value value = tuple.GetValue(&key_schema, column);
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    case TypeId::BIGINT:
+      return value.GetAs<int64_t>();
+    default:
+      throw Exception(ExceptionType::MISMATCH_TYPE, "type can't be part of an integer key");
+  }
+}
+
+/**
+ * IntegerKey holds the key of an index on one integer column as a native int32_t or int64_t, so that
+ * IntegerComparator compares keys with one instruction. BusTub stores a null as the smallest value of the type, so
+ * nulls sort first, as with NormalizedKey.
+ */
+template <typename T>
+class IntegerKey {
+  static_assert(std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>, "an integer key is an int32_t or int64_t");
+
+ public:
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    BUSTUB_ASSERT(key_schema.GetColumnCount() == 1, "an integer key has one column");
+    value_ = static_cast<T>(IntegerKeyColumn(tuple, key_schema, 0));
+  }
+
+  // NOTE: for test purpose only
+  inline void SetFromInteger(int64_t key) { value_ = static_cast<T>(key); }
+
+  // NOTE: for test purpose only
+  inline auto ToString() const -> int64_t { return value_; }
+
+  // NOTE: for test purpose only
+  friend auto operator<<(std::ostream &os, const IntegerKey &key) -> std::ostream & {
+    os << key.value_;
+    return os;
+  }
+
+  T value_;
+};
+
+/**
+ * IntegerPairKey holds the key of an index on two INTEGER columns packed in one int64_t: the first column in the
+ * high half, the second in the low half with its sign bit flipped, so that the packed keys order as the pairs do.
+ */
+class IntegerPairKey {
+ public:
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    BUSTUB_ASSERT(key_schema.GetColumnCount() == 2, "an integer pair key has two columns");
+    Pack(static_cast<int32_t>(IntegerKeyColumn(tuple, key_schema, 0)),
+         static_cast<int32_t>(IntegerKeyColumn(tuple, key_schema, 1)));
+  }
+
+  // NOTE: for test purpose only
+  // the key is (key, 0), so that keys order as the integers do
+  inline void SetFromInteger(int64_t key) { Pack(static_cast<int32_t>(key), 0); }
+
+  // NOTE: for test purpose only
+  // decode the key that SetFromInteger() wrote
+  inline auto ToString() const -> int64_t { return value_ >> 32; }
+
+  // NOTE: for test purpose only
+  friend auto operator<<(std::ostream &os, const IntegerPairKey &key) -> std::ostream & {
+    os << "(" << (key.value_ >> 32) << "," << static_cast<int32_t>(static_cast<uint32_t>(key.value_) ^ (1U << 31))
+       << ")";
+    return os;
+  }
+
+  int64_t value_;
+
+ private:
+  inline void Pack(int32_t first, int32_t second) {
+    value_ = static_cast<int64_t>((static_cast<uint64_t>(static_cast<uint32_t>(first)) << 32) |
+                                  (static_cast<uint32_t>(second) ^ (1U << 31)));
+  }
+};
+
+/**
+ * Function object that compares two IntegerKeys or IntegerPairKeys as the native integers they hold: returns -1, 0
+ * or 1, like GenericComparator.
+ */
+template <typename KeyType>
+class IntegerComparator {
+ public:
+  inline auto operator()(const KeyType &lhs, const KeyType &rhs) const -> int {
+    return static_cast<int>(lhs.value_ > rhs.value_) - static_cast<int>(lhs.value_ < rhs.value_);
+  }
+
+  IntegerComparator() = default;
+
+  // The key schema is not needed to compare integer keys; this is the constructor that indexes call.
+  explicit IntegerComparator(Schema * /* key_schema */) {}
+};
+
+}  // namespace bustub
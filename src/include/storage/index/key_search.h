@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/index/key_search.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace bustub {
+
+/**
+ * The instruction set that searches the integer keys of a B+ tree page, see KeyUpperBound(). Each one is faster than
+ * the one before it, and needs the CPU features of the ones before it.
+ */
+enum class KeySearchIsa {
+  /** Branch-free binary search, then a scalar count of the last few keys. */
+  Scalar,
+  /** Branch-free binary search down to four cache lines of keys, then SSE4.2 compares over them. */
+  Sse42,
+  /** Branch-free binary search down to four cache lines of keys, then AVX2 compares over them. */
+  Avx2,
+};
+
+/** @return the name of an instruction set, for reports */
+auto KeySearchIsaName(KeySearchIsa isa) -> std::string;
+
+/** @return the most capable instruction set that this CPU can search keys with */
+auto DetectKeySearchIsa() -> KeySearchIsa;
+
+/** @return the instruction set that KeyUpperBound() uses: DetectKeySearchIsa(), unless SetKeySearchIsa() changed it */
+auto GetKeySearchIsa() -> KeySearchIsa;
+
+/**
+ * @brief Make KeyUpperBound() use `isa`, e.g. to measure a scalar search against a vectorized one.
+ * @throw Exception if this CPU can't run `isa`
+ */
+void SetKeySearchIsa(KeySearchIsa isa);
+
+/**
+ * @return the number of keys of keys[0, n), sorted in increasing order, that are not greater than `key`: the index
+ * of the first greater key, as std::upper_bound
+ */
+auto KeyUpperBound(const int32_t *keys, int n, int32_t key) -> int;
+auto KeyUpperBound(const int64_t *keys, int n, int64_t key) -> int;
+
+}  // namespace bustub
@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/storage/index/normalized_key.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * NormalizedKey holds an index key in a byte-comparable encoding: keys compare the way their bytes do, so that
+ * NormalizedComparator is a memcmp, where GenericComparator deserializes and compares a Value per column on every
+ * step of a search.
+ *
+ * The columns of the key schema are written one after the other:
+ * - BOOLEAN, TINYINT, SMALLINT, INTEGER and BIGINT big-endian, with the sign bit flipped. BusTub stores a null as the
+ *   smallest value of the type, so nulls sort first without a null byte.
+ * - DECIMAL, TIMESTAMP and VARCHAR after a null byte: 0 for null, which sorts first, and 1 otherwise. A DECIMAL is
+ *   written as its bits, big-endian, with the sign bit flipped if it is positive and every bit if it is negative; a
+ *   TIMESTAMP big-endian.
+ * - A VARCHAR as its bytes with every 0 escaped as 0 0xFF, and 0 0 at the end, so that a string sorts right before
+ *   the strings it is a prefix of.
+ * The rest of the key is zeroed. A key whose encoding does not fit in KeySize bytes is refused rather than cut short,
+ * which could make different keys equal.
+ */
+template <size_t KeySize>
+class NormalizedKey {
+ public:
+  /**
+   * @brief Encode a key tuple.
+   * @param key_schema the schema of the key tuple, e.g. IndexMetadata::GetKeySchema()
+   * @throw Exception if the encoded key is longer than KeySize
+   */
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    memset(data_, 0, KeySize);
+    size_t pos = 0;
+    for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+      const Value value = tuple.GetValue(&key_schema, i);
+      switch (value.GetTypeId()) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          PutSigned(value.GetAs<int8_t>(), &pos);
+          break;
+        case TypeId::SMALLINT:
+          PutSigned(value.GetAs<int16_t>(), &pos);
+          break;
+        case TypeId::INTEGER:
+          PutSigned(value.GetAs<int32_t>(), &pos);
+          break;
+        case TypeId::BIGINT:
+          PutSigned(value.GetAs<int64_t>(), &pos);
+          break;
+        case TypeId::DECIMAL: {
+          PutByte(value.IsNull() ? 0 : 1, &pos);
+          if (!value.IsNull()) {
+            double decimal = value.GetAs<double>();
+            uint64_t bits;
+            memcpy(&bits, &decimal, sizeof(bits));
+            bits = (bits >> 63) != 0 ? ~bits : bits ^ (uint64_t{1} << 63);
+            PutBigEndian(bits, sizeof(bits), &pos);
+          }
+          break;
+        }
+        case TypeId::TIMESTAMP:
+          PutByte(value.IsNull() ? 0 : 1, &pos);
+          if (!value.IsNull()) {
+            PutBigEndian(value.GetAs<uint64_t>(), sizeof(uint64_t), &pos);
+          }
+          break;
+        case TypeId::VARCHAR: {
+          PutByte(value.IsNull() ? 0 : 1, &pos);
+          if (!value.IsNull()) {
+            // The length of a varchar counts its terminating '\0'.
+            const char *str = value.GetData();
+            for (uint32_t j = 0; j + 1 < value.GetLength(); j++) {
+              PutByte(static_cast<uint8_t>(str[j]), &pos);
+              if (str[j] == '\0') {
+                PutByte(0xFF, &pos);
+              }
+            }
+            PutByte(0, &pos);
+            PutByte(0, &pos);
+          }
+          break;
+        }
+        default:
+          throw Exception(ExceptionType::MISMATCH_TYPE, "type can't be part of a normalized key");
+      }
+    }
+  }
+
+  // NOTE: for test purpose only
+  // encode as a single BIGINT column, or INTEGER if the key is too short for a BIGINT
+  inline void SetFromInteger(int64_t key) {
+    memset(data_, 0, KeySize);
+    size_t pos = 0;
+    if constexpr (KeySize < sizeof(int64_t)) {
+      PutSigned(static_cast<int32_t>(key), &pos);
+    } else {
+      PutSigned(key, &pos);
+    }
+  }
+
+  // NOTE: for test purpose only
+  // decode the key that SetFromInteger() wrote
+  inline auto ToString() const -> int64_t {
+    if constexpr (KeySize < sizeof(int64_t)) {
+      return static_cast<int32_t>(static_cast<uint32_t>(GetBigEndian(sizeof(int32_t))) ^ (uint32_t{1} << 31));
+    } else {
+      return static_cast<int64_t>(GetBigEndian(sizeof(int64_t)) ^ (uint64_t{1} << 63));
+    }
+  }
+
+  // NOTE: for test purpose only
+  friend auto operator<<(std::ostream &os, const NormalizedKey &key) -> std::ostream & {
+    os << key.ToString();
+    return os;
+  }
+
+  // actual location of data, extends past the end.
+  char data_[KeySize];
+
+ private:
+  inline void PutByte(uint8_t byte, size_t *pos) {
+    if (*pos == KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE,
+                      "index key does not fit in a normalized key of " + std::to_string(KeySize) + " bytes");
+    }
+    data_[(*pos)++] = static_cast<char>(byte);
+  }
+
+  inline void PutBigEndian(uint64_t value, size_t bytes, size_t *pos) {
+    for (size_t i = bytes; i > 0; i--) {
+      PutByte(static_cast<uint8_t>(value >> ((i - 1) * 8)), pos);
+    }
+  }
+
+  template <typename T>
+  inline void PutSigned(T value, size_t *pos) {
+    using UnsignedT = std::make_unsigned_t<T>;
+    const auto sign_bit = static_cast<UnsignedT>(UnsignedT{1} << (sizeof(T) * 8 - 1));
+    PutBigEndian(static_cast<UnsignedT>(static_cast<UnsignedT>(value) ^ sign_bit), sizeof(T), pos);
+  }
+
+  inline auto GetBigEndian(size_t bytes) const -> uint64_t {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+      value = (value << 8) | static_cast<uint8_t>(data_[i]);
+    }
+    return value;
+  }
+};
+
+/**
+ * Function object that compares two NormalizedKeys as bytes: returns -1, 0 or 1, like GenericComparator.
+ */
+template <size_t KeySize>
+class NormalizedComparator {
+ public:
+  inline auto operator()(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) const -> int {
+    if constexpr (KeySize % sizeof(uint64_t) == 0) {
+      // Compare a word at a time, swapped to big-endian so that the first byte is the most significant.
+      for (size_t i = 0; i < KeySize; i += sizeof(uint64_t)) {
+        uint64_t lhs_word;
+        uint64_t rhs_word;
+        memcpy(&lhs_word, lhs.data_ + i, sizeof(uint64_t));
+        memcpy(&rhs_word, rhs.data_ + i, sizeof(uint64_t));
+        if (lhs_word != rhs_word) {
+          return __builtin_bswap64(lhs_word) < __builtin_bswap64(rhs_word) ? -1 : 1;
+        }
+      }
+      return 0;
+    } else {
+      int cmp = memcmp(lhs.data_, rhs.data_, KeySize);
+      return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+    }
+  }
+
+  NormalizedComparator() = default;
+
+  // The key schema is not needed to compare normalized keys; this is the constructor that indexes call.
+  explicit NormalizedComparator(Schema * /* key_schema */) {}
+};
+
+}  // namespace bustub
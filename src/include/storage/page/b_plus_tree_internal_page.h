@@ -19,7 +19,7 @@ namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
 #define INTERNAL_PAGE_HEADER_SIZE 12
-#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(KeyType) + sizeof(ValueType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -29,12 +29,19 @@ namespace bustub {
  * should ignore the first key.
  *
  * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------------------
+ * | HEADER | KEY(1) | KEY(2) | ... | KEY(n) | ... | PAGE_ID(1) | PAGE_ID(2) | ... | PAGE_ID(n) | ... |
+ *  ---------------------------------------------------------------------------------------------------
+ * As in a leaf page, the keys and the page ids are two arrays of INTERNAL_PAGE_SIZE entries each.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
+  static_assert(sizeof(KeyType) % alignof(ValueType) == 0, "the values must be aligned after the keys");
+  static_assert((INTERNAL_PAGE_HEADER_SIZE + alignof(KeyType) - 1) / alignof(KeyType) * alignof(KeyType) +
+                        INTERNAL_PAGE_SIZE * (sizeof(KeyType) + sizeof(ValueType)) <=
+                    BUSTUB_PAGE_SIZE,
+                "the keys and values must fit in a page");
+
  public:
   // Deleted to disallow initialization
   BPlusTreeInternalPage() = delete;
@@ -51,7 +58,10 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    * @param index The index of the key to get. Index must be non-zero.
    * @return Key at index
    */
-  auto KeyAt(int index) const -> KeyType;
+  auto KeyAt(int index) const -> const KeyType &;
+
+  /** @return the keys of the page, contiguous in memory, for a search that compares several at once */
+  auto KeyArray() const -> const KeyType * { return key_array_; }
 
   /**
    *
@@ -102,7 +112,15 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   }
 
  private:
-  // Flexible array member for page data.
-  MappingType array_[0];
+  auto ValueArray() const -> const ValueType * {
+    return reinterpret_cast<const ValueType *>(reinterpret_cast<const char *>(key_array_) +
+                                               INTERNAL_PAGE_SIZE * sizeof(KeyType));
+  }
+  auto ValueArray() -> ValueType * {
+    return reinterpret_cast<ValueType *>(reinterpret_cast<char *>(key_array_) + INTERNAL_PAGE_SIZE * sizeof(KeyType));
+  }
+
+  // Flexible array member for page data: the keys, followed by the values at ValueArray().
+  KeyType key_array_[0];
 };
 }  // namespace bustub
@@ -20,7 +20,7 @@ namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
 #define LEAF_PAGE_HEADER_SIZE 16
-#define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (sizeof(KeyType) + sizeof(ValueType)))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -28,9 +28,11 @@ namespace bustub {
  * page. Only support unique key.
  *
  * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------
+ * | HEADER | KEY(1) | KEY(2) | ... | KEY(n) | ... | RID(1) | RID(2) | ... | RID(n) | ... |
+ *  ---------------------------------------------------------------------------------------
+ * The keys and the RIDs are two arrays of LEAF_PAGE_SIZE entries each, so that a search only reads the keys,
+ * packed together in as few cache lines as they take.
  *
  *  Header format (size in byte, 16 bytes in total):
  *  ---------------------------------------------------------------------
@@ -42,6 +44,12 @@ namespace bustub {
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
+  static_assert(sizeof(KeyType) % alignof(ValueType) == 0, "the values must be aligned after the keys");
+  static_assert((LEAF_PAGE_HEADER_SIZE + alignof(KeyType) - 1) / alignof(KeyType) * alignof(KeyType) +
+                        LEAF_PAGE_SIZE * (sizeof(KeyType) + sizeof(ValueType)) <=
+                    BUSTUB_PAGE_SIZE,
+                "the keys and values must fit in a page");
+
  public:
   // Delete all constructor / destructor to ensure memory safety
   BPlusTreeLeafPage() = delete;
@@ -57,7 +65,10 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
-  auto KeyAt(int index) const -> KeyType;
+  auto KeyAt(int index) const -> const KeyType &;
+
+  /** @return the keys of the page, contiguous in memory, for a search that compares several at once */
+  auto KeyArray() const -> const KeyType * { return key_array_; }
   auto ValueAt(int index) const -> ValueType;
   void SetAt(int index, const KeyType &key, const ValueType &val);
 
@@ -87,8 +98,16 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   }
 
  private:
+  auto ValueArray() const -> const ValueType * {
+    return reinterpret_cast<const ValueType *>(reinterpret_cast<const char *>(key_array_) +
+                                               LEAF_PAGE_SIZE * sizeof(KeyType));
+  }
+  auto ValueArray() -> ValueType * {
+    return reinterpret_cast<ValueType *>(reinterpret_cast<char *>(key_array_) + LEAF_PAGE_SIZE * sizeof(KeyType));
+  }
+
   page_id_t next_page_id_;
-  // Flexible array member for page data.
-  MappingType array_[0];
+  // Flexible array member for page data: the keys, followed by the values at ValueArray().
+  KeyType key_array_[0];
 };
 }  // namespace bustub
@@ -17,6 +17,8 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "storage/index/generic_key.h"
+#include "storage/index/integer_key.h"
+#include "storage/index/normalized_key.h"
 
 namespace bustub {
 
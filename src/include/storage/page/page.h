@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -28,6 +29,7 @@ namespace bustub {
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManager;
+  friend class OptimisticPageGuard;
 
  public:
   /** Constructor. Zeros out the page data. */
@@ -36,8 +38,18 @@ class Page {
     ResetMemory();
   }
 
+  /**
+   * Constructor for a buffer pool frame whose data lives in memory owned by the buffer pool. The data is neither
+   * zeroed nor freed by the page.
+   */
+  explicit Page(char *data) : data_(data), owns_data_(false) {}
+
   /** Default destructor. */
-  ~Page() { delete[] data_; }
+  ~Page() {
+    if (owns_data_) {
+      delete[] data_;
+    }
+  }
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
@@ -51,18 +63,33 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. Makes the version odd until the latch is released. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Try to acquire the page read latch without blocking. */
+  inline auto TryRLatch() -> bool { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * @return the version of the frame, for optimistic reads. It is odd while a writer holds the page write latch, and
+   * changes whenever the page is modified or the frame is given to another page.
+   */
+  inline auto GetVersion() -> uint64_t { return version_.load(std::memory_order_acquire); }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -83,14 +110,20 @@ class Page {
 
   /** The actual data that is stored within a page. */
   // Usually this should be stored as `char data_[BUSTUB_PAGE_SIZE]{};`. But to enable ASAN to detect page overflow,
-  // we store it as a ptr.
+  // we store it as a ptr. Frames of a buffer pool point into its arena instead, where the neighbouring frames follow
+  // without a redzone.
   char *data_;
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
+  /** True if data_ was allocated by this page. */
+  bool owns_data_{true};
+  // The buffer pool serves hits without its latch, so the book-keeping fields below are read and updated concurrently.
+  /** The ID of this page. INVALID_PAGE_ID while the frame is free, being read in, or being evicted. */
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /** Bumped on every write latch and release, and by the buffer pool when it takes the frame away from its page. */
+  std::atomic<uint64_t> version_ = 0;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -217,4 +219,50 @@ class WritePageGuard {
   BasicPageGuard guard_;
 };
 
+/**
+ * OptimisticPageGuard reads a page without pinning or latching it. Nothing stops a writer from changing the page, or
+ * the buffer pool from evicting it, while it is being read; instead, the guard remembers the version of the frame
+ * and Validate() tells whether it is still the same. Anything read through the guard may be torn until Validate()
+ * has returned true, so readers must bounds-check every offset they take from the page.
+ */
+class OptimisticPageGuard {
+ public:
+  OptimisticPageGuard() = default;
+  OptimisticPageGuard(Page *page, page_id_t page_id, uint64_t version) noexcept
+      : page_(page), page_id_(page_id), version_(version) {}
+
+  OptimisticPageGuard(const OptimisticPageGuard &) = default;
+  auto operator=(const OptimisticPageGuard &) -> OptimisticPageGuard & = default;
+
+  /** @return false if the buffer pool could not give a consistent view of the page, e.g. because it is being written */
+  auto IsValid() const -> bool { return page_ != nullptr; }
+
+  /**
+   * @brief Check that the page has neither been modified nor evicted since the guard was taken. Call it after reading
+   * from the page and before using what was read.
+   */
+  auto Validate() const -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return page_ != nullptr && page_->version_.load(std::memory_order_relaxed) == version_;
+  }
+
+  /** @brief Forget the page. There is nothing to release. */
+  void Drop() { page_ = nullptr; }
+
+  auto PageId() const -> page_id_t { return page_id_; }
+
+  auto GetData() -> const char * { return page_->GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+ private:
+  Page *page_{nullptr};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  /** The even version of the frame when the guard was taken. */
+  uint64_t version_{0};
+};
+
 }  // namespace bustub
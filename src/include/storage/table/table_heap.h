@@ -40,9 +40,9 @@ class TableHeap {
   /**
    * Create a table heap without a transaction. (open table)
    * @param buffer_pool_manager the buffer pool manager
-   * @param first_page_id the id of the first page
+   * @param segment the segment that the pages of the table are allocated in
    */
-  explicit TableHeap(BufferPoolManager *bpm);
+  explicit TableHeap(BufferPoolManager *bpm, segment_id_t segment = DEFAULT_SEGMENT_ID);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return std::nullopt.
@@ -63,17 +63,19 @@ class TableHeap {
   /**
    * Read a tuple from the table.
    * @param rid rid of the tuple to read
+   * @param access_type how the page is being accessed, e.g. Scan for sequential scans and Lookup for point reads
    * @return the meta and tuple
    */
-  auto GetTuple(RID rid) -> std::pair<TupleMeta, Tuple>;
+  auto GetTuple(RID rid, AccessType access_type = AccessType::Unknown) -> std::pair<TupleMeta, Tuple>;
 
   /**
    * Read a tuple meta from the table. Note: if you want to get tuple and meta together, use `GetTuple` insead
    * to ensure atomicity.
    * @param rid rid of the tuple to read
+   * @param access_type how the page is being accessed
    * @return the meta
    */
-  auto GetTupleMeta(RID rid) -> TupleMeta;
+  auto GetTupleMeta(RID rid, AccessType access_type = AccessType::Unknown) -> TupleMeta;
 
   /** @return the iterator of this table, use this for project 3 */
   auto MakeIterator() -> TableIterator;
@@ -84,6 +86,9 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return the segment that the pages of this table are in */
+  inline auto GetSegment() const -> segment_id_t { return segment_; }
+
   /**
    * Update a tuple in place. SHOULD NOT BE USED UNLESS YOU WANT TO OPTIMIZE FOR PROJECT 4.
    * @param meta new tuple meta
@@ -94,6 +99,7 @@ class TableHeap {
 
  private:
   BufferPoolManager *bpm_;
+  segment_id_t segment_;
   page_id_t first_page_id_{INVALID_PAGE_ID};
 
   std::mutex latch_;
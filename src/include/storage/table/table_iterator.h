@@ -16,6 +16,7 @@
 #include <memory>
 #include <utility>
 
+#include "buffer/read_ahead.h"
 #include "common/macros.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
@@ -52,6 +53,7 @@ class TableIterator {
       table_heap_ = other.table_heap_;
       rid_ = other.rid_;
       stop_at_rid_ = other.stop_at_rid_;
+      read_ahead_ = other.read_ahead_;
     }
     return *this;
   }
@@ -66,6 +68,9 @@ class TableIterator {
   // Otherwise we will have dead loops when updating while scanning. (In project 4, update should be implemented as
   // deletion + insertion.)
   RID stop_at_rid_;
+
+  /** Prefetches the pages ahead of the scan. */
+  ReadAhead read_ahead_;
 };
 
 }  // namespace bustub
@@ -74,6 +74,21 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
         }
       }
     }
+
+    // An index scan, e.g. of a range of keys, already returns the tuples in the order of its index.
+    if (child_plan->GetType() == PlanType::IndexScan) {
+      const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*child_plan);
+      const auto *index = catalog_.GetIndex(index_scan.GetIndexOid());
+      const auto *table_info = catalog_.GetTable(index->table_name_);
+      const auto &columns = index->key_schema_.GetColumns();
+      bool valid = columns.size() == order_by_column_ids.size();
+      for (size_t i = 0; valid && i < columns.size(); i++) {
+        valid = columns[i].GetName() == table_info->schema_.GetColumn(order_by_column_ids[i]).GetName();
+      }
+      if (valid) {
+        return child_plan;
+      }
+    }
   }
 
   return optimized_plan;
@@ -0,0 +1,176 @@
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "catalog/column.h"
+#include "catalog/schema.h"
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+#include "type/type_id.h"
+
+namespace bustub {
+
+namespace {
+
+/** A bound of a key range: the key, and whether the key itself is in the range. */
+struct KeyBound {
+  Value key_;
+  bool inclusive_;
+};
+
+/** Split a predicate into the terms that are AND-ed together. */
+void SplitConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  const auto *logic = dynamic_cast<const LogicExpression *>(expr.get());
+  if (logic != nullptr && logic->logic_type_ == LogicType::And) {
+    SplitConjuncts(logic->GetChildAt(0), conjuncts);
+    SplitConjuncts(logic->GetChildAt(1), conjuncts);
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+auto IsIntegerType(TypeId type) -> bool {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+/** @return the comparison that `b op a` makes, for `a op b` */
+auto FlipComparison(ComparisonType type) -> ComparisonType {
+  switch (type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return type;
+  }
+}
+
+/** Narrow `bound` to `candidate` if it is the tighter of the two: the greater one if `lower`, else the smaller one. */
+void Tighten(std::optional<KeyBound> *bound, const KeyBound &candidate, bool lower) {
+  if (!bound->has_value()) {
+    *bound = candidate;
+    return;
+  }
+  const Value &key = (*bound)->key_;
+  const bool tighter = lower ? key.CompareLessThan(candidate.key_) == CmpBool::CmpTrue
+                             : key.CompareGreaterThan(candidate.key_) == CmpBool::CmpTrue;
+  if (tighter || (key.CompareEquals(candidate.key_) == CmpBool::CmpTrue && !candidate.inclusive_)) {
+    *bound = candidate;
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeRangeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeRangeFilterAsIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Filter) {
+    return optimized_plan;
+  }
+  const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
+  BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Filter with multiple children?? Impossible!");
+  const auto &child_plan = optimized_plan->children_[0];
+  if (child_plan->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
+  if (seq_scan.filter_predicate_ != nullptr) {
+    return optimized_plan;
+  }
+  const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
+
+  std::vector<AbstractExpressionRef> conjuncts;
+  SplitConjuncts(filter_plan.GetPredicate(), &conjuncts);
+
+  // Only an index of one integer column is scanned by range: a bound becomes an index key by casting the constant to
+  // the column type, which is exact only for integers, and a key of several columns would need prefix bounds. The
+  // whole predicate is still checked on each tuple scanned.
+  for (const auto *index : catalog_.GetTableIndexes(table_info->name_)) {
+    const auto &key_columns = index->key_schema_.GetColumns();
+    if (key_columns.size() != 1 || !IsIntegerType(key_columns[0].GetType())) {
+      continue;
+    }
+    const TypeId key_type = key_columns[0].GetType();
+
+    std::optional<KeyBound> lower;
+    std::optional<KeyBound> upper;
+    for (const auto &conjunct : conjuncts) {
+      const auto *comparison = dynamic_cast<const ComparisonExpression *>(conjunct.get());
+      if (comparison == nullptr || comparison->comp_type_ == ComparisonType::NotEqual) {
+        continue;
+      }
+      // col op constant, or constant op col
+      ComparisonType comp_type = comparison->comp_type_;
+      const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0).get());
+      const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1).get());
+      if (column == nullptr || constant == nullptr) {
+        column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1).get());
+        constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0).get());
+        comp_type = FlipComparison(comp_type);
+      }
+      if (column == nullptr || constant == nullptr ||
+          table_info->schema_.GetColumn(column->GetColIdx()).GetName() != key_columns[0].GetName()) {
+        continue;
+      }
+      // The key is compared as the column's type, which must hold every value of the constant's type.
+      const Value &value = constant->val_;
+      if (value.IsNull() || !IsIntegerType(value.GetTypeId()) || value.GetTypeId() > key_type) {
+        continue;
+      }
+      const Value key = value.CastAs(key_type);
+
+      switch (comp_type) {
+        case ComparisonType::Equal:
+          Tighten(&lower, {key, true}, true);
+          Tighten(&upper, {key, true}, false);
+          break;
+        case ComparisonType::GreaterThan:
+        case ComparisonType::GreaterThanOrEqual:
+          Tighten(&lower, {key, comp_type == ComparisonType::GreaterThanOrEqual}, true);
+          break;
+        case ComparisonType::LessThan:
+        case ComparisonType::LessThanOrEqual:
+          Tighten(&upper, {key, comp_type == ComparisonType::LessThanOrEqual}, false);
+          break;
+        default:
+          break;
+      }
+    }
+
+    if (lower.has_value() || upper.has_value()) {
+      std::optional<Value> lower_key;
+      std::optional<Value> upper_key;
+      if (lower.has_value()) {
+        lower_key = lower->key_;
+      }
+      if (upper.has_value()) {
+        upper_key = upper->key_;
+      }
+      return std::make_shared<IndexScanPlanNode>(filter_plan.output_schema_, index->index_oid_,
+                                                 filter_plan.GetPredicate(), std::move(lower_key),
+                                                 !lower.has_value() || lower->inclusive_, std::move(upper_key),
+                                                 !upper.has_value() || upper->inclusive_);
+    }
+  }
+
+  return optimized_plan;
+}
+
+}  // namespace bustub
@@ -10,13 +10,21 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -26,11 +34,16 @@ namespace bustub {
 
 static char *buffer_used;
 
+/** Bounce buffer for direct I/O on page buffers that are not aligned to a disk block. */
+struct alignas(BUSTUB_PAGE_SIZE) AlignedPage {
+  char data_[BUSTUB_PAGE_SIZE];
+};
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io) : file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -38,6 +51,14 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
+  // The free-page map of a database that is created here describes nothing yet, so any old map file is cleared.
+  bool db_exists = GetFileSize(db_file) >= 0;
+  fsm_fd_ = open((file_name_.substr(0, n) + ".fsm").c_str(), O_RDWR | O_CREAT | (db_exists ? 0 : O_TRUNC),  // NOLINT
+                 0644);
+  if (fsm_fd_ < 0) {
+    throw Exception("can't open free-page map file");
+  }
+
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
   if (!log_io_.is_open()) {
@@ -49,77 +70,309 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);  // NOLINT
+    direct_io_ = db_fd_ >= 0;
+    if (db_fd_ < 0 && errno == EINVAL) {
+      // e.g. tmpfs: keep the positional I/O, just without bypassing the page cache
+      LOG_WARN("file system does not support O_DIRECT, falling back to buffered I/O");
     }
   }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);  // NOLINT
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+  if (fsm_fd_ >= 0) {
+    close(fsm_fd_);
+  }
+  RemoveSegmentFiles();
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+  {
+    std::scoped_lock scoped_free_map_latch(free_map_latch_);
+    if (fsm_fd_ >= 0) {
+      close(fsm_fd_);
+      fsm_fd_ = -1;
+    }
+  }
   {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    std::unique_lock<std::shared_mutex> lock(segment_latch_);
+    RemoveSegmentFiles();
   }
   log_io_.close();
 }
 
+void DiskManager::RemoveSegmentFiles() {
+  for (auto &[segment, file] : segments_) {
+    close(file.fd_);
+    if (unlink(file.file_name_.c_str()) != 0) {
+      LOG_DEBUG("can't unlink segment file %s", file.file_name_.c_str());
+    }
+  }
+  segments_.clear();
+}
+
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
+  auto segment_lock = LockSegmentOf(page_id);
+  off_t offset;
+  const int fd = LocatePage(page_id, &offset);
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  thread_local AlignedPage bounce;
+  if (direct_io_ && reinterpret_cast<uintptr_t>(page_data) % BUSTUB_PAGE_SIZE != 0) {
+    memcpy(bounce.data_, page_data, BUSTUB_PAGE_SIZE);
+    page_data = bounce.data_;
+  }
+  if (pwrite(fd, page_data, BUSTUB_PAGE_SIZE, offset) != BUSTUB_PAGE_SIZE) {
     LOG_DEBUG("I/O error while writing");
+  }
+}
+
+/**
+ * Write a run of consecutive pages: one pwritev per IOV_MAX pages
+ */
+void DiskManager::WritePages(page_id_t page_id, const std::vector<const char *> &pages) {
+  // The pages of a run are consecutive in a file only within one segment.
+  const auto num_pages = static_cast<page_id_t>(pages.size());
+  if (num_pages > 0 && SegmentOf(page_id) != SegmentOf(page_id + num_pages - 1)) {
+    const auto split = static_cast<size_t>(MakeSegmentPageId(SegmentOf(page_id) + 1, 0) - page_id);
+    WritePages(page_id, {pages.begin(), pages.begin() + split});
+    WritePages(page_id + static_cast<page_id_t>(split), {pages.begin() + split, pages.end()});
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  auto segment_lock = LockSegmentOf(page_id);
+  off_t start;
+  const int fd = LocatePage(page_id, &start);
+  bool aligned = std::all_of(pages.begin(), pages.end(), [](const char *page_data) {
+    return reinterpret_cast<uintptr_t>(page_data) % BUSTUB_PAGE_SIZE == 0;
+  });
+  if (fd >= 0 && (aligned || !direct_io_)) {
+    num_writes_ += pages.size();
+    std::vector<iovec> iov(pages.size());
+    for (size_t i = 0; i < pages.size(); i++) {
+      iov[i].iov_base = const_cast<char *>(pages[i]);  // NOLINT
+      iov[i].iov_len = BUSTUB_PAGE_SIZE;
+    }
+    for (size_t i = 0; i < iov.size(); i += IOV_MAX) {
+      auto count = static_cast<int>(std::min<size_t>(IOV_MAX, iov.size() - i));
+      auto offset = start + static_cast<off_t>(i) * BUSTUB_PAGE_SIZE;
+      if (pwritev(fd, &iov[i], count, offset) != static_cast<ssize_t>(count) * BUSTUB_PAGE_SIZE) {
+        LOG_DEBUG("I/O error while writing");
+      }
+    }
+    return;
+  }
+  // No file of our own (e.g. an in-memory disk manager), or unaligned pages with O_DIRECT: one page at a time.
+  segment_lock = {};
+  for (size_t i = 0; i < pages.size(); i++) {
+    WritePage(page_id + static_cast<page_id_t>(i), pages[i]);
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
+  auto segment_lock = LockSegmentOf(page_id);
+  off_t offset;
+  const int fd = LocatePage(page_id, &offset);
+  thread_local AlignedPage bounce;
+  char *buffer = page_data;
+  if (direct_io_ && reinterpret_cast<uintptr_t>(page_data) % BUSTUB_PAGE_SIZE != 0) {
+    buffer = bounce.data_;
+  }
+  // a page of a segment that has no file reads as zeroes, like a page past the end of a file
+  ssize_t read_count =
+      fd < 0 && SegmentOf(page_id) != DEFAULT_SEGMENT_ID ? 0 : pread(fd, buffer, BUSTUB_PAGE_SIZE, offset);
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  // a page past the end of the file reads as zeroes
+  memset(buffer + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, BUSTUB_PAGE_SIZE);
+  }
+}
+
+/**
+ * Sync the db file, sharing each fdatasync among the callers that arrived while the previous one was running
+ */
+void DiskManager::SyncPages() {
+  std::unique_lock<std::mutex> lock(sync_latch_);
+  // Only a sync that starts after this point is sure to cover the writes that completed before the call.
+  const uint64_t target = syncs_started_ + 1;
+  sync_cv_.wait(lock, [&] { return !syncing_ || syncs_done_ >= target; });
+  if (syncs_done_ >= target) {
+    return;
+  }
+  syncing_ = true;
+  const uint64_t sync = ++syncs_started_;
+  lock.unlock();
+  // The free-page map goes with the pages: a page allocated on disk must not read back as free after a crash.
+  std::shared_lock<std::shared_mutex> segment_lock(segment_latch_);
+  std::vector<int> fds{db_fd_, fsm_fd_};
+  for (auto &[segment, file] : segments_) {
+    fds.push_back(file.fd_);
+  }
+  for (int fd : fds) {
+    if (fd >= 0) {
+      if (fdatasync(fd) != 0) {
+        LOG_DEBUG("I/O error while syncing");
+      }
+      num_syncs_ += 1;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  }
+  segment_lock.unlock();
+  lock.lock();
+  syncs_done_ = sync;
+  syncing_ = false;
+  sync_cv_.notify_all();
+}
+
+/**
+ * Pass the hint on to the page cache with posix_fadvise
+ */
+void DiskManager::AdvisePages(page_id_t page_id, size_t num_pages, DiskAccessHint hint) {
+  if (direct_io_ || page_id < 0) {
+    return;
+  }
+  auto segment_lock = LockSegmentOf(page_id);
+  off_t offset;
+  const int fd = LocatePage(page_id, &offset);
+  if (fd < 0) {
+    return;
+  }
+  // The range ends with the segment: the next one is in another file.
+  num_pages = std::min<size_t>(num_pages, SegmentPages(SegmentOf(page_id)) - SegmentPageNumber(page_id));
+  int advice = POSIX_FADV_NORMAL;
+  if (hint == DiskAccessHint::Sequential) {
+    advice = POSIX_FADV_SEQUENTIAL;
+  } else if (hint == DiskAccessHint::WillNeed) {
+    advice = POSIX_FADV_WILLNEED;
+  }
+  posix_fadvise(fd, offset, static_cast<off_t>(num_pages * BUSTUB_PAGE_SIZE), advice);
+}
+
+void DiskManager::CreateSegment(segment_id_t segment, const std::string &directory) {
+  if (segment <= DEFAULT_SEGMENT_ID || segment > MAX_SEGMENT_ID) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "invalid segment id " + std::to_string(segment));
+  }
+  if (file_name_.empty()) {
+    return;
+  }
+  std::string file_name = file_name_ + "." + std::to_string(segment);
+  if (!directory.empty()) {
+    const auto slash = file_name.rfind('/');
+    file_name = directory + "/" + (slash == std::string::npos ? file_name : file_name.substr(slash + 1));
+  }
+  std::unique_lock<std::shared_mutex> lock(segment_latch_);
+  if (auto old = segments_.find(segment); old != segments_.end()) {
+    close(old->second.fd_);
+    segments_.erase(old);
+  }
+  int fd = -1;
+  if (direct_io_) {
+    fd = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_DIRECT, 0644);  // NOLINT
+  }
+  if (fd < 0) {
+    fd = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);  // NOLINT
+  }
+  if (fd < 0) {
+    throw Exception("can't create segment file " + file_name);
+  }
+  segments_.emplace(segment, SegmentFile{fd, std::move(file_name)});
+}
+
+void DiskManager::DropSegment(segment_id_t segment) {
+  if (segment == DEFAULT_SEGMENT_ID) {
+    throw Exception("the default segment can't be dropped");
+  }
+  std::unique_lock<std::shared_mutex> lock(segment_latch_);
+  auto it = segments_.find(segment);
+  if (it == segments_.end()) {
+    return;
+  }
+  close(it->second.fd_);
+  if (unlink(it->second.file_name_.c_str()) != 0) {
+    LOG_DEBUG("can't unlink segment file %s", it->second.file_name_.c_str());
+  }
+  segments_.erase(it);
+}
+
+auto DiskManager::GetSegmentFileName(segment_id_t segment) -> std::string {
+  std::shared_lock<std::shared_mutex> lock(segment_latch_);
+  auto it = segments_.find(segment);
+  return it == segments_.end() ? "" : it->second.file_name_;
+}
+
+auto DiskManager::GetPageFile(page_id_t page_id, off_t *offset) -> int {
+  auto segment_lock = LockSegmentOf(page_id);
+  return LocatePage(page_id, offset);
+}
+
+auto DiskManager::LocatePage(page_id_t page_id, off_t *offset) -> int {
+  const segment_id_t segment = SegmentOf(page_id);
+  if (segment == DEFAULT_SEGMENT_ID) {
+    *offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+    return db_fd_;
+  }
+  *offset = static_cast<off_t>(SegmentPageNumber(page_id)) * BUSTUB_PAGE_SIZE;
+  auto it = segments_.find(segment);
+  return it == segments_.end() ? -1 : it->second.fd_;
+}
+
+auto DiskManager::LockSegmentOf(page_id_t page_id) -> std::shared_lock<std::shared_mutex> {
+  if (SegmentOf(page_id) == DEFAULT_SEGMENT_ID) {
+    return {};
+  }
+  return std::shared_lock<std::shared_mutex>(segment_latch_);
+}
+
+void DiskManager::WriteFreeMapPage(size_t index, const char *data) {
+  std::scoped_lock scoped_free_map_latch(free_map_latch_);
+  if (file_name_.empty()) {
+    free_map_pages_[index].assign(data, data + BUSTUB_PAGE_SIZE);
+    return;
+  }
+  // a map written after ShutDown() is dropped, like the pages that are still in the buffer pool
+  if (fsm_fd_ >= 0 &&
+      pwrite(fsm_fd_, data, BUSTUB_PAGE_SIZE, static_cast<off_t>(index * BUSTUB_PAGE_SIZE)) != BUSTUB_PAGE_SIZE) {
+    LOG_DEBUG("I/O error while writing free-page map");
+  }
+}
+
+auto DiskManager::ReadFreeMapPage(size_t index, char *data) -> bool {
+  std::scoped_lock scoped_free_map_latch(free_map_latch_);
+  if (file_name_.empty()) {
+    auto it = free_map_pages_.find(index);
+    if (it == free_map_pages_.end()) {
+      return false;
     }
+    memcpy(data, it->second.data(), BUSTUB_PAGE_SIZE);
+    return true;
   }
+  return fsm_fd_ >= 0 &&
+         pread(fsm_fd_, data, BUSTUB_PAGE_SIZE, static_cast<off_t>(index * BUSTUB_PAGE_SIZE)) == BUSTUB_PAGE_SIZE;
 }
 
 /**
@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+static constexpr size_t EXTENT_BYTES = DiskManagerMmap::EXTENT_PAGES * BUSTUB_PAGE_SIZE;
+
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file) : DiskManager(db_file, false) {
+  if (db_fd_ < 0) {
+    return;
+  }
+  // Map what an existing database already holds, without changing its size: the file only grows when a page past
+  // its end is written.
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0 && stat_buf.st_size > 0) {
+    const auto file_pages = static_cast<size_t>((stat_buf.st_size + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE);
+    std::lock_guard<std::mutex> lock(grow_latch_);
+    MapExtentsUpTo(static_cast<page_id_t>(file_pages - 1));
+    file_pages_.store(file_pages, std::memory_order_release);
+  }
+}
+
+DiskManagerMmap::~DiskManagerMmap() {
+  for (size_t i = 0; i < num_extents_.load(); i++) {
+    munmap(extents_[i].load(), EXTENT_BYTES);
+  }
+}
+
+auto DiskManagerMmap::MappedPage(page_id_t page_id) -> char * {
+  // file_pages_ is published after the extents that cover it.
+  if (page_id < 0 || static_cast<size_t>(page_id) >= file_pages_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  const size_t extent = static_cast<size_t>(page_id) / EXTENT_PAGES;
+  return extents_[extent].load(std::memory_order_relaxed) +
+         (static_cast<size_t>(page_id) % EXTENT_PAGES) * BUSTUB_PAGE_SIZE;
+}
+
+void DiskManagerMmap::ExtendFileTo(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(grow_latch_);
+  if (static_cast<size_t>(page_id) < file_pages_.load()) {
+    return;
+  }
+  MapExtentsUpTo(page_id);
+  // Touching a mapped page past the end of the file would raise SIGBUS, so the file is extended before the page is
+  // published: to the end of its extent, so that the file grows an extent at a time.
+  const size_t file_pages = (static_cast<size_t>(page_id) / EXTENT_PAGES + 1) * EXTENT_PAGES;
+  struct stat stat_buf;
+  const auto file_end = static_cast<off_t>(file_pages * BUSTUB_PAGE_SIZE);
+  if (fstat(db_fd_, &stat_buf) != 0 || (stat_buf.st_size < file_end && ftruncate(db_fd_, file_end) != 0)) {
+    throw Exception("can't extend db file");
+  }
+  file_pages_.store(file_pages, std::memory_order_release);
+}
+
+void DiskManagerMmap::MapExtentsUpTo(page_id_t page_id) {
+  const size_t last = static_cast<size_t>(page_id) / EXTENT_PAGES;
+  if (last >= MAX_EXTENTS) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "page " + std::to_string(page_id) + " is past the mappable file");
+  }
+  for (size_t extent = num_extents_.load(); extent <= last; extent++) {
+    // A mapping may reach past the end of the file; only touching the pages there would fault.
+    void *mapping = mmap(nullptr, EXTENT_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, db_fd_,
+                         static_cast<off_t>(extent * EXTENT_BYTES));
+    if (mapping == MAP_FAILED) {
+      throw Exception("can't map db file");
+    }
+    extents_[extent].store(static_cast<char *>(mapping), std::memory_order_relaxed);
+    num_extents_.store(extent + 1, std::memory_order_release);
+  }
+}
+
+/**
+ * Copy the page into the mapping, extending the file first if needed
+ */
+void DiskManagerMmap::WritePage(page_id_t page_id, const char *page_data) {
+  if (SegmentOf(page_id) != DEFAULT_SEGMENT_ID) {
+    DiskManager::WritePage(page_id, page_data);
+    return;
+  }
+  // a page written after ShutDown() is dropped, as by DiskManager
+  if (db_fd_ < 0) {
+    return;
+  }
+  char *page = MappedPage(page_id);
+  if (page == nullptr) {
+    ExtendFileTo(page_id);
+    page = MappedPage(page_id);
+  }
+  num_writes_ += 1;
+  memcpy(page, page_data, BUSTUB_PAGE_SIZE);
+}
+
+void DiskManagerMmap::WritePages(page_id_t page_id, const std::vector<const char *> &pages) {
+  if (SegmentOf(page_id) != DEFAULT_SEGMENT_ID) {
+    DiskManager::WritePages(page_id, pages);
+    return;
+  }
+  for (size_t i = 0; i < pages.size(); i++) {
+    WritePage(page_id + static_cast<page_id_t>(i), pages[i]);
+  }
+}
+
+/**
+ * Copy the page out of the mapping
+ */
+void DiskManagerMmap::ReadPage(page_id_t page_id, char *page_data) {
+  if (SegmentOf(page_id) != DEFAULT_SEGMENT_ID) {
+    DiskManager::ReadPage(page_id, page_data);
+    return;
+  }
+  const char *page = MappedPage(page_id);
+  if (page == nullptr) {
+    // a page past the end of the file reads as zeroes
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  memcpy(page_data, page, BUSTUB_PAGE_SIZE);
+}
+
+void DiskManagerMmap::AdvisePages(page_id_t page_id, size_t num_pages, DiskAccessHint hint) {
+  if (SegmentOf(page_id) != DEFAULT_SEGMENT_ID) {
+    DiskManager::AdvisePages(page_id, num_pages, hint);
+    return;
+  }
+  int advice = MADV_NORMAL;
+  if (hint == DiskAccessHint::Sequential) {
+    advice = MADV_SEQUENTIAL;
+  } else if (hint == DiskAccessHint::WillNeed) {
+    advice = MADV_WILLNEED;
+  }
+  // One call per extent, as the extents are not contiguous in memory.
+  const size_t end =
+      std::min(static_cast<size_t>(std::max(page_id, 0)) + num_pages, file_pages_.load(std::memory_order_acquire));
+  for (auto first = static_cast<size_t>(std::max(page_id, 0)); first < end;) {
+    const size_t extent_end = std::min(end, (first / EXTENT_PAGES + 1) * EXTENT_PAGES);
+    if (madvise(MappedPage(static_cast<page_id_t>(first)), (extent_end - first) * BUSTUB_PAGE_SIZE, advice) != 0) {
+      LOG_DEBUG("madvise failed: %s", strerror(errno));
+    }
+    first = extent_end;
+  }
+}
+
+}  // namespace bustub
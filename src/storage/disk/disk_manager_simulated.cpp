@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_simulated.cpp
+//
+// Identification: src/storage/disk/disk_manager_simulated.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_simulated.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+
+#include "common/exception.h"
+#include "common/util/string_util.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+auto DeviceProfile::Parse(const std::string &spec) -> DeviceProfile {
+  using std::chrono::microseconds;
+  auto parts = StringUtil::Split(spec, ',');
+  const std::string preset = parts.empty() ? "" : StringUtil::Lower(parts[0]);
+  DeviceProfile profile;
+  if (preset == "nvme") {
+    profile.random_read_latency_ = microseconds(80);
+    profile.random_write_latency_ = microseconds(20);
+    profile.channels_ = 32;
+    profile.bandwidth_mb_per_sec_ = 3000;
+  } else if (preset == "ssd") {
+    profile.random_read_latency_ = microseconds(120);
+    profile.random_write_latency_ = microseconds(60);
+    profile.channels_ = 8;
+    profile.bandwidth_mb_per_sec_ = 500;
+  } else if (preset == "hdd") {
+    profile.random_read_latency_ = microseconds(8000);
+    profile.random_write_latency_ = microseconds(8000);
+    profile.sequential_read_latency_ = microseconds(50);
+    profile.sequential_write_latency_ = microseconds(50);
+    profile.channels_ = 1;
+    profile.bandwidth_mb_per_sec_ = 150;
+  } else if (preset != "none") {
+    throw Exception(fmt::format("invalid device profile '{}': the presets are nvme, ssd, hdd and none", spec));
+  }
+  bool seq_read_given = false;
+  bool seq_write_given = false;
+  for (size_t i = 1; i < parts.size(); i++) {
+    auto key_value = StringUtil::Split(parts[i], '=');
+    if (key_value.size() != 2) {
+      throw Exception(fmt::format("invalid device profile '{}': expected key=value, got '{}'", spec, parts[i]));
+    }
+    const auto key = StringUtil::Lower(key_value[0]);
+    double value;
+    try {
+      value = std::stod(key_value[1]);
+    } catch (std::exception &e) {
+      throw Exception(fmt::format("invalid device profile '{}': '{}' is not a number", spec, key_value[1]));
+    }
+    if (value < 0) {
+      throw Exception(fmt::format("invalid device profile '{}': '{}' is negative", spec, key_value[1]));
+    }
+    const auto us = microseconds(static_cast<int64_t>(value));
+    if (key == "read_us") {
+      profile.random_read_latency_ = us;
+    } else if (key == "write_us") {
+      profile.random_write_latency_ = us;
+    } else if (key == "seq_read_us") {
+      profile.sequential_read_latency_ = us;
+      seq_read_given = true;
+    } else if (key == "seq_write_us") {
+      profile.sequential_write_latency_ = us;
+      seq_write_given = true;
+    } else if (key == "channels") {
+      profile.channels_ = std::max<size_t>(1, static_cast<size_t>(value));
+    } else if (key == "bandwidth_mb") {
+      profile.bandwidth_mb_per_sec_ = value;
+    } else {
+      throw Exception(fmt::format("invalid device profile '{}': unknown key '{}'", spec, key));
+    }
+  }
+  // The sequential latencies follow the random ones, overridden or not, unless they were given.
+  if (preset != "hdd") {
+    if (!seq_read_given) {
+      profile.sequential_read_latency_ = profile.random_read_latency_;
+    }
+    if (!seq_write_given) {
+      profile.sequential_write_latency_ = profile.random_write_latency_;
+    }
+  }
+  return profile;
+}
+
+auto DeviceProfile::ToString() const -> std::string {
+  return fmt::format("none,read_us={},write_us={},seq_read_us={},seq_write_us={},channels={},bandwidth_mb={}",
+                     random_read_latency_.count(), random_write_latency_.count(), sequential_read_latency_.count(),
+                     sequential_write_latency_.count(), channels_, bandwidth_mb_per_sec_);
+}
+
+DiskManagerSimulated::DiskManagerSimulated(const DeviceProfile &profile)
+    : profile_(profile), channel_free_at_(std::max<size_t>(1, profile.channels_)) {
+  if (profile_.bandwidth_mb_per_sec_ > 0) {
+    // 1 MB/s moves one byte per microsecond
+    transfer_time_ = std::chrono::nanoseconds(
+        static_cast<int64_t>(static_cast<double>(BUSTUB_PAGE_SIZE) * 1000 / profile_.bandwidth_mb_per_sec_));
+  }
+}
+
+void DiskManagerSimulated::Access(page_id_t page_id, bool is_write) {
+  const auto now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point done;
+  std::chrono::nanoseconds queueing{0};
+  {
+    std::lock_guard<std::mutex> lock(device_latch_);
+    const bool sequential = last_page_id_ != INVALID_PAGE_ID && page_id == last_page_id_ + 1;
+    last_page_id_ = page_id;
+    if (sequential) {
+      num_sequential_ += 1;
+    }
+    std::chrono::microseconds service;
+    if (is_write) {
+      service = sequential ? profile_.sequential_write_latency_ : profile_.random_write_latency_;
+    } else {
+      service = sequential ? profile_.sequential_read_latency_ : profile_.random_read_latency_;
+    }
+
+    auto channel = std::min_element(channel_free_at_.begin(), channel_free_at_.end());
+    const auto start = std::max(now, *channel);
+    done = start + service;
+    queueing += start - now;
+    if (transfer_time_.count() > 0) {
+      const auto transfer_start = std::max(done, bus_free_at_);
+      queueing += transfer_start - done;
+      done = transfer_start + transfer_time_;
+      bus_free_at_ = done;
+    }
+    *channel = done;
+  }
+  queueing_ns_ += queueing.count();
+  std::this_thread::sleep_until(done);
+}
+
+void DiskManagerSimulated::WritePage(page_id_t page_id, const char *page_data) {
+  Access(page_id, true);
+  DiskManagerUnlimitedMemory::WritePage(page_id, page_data);
+}
+
+void DiskManagerSimulated::ReadPage(page_id_t page_id, char *page_data) {
+  Access(page_id, false);
+  DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+}
+
+}  // namespace bustub
@@ -11,31 +11,423 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/disk/disk_scheduler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
 #include "common/exception.h"
+#include "common/logger.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
-DiskScheduler::DiskScheduler(DiskManager *disk_manager) : disk_manager_(disk_manager) {
-  // TODO(P1): remove this line after you have implemented the disk scheduler API
-  throw NotImplementedException(
-      "DiskScheduler is not implemented yet. If you have finished implementing the disk scheduler, please remove the "
-      "throw exception line in `disk_scheduler.cpp`.");
+auto DiskSchedulerBackendName(DiskSchedulerBackend backend) -> std::string {
+  switch (backend) {
+    case DiskSchedulerBackend::Serial:
+      return "serial";
+    case DiskSchedulerBackend::IoUring:
+      return "io_uring";
+    case DiskSchedulerBackend::ThreadPool:
+      return "thread_pool";
+  }
+  return "unknown";
+}
 
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, const DiskSchedulerOptions &options)
+    : disk_manager_(disk_manager),
+      backend_(options.backend_),
+      queue_depth_(std::max<size_t>(1, options.queue_depth_)),
+      max_queue_wait_(options.max_queue_wait_) {
+  if (backend_ == DiskSchedulerBackend::IoUring) {
+    // io_uring issues page I/O on the files of the disk manager, see GetPageFile().
+    const int fd = disk_manager_->GetFileDescriptor();
+    if (fd >= 0) {
+      ring_ = std::make_unique<IoUring>(static_cast<unsigned>(queue_depth_));
+    }
+    if (ring_ == nullptr || !ring_->IsValid()) {
+      if (fd >= 0) {
+        LOG_WARN("io_uring is not available, falling back to a thread pool");
+      }
+      ring_.reset();
+      backend_ = DiskSchedulerBackend::ThreadPool;
+    }
+  }
+  if (backend_ == DiskSchedulerBackend::IoUring) {
+    // The ring may round the depth up; never have more in flight than it can hold.
+    queue_depth_ = std::min<size_t>(queue_depth_, ring_->Entries());
+    workers_.emplace_back([&] { RunCompleter(); });
+  } else if (backend_ == DiskSchedulerBackend::ThreadPool) {
+    StartThreadPool();
+  }
   // Spawn the background thread
   background_thread_.emplace([&] { StartWorkerThread(); });
 }
 
 DiskScheduler::~DiskScheduler() {
-  // Put a `std::nullopt` in the queue to signal to exit the loop
-  request_queue_.Put(std::nullopt);
+  // Signal the background thread to exit once it has issued everything queued
+  {
+    std::lock_guard<std::mutex> lock(queue_latch_);
+    stopping_ = true;
+  }
+  queue_cv_.notify_all();
   if (background_thread_.has_value()) {
     background_thread_->join();
   }
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest r) {
+  std::unique_lock<std::mutex> lock(queue_latch_);
+  auto &stats = stats_.queues_[static_cast<size_t>(r.priority_)];
+  stats.scheduled_++;
+  auto &page_requests = queued_pages_[r.page_id_];
+  if (r.is_write_ && !page_requests.empty() && page_requests.back().second->request_.is_write_) {
+    // Nothing reads the page between the two writes, so only the newer data has to reach the disk.
+    auto [priority, queued] = page_requests.back();
+    DiskRequest &write = queued->request_;
+    write.data_ = r.data_;
+    auto merged = std::make_shared<DiskRequest>(std::move(r));
+    write.on_complete_ = [earlier = std::move(write.on_complete_), merged](bool ok) {
+      if (earlier) {
+        earlier(ok);
+      }
+      merged->callback_.set_value(ok);
+      if (merged->on_complete_) {
+        merged->on_complete_(ok);
+      }
+    };
+    stats.merged_++;
+    // The merged write is as urgent as the more urgent of the two.
+    if (merged->priority_ < priority) {
+      auto &to = queues_[static_cast<size_t>(merged->priority_)];
+      to.splice(to.end(), queues_[static_cast<size_t>(priority)], queued);
+      stats_.queues_[static_cast<size_t>(priority)].depth_--;
+      stats.depth_++;
+      stats.max_depth_ = std::max(stats.max_depth_, stats.depth_);
+      write.priority_ = merged->priority_;
+      page_requests.back().first = merged->priority_;
+    }
+    return;
+  }
+  auto &queue = queues_[static_cast<size_t>(r.priority_)];
+  auto priority = r.priority_;
+  queue.push_back({std::move(r), std::chrono::steady_clock::now()});
+  page_requests.emplace_back(priority, std::prev(queue.end()));
+  stats.depth_++;
+  stats.max_depth_ = std::max(stats.max_depth_, stats.depth_);
+  lock.unlock();
+  queue_cv_.notify_one();
+}
+
+void DiskScheduler::Expedite(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(queue_latch_);
+  auto page_requests = queued_pages_.find(page_id);
+  if (page_requests == queued_pages_.end()) {
+    return;
+  }
+  auto &foreground = queues_[static_cast<size_t>(DiskRequestPriority::Foreground)];
+  for (auto &[priority, queued] : page_requests->second) {
+    if (priority == DiskRequestPriority::Foreground) {
+      continue;
+    }
+    foreground.splice(foreground.end(), queues_[static_cast<size_t>(priority)], queued);
+    stats_.queues_[static_cast<size_t>(priority)].depth_--;
+    auto &stats = stats_.queues_[static_cast<size_t>(DiskRequestPriority::Foreground)];
+    stats.depth_++;
+    stats.max_depth_ = std::max(stats.max_depth_, stats.depth_);
+    stats_.expedited_++;
+    queued->request_.priority_ = DiskRequestPriority::Foreground;
+    priority = DiskRequestPriority::Foreground;
+  }
+}
+
+auto DiskScheduler::GetStats() -> DiskSchedulerStats {
+  DiskSchedulerStats stats;
+  {
+    std::lock_guard<std::mutex> lock(queue_latch_);
+    stats = stats_;
+  }
+  std::lock_guard<std::mutex> lock(in_flight_latch_);
+  stats.in_flight_ = in_flight_;
+  return stats;
+}
+
+auto DiskScheduler::NextRequest(bool wait) -> std::optional<DiskRequest> {
+  auto has_request = [&] {
+    return std::any_of(queues_.begin(), queues_.end(), [](const RequestQueue &queue) { return !queue.empty(); });
+  };
+  std::unique_lock<std::mutex> lock(queue_latch_);
+  if (wait) {
+    queue_cv_.wait(lock, [&] { return stopping_ || has_request(); });
+  }
+  if (!has_request()) {
+    return std::nullopt;
+  }
+
+  // The most urgent queue, unless the head of a less urgent one has waited for too long. Under a backlog every head
+  // has, so a starving queue only gets every other pick: the urgent requests then wait for one request at most.
+  const auto now = std::chrono::steady_clock::now();
+  size_t pick = NUM_DISK_REQUEST_PRIORITIES;
+  bool starved = false;
+  for (size_t i = 0; i < NUM_DISK_REQUEST_PRIORITIES; i++) {
+    if (queues_[i].empty()) {
+      continue;
+    }
+    if (pick == NUM_DISK_REQUEST_PRIORITIES) {
+      pick = i;
+    } else if (!last_pick_starved_ && now - queues_[i].front().enqueued_ > max_queue_wait_) {
+      pick = i;
+      starved = true;
+      stats_.starved_++;
+      break;
+    }
+  }
+  last_pick_starved_ = starved;
+  auto picked = queues_[pick].begin();
+
+  // An earlier request for the same page goes first, whatever its queue.
+  auto page_requests = queued_pages_.find(picked->request_.page_id_);
+  auto [priority, first] = page_requests->second.front();
+  if (first != picked) {
+    pick = static_cast<size_t>(priority);
+    picked = first;
+    stats_.promoted_++;
+  }
+  page_requests->second.pop_front();
+  if (page_requests->second.empty()) {
+    queued_pages_.erase(page_requests);
+  }
+
+  auto &stats = stats_.queues_[pick];
+  auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(now - picked->enqueued_);
+  stats.dequeued_++;
+  stats.depth_--;
+  stats.total_wait_ += waited;
+  stats.max_wait_ = std::max(stats.max_wait_, waited);
+  DiskRequest request = std::move(picked->request_);
+  queues_[pick].erase(picked);
+  return request;
+}
+
+void DiskScheduler::StartWorkerThread() {
+  if (backend_ == DiskSchedulerBackend::Serial) {
+    RunSerial();
+  } else {
+    RunDispatcher();
+  }
+}
+
+void DiskScheduler::RunSerial() {
+  for (auto request = NextRequest(true); request.has_value(); request = NextRequest(true)) {
+    if (request->is_write_) {
+      disk_manager_->WritePage(request->page_id_, request->data_);
+    } else {
+      disk_manager_->ReadPage(request->page_id_, request->data_);
+    }
+    request->callback_.set_value(true);
+    if (request->on_complete_) {
+      request->on_complete_(true);
+    }
+  }
+}
+
+void DiskScheduler::RunDispatcher() {
+  while (true) {
+    // A request leaves its queue only once a slot is free for it, so that a more urgent one scheduled in the meantime
+    // still goes first. Block for one request, then take as many as there are free slots, so that io_uring gets them
+    // in one submission.
+    WaitForSlot();
+    auto request = NextRequest(true);
+    if (!request.has_value()) {
+      break;
+    }
+    while (request.has_value()) {
+      Admit(*request);
+      Issue(std::make_unique<DiskRequest>(std::move(*request)));
+      request.reset();
+      std::unique_lock<std::mutex> lock(in_flight_latch_);
+      if (in_flight_ < queue_depth_) {
+        lock.unlock();
+        request = NextRequest(false);
+      }
+    }
+    if (ring_ != nullptr) {
+      SubmitRing();
+    }
+  }
+
+  // Every request scheduled before the destructor has been issued; let them finish, then stop the other threads.
+  {
+    std::unique_lock<std::mutex> lock(in_flight_latch_);
+    in_flight_cv_.wait(lock, [&] { return in_flight_ == 0; });
+  }
+  if (ring_ != nullptr) {
+    ring_->Prepare(IORING_OP_NOP, -1, nullptr, 0, 0, 0);
+    SubmitRing();
+  }
+  std::lock_guard<std::mutex> lock(pool_latch_);
+  for (size_t i = 0; i < num_pool_workers_; i++) {
+    work_queue_.Put(nullptr);
+  }
+}
+
+void DiskScheduler::WaitForSlot() {
+  // Every request in flight has been submitted at the end of the last batch, so their completions will free a slot.
+  std::unique_lock<std::mutex> lock(in_flight_latch_);
+  in_flight_cv_.wait(lock, [&] { return in_flight_ < queue_depth_; });
+}
+
+void DiskScheduler::Admit(const DiskRequest &request) {
+  std::unique_lock<std::mutex> lock(in_flight_latch_);
+  auto admissible = [&] { return in_flight_ < queue_depth_ && in_flight_pages_.count(request.page_id_) == 0; };
+  if (!admissible()) {
+    // What we are about to wait for may still be queued in the ring.
+    if (ring_ != nullptr) {
+      lock.unlock();
+      SubmitRing();
+      lock.lock();
+    }
+    in_flight_cv_.wait(lock, admissible);
+  }
+  in_flight_++;
+  in_flight_pages_.insert(request.page_id_);
+}
+
+void DiskScheduler::Issue(std::unique_ptr<DiskRequest> request) {
+  if (ring_ != nullptr && ring_failed_.load()) {
+    // The ring broke: the thread pool takes over, started on the first request after that.
+    StartThreadPool();
+  }
+  if (ring_ == nullptr || ring_failed_.load()) {
+    work_queue_.Put(request.release());
+    return;
+  }
+  off_t offset;
+  const int fd = disk_manager_->GetPageFile(request->page_id_, &offset);
+  // O_DIRECT needs aligned buffers. The disk manager bounces an unaligned one; buffer pool frames never are. A page of
+  // a segment without a file is left to the disk manager as well.
+  if (fd < 0 ||
+      (disk_manager_->IsDirectIo() && reinterpret_cast<uintptr_t>(request->data_) % BUSTUB_PAGE_SIZE != 0)) {
+    RunOnDiskManager(std::move(request));
+    return;
+  }
+  const uint8_t opcode = request->is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+  {
+    std::lock_guard<std::mutex> lock(in_flight_latch_);
+    in_ring_.insert(request.get());
+  }
+  // Admit() keeps the requests in flight, submitted or not, within the size of the ring.
+  bool prepared = ring_->Prepare(opcode, fd, request->data_, BUSTUB_PAGE_SIZE, static_cast<uint64_t>(offset),
+                                 reinterpret_cast<uint64_t>(request.get()));
+  BUSTUB_ASSERT(prepared, "io_uring submission queue overflow");
+  request.release();
+}
+
+void DiskScheduler::SubmitRing() {
+  std::vector<uint64_t> rejected;
+  if (ring_->Submit(&rejected)) {
+    return;
+  }
+  ring_failed_ = true;
+  // The requests that the kernel did not take go through the disk manager instead, unless the completer has failed
+  // them already.
+  for (auto user_data : rejected) {
+    auto *request = reinterpret_cast<DiskRequest *>(user_data);  // NOLINT
+    if (request == nullptr || !TakeFromRing(request)) {
+      continue;
+    }
+    StartThreadPool();
+    work_queue_.Put(request);
+  }
+}
+
+auto DiskScheduler::TakeFromRing(DiskRequest *request) -> bool {
+  std::lock_guard<std::mutex> lock(in_flight_latch_);
+  return in_ring_.erase(request) > 0;
+}
+
+void DiskScheduler::StartThreadPool() {
+  std::lock_guard<std::mutex> lock(pool_latch_);
+  for (; num_pool_workers_ < queue_depth_; num_pool_workers_++) {
+    workers_.emplace_back([&] { RunWorker(); });
+  }
+}
+
+void DiskScheduler::RunOnDiskManager(std::unique_ptr<DiskRequest> request) {
+  if (request->is_write_) {
+    disk_manager_->WritePage(request->page_id_, request->data_);
+  } else {
+    disk_manager_->ReadPage(request->page_id_, request->data_);
+  }
+  Complete(std::move(request), true);
 }
 
-void DiskScheduler::Schedule(DiskRequest r) {}
+void DiskScheduler::Complete(std::unique_ptr<DiskRequest> request, bool ok) {
+  const page_id_t page_id = request->page_id_;
+  request->callback_.set_value(ok);
+  if (request->on_complete_) {
+    request->on_complete_(ok);
+  }
+  {
+    std::lock_guard<std::mutex> lock(in_flight_latch_);
+    in_flight_pages_.erase(page_id);
+    in_flight_--;
+  }
+  in_flight_cv_.notify_all();
+}
 
-void DiskScheduler::StartWorkerThread() {}
+void DiskScheduler::RunCompleter() {
+  std::vector<std::pair<uint64_t, int32_t>> completions;
+  while (true) {
+    completions.clear();
+    if (!ring_->WaitCompletions(&completions)) {
+      // The ring broke: its requests, and every one issued from now on, go through the disk manager instead.
+      ring_failed_ = true;
+      std::vector<DiskRequest *> in_ring;
+      {
+        std::lock_guard<std::mutex> lock(in_flight_latch_);
+        in_ring.assign(in_ring_.begin(), in_ring_.end());
+        in_ring_.clear();
+      }
+      if (!in_ring.empty()) {
+        LOG_WARN("io_uring failed, retrying %zu requests on a thread pool", in_ring.size());
+        StartThreadPool();
+      }
+      for (auto *request : in_ring) {
+        work_queue_.Put(request);
+      }
+      return;
+    }
+    for (auto [user_data, result] : completions) {
+      // The dispatcher's wake-up entry, sent once nothing is in flight any more.
+      if (user_data == 0) {
+        return;
+      }
+      auto *completed = reinterpret_cast<DiskRequest *>(user_data);  // NOLINT
+      TakeFromRing(completed);
+      std::unique_ptr<DiskRequest> request(completed);
+      bool ok = result == BUSTUB_PAGE_SIZE;
+      if (!request->is_write_ && result >= 0 && result < BUSTUB_PAGE_SIZE) {
+        // a page past the end of the file reads as zeroes
+        memset(request->data_ + result, 0, BUSTUB_PAGE_SIZE - result);
+        ok = true;
+      }
+      if (!ok) {
+        LOG_DEBUG("I/O error on page %d: %s", request->page_id_, result < 0 ? strerror(-result) : "short write");
+      }
+      Complete(std::move(request), ok);
+    }
+  }
+}
+
+void DiskScheduler::RunWorker() {
+  for (DiskRequest *next = work_queue_.Get(); next != nullptr; next = work_queue_.Get()) {
+    RunOnDiskManager(std::unique_ptr<DiskRequest>(next));
+  }
+}
 
 }  // namespace bustub
@@ -0,0 +1,184 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring.cpp
+//
+// Identification: src/storage/disk/io_uring.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_uring.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+/** @return a pointer `offset` bytes into the mapping at base */
+template <typename T>
+static auto At(void *base, uint32_t offset) -> T * {
+  return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+IoUring::IoUring(unsigned entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (ring_fd < 0) {
+    return;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  // Since 5.4 both rings live in one mapping.
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+  auto map = [ring_fd](size_t size, off_t offset) -> void * {
+    void *ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+    return ring == MAP_FAILED ? nullptr : ring;
+  };
+  sq_ring_ = map(sq_ring_size_, IORING_OFF_SQ_RING);
+  cq_ring_ = single_mmap ? sq_ring_ : map(cq_ring_size_, IORING_OFF_CQ_RING);
+  sqes_ = static_cast<io_uring_sqe *>(map(sqes_size_, IORING_OFF_SQES));
+  if (sq_ring_ == nullptr || cq_ring_ == nullptr || sqes_ == nullptr) {
+    LOG_WARN("cannot map the io_uring queues");
+    Unmap();
+    close(ring_fd);
+    return;
+  }
+
+  // IORING_OP_READ and IORING_OP_WRITE came with 5.6, like the probe. On older kernels the ring opens, but every read
+  // and write would fail with EINVAL.
+  if (!SupportsReadWrite(ring_fd)) {
+    LOG_WARN("io_uring does not support IORING_OP_READ and IORING_OP_WRITE");
+    Unmap();
+    close(ring_fd);
+    return;
+  }
+
+  sq_head_ = At<unsigned>(sq_ring_, params.sq_off.head);
+  sq_tail_ = At<unsigned>(sq_ring_, params.sq_off.tail);
+  sq_mask_ = *At<unsigned>(sq_ring_, params.sq_off.ring_mask);
+  sq_array_ = At<unsigned>(sq_ring_, params.sq_off.array);
+  cq_head_ = At<unsigned>(cq_ring_, params.cq_off.head);
+  cq_tail_ = At<unsigned>(cq_ring_, params.cq_off.tail);
+  cq_mask_ = *At<unsigned>(cq_ring_, params.cq_off.ring_mask);
+  cqes_ = At<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+  sq_entries_ = params.sq_entries;
+  ring_fd_ = ring_fd;
+}
+
+IoUring::~IoUring() {
+  Unmap();
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+auto IoUring::SupportsReadWrite(int ring_fd) -> bool {
+  constexpr unsigned num_ops = 256;
+  std::vector<char> buffer(sizeof(io_uring_probe) + num_ops * sizeof(io_uring_probe_op), 0);
+  auto *probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+  if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, num_ops) < 0) {
+    return false;
+  }
+  auto supported = [probe](unsigned op) {
+    return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+  };
+  return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+}
+
+void IoUring::Unmap() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  cq_ring_ = nullptr;
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+    sq_ring_ = nullptr;
+  }
+}
+
+auto IoUring::Prepare(uint8_t opcode, int fd, void *buffer, uint32_t length, uint64_t offset, uint64_t user_data)
+    -> bool {
+  // Only this thread moves the tail; the kernel moves the head as it consumes entries.
+  const unsigned tail = *sq_tail_;
+  if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+    return false;
+  }
+  const unsigned index = tail & sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buffer);
+  sqe->len = length;
+  sqe->off = offset;
+  sqe->user_data = user_data;
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  to_submit_++;
+  return true;
+}
+
+auto IoUring::Submit(std::vector<uint64_t> *rejected) -> bool {
+  while (to_submit_ > 0) {
+    auto submitted = syscall(__NR_io_uring_enter, ring_fd_, to_submit_, 0, 0, nullptr, 0);
+    if (submitted < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        continue;
+      }
+      LOG_WARN("io_uring_enter failed: %s", strerror(errno));
+      // The kernel took none of the last to_submit_ entries: take them back off the queue.
+      const unsigned tail = *sq_tail_;
+      for (unsigned i = tail - to_submit_; i != tail; i++) {
+        rejected->push_back(sqes_[sq_array_[i & sq_mask_]].user_data);
+      }
+      __atomic_store_n(sq_tail_, tail - to_submit_, __ATOMIC_RELEASE);
+      to_submit_ = 0;
+      return false;
+    }
+    to_submit_ -= static_cast<unsigned>(submitted);
+  }
+  return true;
+}
+
+auto IoUring::WaitCompletions(std::vector<std::pair<uint64_t, int32_t>> *completions) -> bool {
+  while (true) {
+    // Only this thread moves the head; the kernel moves the tail as requests complete.
+    const unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head != tail) {
+      for (unsigned i = head; i != tail; i++) {
+        const io_uring_cqe &cqe = cqes_[i & cq_mask_];
+        completions->emplace_back(cqe.user_data, cqe.res);
+      }
+      __atomic_store_n(cq_head_, tail, __ATOMIC_RELEASE);
+      return true;
+    }
+    if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR &&
+        errno != EAGAIN && errno != EBUSY) {
+      LOG_WARN("io_uring_enter failed: %s", strerror(errno));
+      return false;
+    }
+  }
+}
+
+}  // namespace bustub
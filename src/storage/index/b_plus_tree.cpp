@@ -1,13 +1,25 @@
+#include <algorithm>
+#include <cmath>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/rid.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
+#include "storage/index/key_search.h"
 
 namespace bustub {
 
+/** Keys that are native integers, IntegerKey or IntegerPairKey, and are searched with KeyUpperBound(). */
+template <typename KeyType, typename KeyComparator>
+static constexpr bool IS_INTEGER_KEY = std::is_same_v<KeyComparator, IntegerComparator<KeyType>>;
+
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
                           const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
@@ -16,14 +28,22 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPool
       comparator_(std::move(comparator)),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size),
-      header_page_id_(header_page_id) {
-  WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
+      header_page_id_(header_page_id),
+      segment_(SegmentOf(header_page_id)) {
+  WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_, AccessType::Index);
   auto root_page = guard.AsMut<BPlusTreeHeaderPage>();
   root_page->root_page_id_ = INVALID_PAGE_ID;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::BinaryFind(const LeafPage *leaf_page, const KeyType &key) -> int {
+  if constexpr (IS_INTEGER_KEY<KeyType, KeyComparator>) {
+    // The keys are integers packed together in the page: search them a vector of keys at a time.
+    using NativeType = decltype(key.value_);
+    static_assert(sizeof(KeyType) == sizeof(NativeType));
+    const auto *keys = reinterpret_cast<const NativeType *>(leaf_page->KeyArray());
+    return KeyUpperBound(keys, leaf_page->GetSize(), key.value_) - 1;
+  }
   // std::cout << "binary" << leaf_page << std::endl;
   int l = 0;
   int r = leaf_page->GetSize() - 1;
@@ -43,6 +63,12 @@ auto BPLUSTREE_TYPE::BinaryFind(const LeafPage *leaf_page, const KeyType &key) -
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::BinaryFind(const InternalPage *internal_page, const KeyType &key) -> int {
+  if constexpr (IS_INTEGER_KEY<KeyType, KeyComparator>) {
+    // The first key is invalid: the child is the last key not greater than `key`, counting from 1, or the first.
+    using NativeType = decltype(key.value_);
+    const auto *keys = reinterpret_cast<const NativeType *>(internal_page->KeyArray());
+    return KeyUpperBound(keys + 1, internal_page->GetSize() - 1, key.value_);
+  }
   // if (internal_page == nullptr) return -1;
 
   // if (internal_page->GetSize() == 0) return 0;
@@ -66,11 +92,56 @@ auto BPLUSTREE_TYPE::BinaryFind(const InternalPage *internal_page, const KeyType
   return r;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::OptimisticFindLeaf(const KeyType &key, OptimisticPageGuard *parent, OptimisticPageGuard *leaf)
+    -> bool {
+  leaf->Drop();
+  *parent = bpm_->FetchPageOptimistic(header_page_id_, AccessType::Index);
+  if (!parent->IsValid()) {
+    return false;
+  }
+  page_id_t child_id = parent->As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (!parent->Validate()) {
+    return false;
+  }
+
+  while (child_id != INVALID_PAGE_ID) {
+    auto guard = bpm_->FetchPageOptimistic(child_id, AccessType::Index);
+    // The child is only known to be the right page if its parent has not changed by the time its version was taken.
+    if (!guard.IsValid() || !parent->Validate()) {
+      return false;
+    }
+    auto *page = guard.As<BPlusTreePage>();
+    if (page->IsLeafPage()) {
+      *leaf = guard;
+      return true;
+    }
+    // The page may be torn, so check its size before searching it.
+    auto *internal = reinterpret_cast<const InternalPage *>(page);
+    int size = internal->GetSize();
+    if (size < 1 || static_cast<size_t>(size) > INTERNAL_SLOTS) {
+      return false;
+    }
+    child_id = internal->ValueAt(BinaryFind(internal, key));
+    if (!guard.Validate()) {
+      return false;
+    }
+    *parent = guard;
+  }
+  return true;
+}
+
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
+  if (header_page_id_ == INVALID_PAGE_ID) {
+    return true;
+  }
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_, AccessType::Index);
+  return guard.As<BPlusTreeHeaderPage>()->root_page_id_ == INVALID_PAGE_ID;
+}
 
 /*****************************************************************************
  * SEARCH
@@ -89,7 +160,36 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
     return false;
   }
 
-  auto header_page_guard = bpm_->FetchPageRead(header_page_id_);
+  // Read the whole path without latching, and fall back to latch crabbing if writers keep getting in the way.
+  for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; attempt++) {
+    OptimisticPageGuard parent;
+    OptimisticPageGuard leaf_guard;
+    if (!OptimisticFindLeaf(key, &parent, &leaf_guard)) {
+      continue;
+    }
+    if (!leaf_guard.IsValid()) {
+      return false;
+    }
+    auto *leaf = leaf_guard.As<LeafPage>();
+    int size = leaf->GetSize();
+    if (size < 0 || static_cast<size_t>(size) > LEAF_SLOTS) {
+      continue;
+    }
+    int index = BinaryFind(leaf, key);
+    std::optional<ValueType> value;
+    if (index >= 0 && comparator_(leaf->KeyAt(index), key) == 0) {
+      value = leaf->ValueAt(index);
+    }
+    if (!leaf_guard.Validate()) {
+      continue;
+    }
+    if (value.has_value()) {
+      result->emplace_back(*value);
+    }
+    return value.has_value();
+  }
+
+  auto header_page_guard = bpm_->FetchPageRead(header_page_id_, AccessType::Index);
   auto header_page = header_page_guard.As<BPlusTreeHeaderPage>();
 
   if (header_page->root_page_id_ == INVALID_PAGE_ID) {
@@ -98,7 +198,7 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
     return false;
   }
 
-  auto root_page_guard = bpm_->FetchPageRead(header_page->root_page_id_);
+  auto root_page_guard = bpm_->FetchPageRead(header_page->root_page_id_, AccessType::Index);
   auto root_page = root_page_guard.As<BPlusTreePage>();
   ctx.root_page_id_ = root_page_guard.PageId();
 
@@ -130,7 +230,7 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
 
     page_id_t child_id = internal->ValueAt(index);
 
-    root_page_guard = bpm_->FetchPageRead(child_id);
+    root_page_guard = bpm_->FetchPageRead(child_id, AccessType::Index);
     root_page = root_page_guard.As<BPlusTreePage>();
 
     while (!ctx.read_set_.empty()) {
@@ -176,12 +276,12 @@ auto BPLUSTREE_TYPE::SplitLeaf(LeafPage *leaf, const KeyType &key, const ValueTy
     }
   }
 
-  auto new_leaf_basic_guard = bpm_->NewPageGuarded(new_id);
+  auto new_leaf_basic_guard = bpm_->NewPageGuarded(new_id, segment_);
   auto new_leaf = new_leaf_basic_guard.AsMut<LeafPage>();
   new_leaf_basic_guard.SetDirty(true);
   new_leaf_basic_guard.Drop();
 
-  auto new_leaf_guard = bpm_->FetchPageWrite(*new_id);
+  auto new_leaf_guard = bpm_->FetchPageWrite(*new_id, AccessType::Index);
   new_leaf = new_leaf_guard.AsMut<LeafPage>();
   new_leaf->Init(leaf_max_size_);
 
@@ -253,12 +353,12 @@ auto BPLUSTREE_TYPE::SplitInternal(InternalPage *internal, const KeyType &key, p
     internal->IncreaseSize(-1);
   }
 
-  auto new_internal_basic_guard = bpm_->NewPageGuarded(new_id);
+  auto new_internal_basic_guard = bpm_->NewPageGuarded(new_id, segment_);
   auto new_internal = new_internal_basic_guard.AsMut<InternalPage>();
   new_internal_basic_guard.SetDirty(true);
   new_internal_basic_guard.Drop();
 
-  auto new_internal_guard = bpm_->FetchPageWrite(*new_id);
+  auto new_internal_guard = bpm_->FetchPageWrite(*new_id, AccessType::Index);
   new_internal = new_internal_guard.AsMut<InternalPage>();
   new_internal->Init(internal_max_size_);
 
@@ -313,87 +413,57 @@ auto BPLUSTREE_TYPE::SplitInternal(InternalPage *internal, const KeyType &key, p
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::OptimalInsert(const KeyType &key, const ValueType &value, Transaction *txn) -> int {
   // 0表示要用悲观insert一次，1表示乐观insert成功，2表示重复key
-  Context ctx;
-
-  auto header_page_guard = bpm_->FetchPageRead(header_page_id_);
-  auto header_page = header_page_guard.As<BPlusTreeHeaderPage>();
-
-  if (header_page->root_page_id_ == INVALID_PAGE_ID) {
-    header_page_guard.SetDirty(false);
-    header_page_guard.Drop();
-    return 0;
-  }
-
-  auto root_page_guard = bpm_->FetchPageRead(header_page->root_page_id_);
-  auto root_page = root_page_guard.As<BPlusTreePage>();
-  ctx.root_page_id_ = root_page_guard.PageId();
-
-  ctx.read_set_.emplace_back(std::move(header_page_guard));
-
-  while (true) {
-    if (root_page->IsLeafPage()) {
-      page_id_t leaf_id = root_page_guard.PageId();
-      // 叶子节点放读锁
-      root_page_guard.SetDirty(false);
-      root_page_guard.Drop();
-
-      // 叶子节点拿写锁
-      auto leaf_guard = bpm_->FetchPageWrite(leaf_id);
-
-      // 叶子节点父节点放读锁
-      while (!ctx.read_set_.empty()) {
-        ctx.read_set_.back().SetDirty(false);
-        ctx.read_set_.back().Drop();
-        ctx.read_set_.pop_back();
-      }
-
-      auto *leaf = leaf_guard.AsMut<LeafPage>();
+  // 内部节点乐观读，不加锁；到了叶节点拿写锁，再检查父节点没有变过
+  for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; attempt++) {
+    OptimisticPageGuard parent;
+    OptimisticPageGuard leaf_ref;
+    if (!OptimisticFindLeaf(key, &parent, &leaf_ref)) {
+      continue;
+    }
+    if (!leaf_ref.IsValid()) {
+      return 0;
+    }
 
-      int index = BinaryFind(leaf, key);
+    // 叶节点拿写锁
+    auto leaf_guard = bpm_->FetchPageWrite(leaf_ref.PageId(), AccessType::Index);
 
-      if (index >= 0 && comparator_(leaf->KeyAt(index), key) == 0) {
-        leaf_guard.SetDirty(false);
-        leaf_guard.Drop();
-        return 2;
-      }
+    // Splits and merges of the leaf all go through its parent, so an unchanged parent means the leaf is still the
+    // right one.
+    if (!parent.Validate()) {
+      leaf_guard.SetDirty(false);
+      leaf_guard.Drop();
+      continue;
+    }
 
-      if (leaf->GetSize() == leaf->GetMaxSize()) {
-        leaf_guard.SetDirty(false);
-        leaf_guard.Drop();
-        return 0;
-      }
+    auto *leaf = leaf_guard.AsMut<LeafPage>();
 
-      for (int i = leaf->GetSize(); i > index + 1; i--) {
-        leaf->SetAt(i, leaf->KeyAt(i - 1), leaf->ValueAt(i - 1));
-      }
-      leaf->SetAt(index + 1, key, value);
-      leaf->IncreaseSize(1);
+    int index = BinaryFind(leaf, key);
 
-      leaf_guard.SetDirty(true);
+    if (index >= 0 && comparator_(leaf->KeyAt(index), key) == 0) {
+      leaf_guard.SetDirty(false);
       leaf_guard.Drop();
-
-      break;
+      return 2;
     }
 
-    while (!ctx.read_set_.empty()) {
-      ctx.read_set_.back().SetDirty(false);
-      ctx.read_set_.back().Drop();
-      ctx.read_set_.pop_back();
+    if (leaf->GetSize() == leaf->GetMaxSize()) {
+      leaf_guard.SetDirty(false);
+      leaf_guard.Drop();
+      return 0;
     }
 
-    auto *internal = reinterpret_cast<const InternalPage *>(root_page);
-
-    int index = BinaryFind(internal, key);
-
-    page_id_t child_id = internal->ValueAt(index);
+    for (int i = leaf->GetSize(); i > index + 1; i--) {
+      leaf->SetAt(i, leaf->KeyAt(i - 1), leaf->ValueAt(i - 1));
+    }
+    leaf->SetAt(index + 1, key, value);
+    leaf->IncreaseSize(1);
 
-    ctx.read_set_.emplace_back(std::move(root_page_guard));
+    leaf_guard.SetDirty(true);
+    leaf_guard.Drop();
 
-    root_page_guard = bpm_->FetchPageRead(child_id);
-    root_page = root_page_guard.As<BPlusTreePage>();
+    return 1;
   }
 
-  return 1;
+  return 0;
 }
 
 /*****************************************************************************
@@ -427,11 +497,11 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     return false;
   }
 
-  ctx.header_page_ = bpm_->FetchPageWrite(header_page_id_);
+  ctx.header_page_ = bpm_->FetchPageWrite(header_page_id_, AccessType::Index);
   auto header_page = ctx.header_page_->AsMut<BPlusTreeHeaderPage>();
 
   if (header_page->root_page_id_ == INVALID_PAGE_ID) {
-    BasicPageGuard root_page_basic_guard = bpm_->NewPageGuarded(&header_page->root_page_id_);
+    BasicPageGuard root_page_basic_guard = bpm_->NewPageGuarded(&header_page->root_page_id_, segment_);
     auto root_page_basic = root_page_basic_guard.AsMut<LeafPage>();
     // auto root_page = reinterpret_cast<LeafPage *>(bpm_->NewPage(&header_page->root_page_id_)->GetData());
     root_page_basic->Init(leaf_max_size_);
@@ -439,7 +509,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     root_page_basic_guard.Drop();
   }
 
-  WritePageGuard root_page_guard = bpm_->FetchPageWrite(header_page->root_page_id_);
+  WritePageGuard root_page_guard = bpm_->FetchPageWrite(header_page->root_page_id_, AccessType::Index);
   auto *root_page = root_page_guard.AsMut<BPlusTreePage>();
   ctx.root_page_id_ = root_page_guard.PageId();
 
@@ -520,13 +590,13 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
           page_id_t old_id = header_page->root_page_id_;
 
           // 新生成根节点
-          auto new_root_page_basic_guard = bpm_->NewPageGuarded(&header_page->root_page_id_);
+          auto new_root_page_basic_guard = bpm_->NewPageGuarded(&header_page->root_page_id_, segment_);
           auto new_root_page = new_root_page_basic_guard.AsMut<InternalPage>();
           ctx.root_page_id_ = new_root_page_basic_guard.PageId();
           new_root_page_basic_guard.SetDirty(true);
           new_root_page_basic_guard.Drop();
 
-          auto new_root_page_guard = bpm_->FetchPageWrite(header_page->root_page_id_);
+          auto new_root_page_guard = bpm_->FetchPageWrite(header_page->root_page_id_, AccessType::Index);
           new_root_page = new_root_page_guard.AsMut<InternalPage>();
           new_root_page->Init(internal_max_size_);
 
@@ -569,7 +639,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 
     page_id_t child_id = internal->ValueAt(index);
 
-    root_page_guard = bpm_->FetchPageWrite(child_id);
+    root_page_guard = bpm_->FetchPageWrite(child_id, AccessType::Index);
     root_page = root_page_guard.AsMut<BPlusTreePage>();
 
     // crabbing，节点安全
@@ -592,6 +662,145 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   return true;
 }
 
+/*
+ * Build the tree bottom-up from entries sorted by key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(const EntrySource &next, double fill_factor) -> bool {
+  if (header_page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  // Nobody can see the tree until the root is set, so the new pages need no latches: only the header is latched.
+  WritePageGuard header_guard = bpm_->FetchPageWrite(header_page_id_, AccessType::Index);
+  auto *header_page = header_guard.AsMut<BPlusTreeHeaderPage>();
+  if (header_page->root_page_id_ != INVALID_PAGE_ID) {
+    header_guard.SetDirty(false);
+    return false;
+  }
+  fill_factor = std::clamp(fill_factor, 0.0, 1.0);
+
+  auto new_page = [this](page_id_t *page_id) -> BasicPageGuard {
+    auto guard = bpm_->NewPageGuarded(page_id, segment_);
+    if (*page_id == INVALID_PAGE_ID) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "bulk load of " + index_name_ + ": no frame for a new page");
+    }
+    return guard;
+  };
+
+  // The first key and the page id of each page of the level built last.
+  std::vector<std::pair<KeyType, page_id_t>> level;
+
+  // Fill the leaves left to right. The last two stay pinned, so that a short last leaf can be evened out with the
+  // leaf before it.
+  const int leaf_min = std::max(1, leaf_max_size_ / 2);
+  const int leaf_fill =
+      std::clamp(static_cast<int>(std::lround(leaf_max_size_ * fill_factor)), std::min(leaf_min, leaf_max_size_),
+                 leaf_max_size_);
+  BasicPageGuard prev_guard;
+  BasicPageGuard leaf_guard;
+  LeafPage *prev = nullptr;
+  LeafPage *leaf = nullptr;
+  KeyType key;
+  ValueType value;
+  while (next(&key, &value)) {
+    if (leaf != nullptr) {
+      int cmp = comparator_(key, leaf->KeyAt(leaf->GetSize() - 1));
+      if (cmp == 0) {
+        continue;
+      }
+      if (cmp < 0) {
+        throw Exception("bulk load of " + index_name_ + ": the entries are not sorted by key");
+      }
+    }
+    if (leaf == nullptr || leaf->GetSize() == leaf_fill) {
+      page_id_t page_id;
+      BasicPageGuard guard = new_page(&page_id);
+      auto *new_leaf = guard.AsMut<LeafPage>();
+      new_leaf->Init(leaf_max_size_);
+      if (leaf != nullptr) {
+        leaf->SetNextPageId(page_id);
+      }
+      prev_guard = std::move(leaf_guard);
+      prev = leaf;
+      leaf_guard = std::move(guard);
+      leaf = new_leaf;
+      level.emplace_back(key, page_id);
+    }
+    leaf->SetAt(leaf->GetSize(), key, value);
+    leaf->IncreaseSize(1);
+  }
+  if (leaf == nullptr) {
+    header_guard.SetDirty(false);
+    return true;
+  }
+
+  if (prev != nullptr && leaf->GetSize() < leaf_min) {
+    const int total = prev->GetSize() + leaf->GetSize();
+    if (total <= leaf_max_size_) {
+      // The last leaf fits into the one before it.
+      for (int i = 0; i < leaf->GetSize(); i++) {
+        prev->SetAt(prev->GetSize(), leaf->KeyAt(i), leaf->ValueAt(i));
+        prev->IncreaseSize(1);
+      }
+      prev->SetNextPageId(INVALID_PAGE_ID);
+      page_id_t last_id = level.back().second;
+      level.pop_back();
+      leaf_guard.Drop();
+      DeletePages({last_id});
+    } else {
+      // Move the tail of the leaf before it over, so that each holds half.
+      const int moved = total / 2 - leaf->GetSize();
+      for (int i = leaf->GetSize() - 1; i >= 0; i--) {
+        leaf->SetAt(i + moved, leaf->KeyAt(i), leaf->ValueAt(i));
+      }
+      for (int i = 0; i < moved; i++) {
+        const int from = prev->GetSize() - moved + i;
+        leaf->SetAt(i, prev->KeyAt(from), prev->ValueAt(from));
+      }
+      prev->IncreaseSize(-moved);
+      leaf->IncreaseSize(moved);
+      level.back().first = leaf->KeyAt(0);
+    }
+  }
+  prev_guard.Drop();
+  leaf_guard.Drop();
+
+  // Build the internal levels over the leaves, spreading the children of a level evenly over its pages.
+  const int internal_min = std::min(internal_max_size_ / 2 + 1, internal_max_size_);
+  const int internal_fill =
+      std::clamp(static_cast<int>(std::lround(internal_max_size_ * fill_factor)), internal_min, internal_max_size_);
+  while (level.size() > 1) {
+    const size_t children = level.size();
+    const auto max_children = static_cast<size_t>(internal_max_size_);
+    const auto min_children = static_cast<size_t>(internal_min);
+    size_t pages = (children + internal_fill - 1) / internal_fill;
+    // Use fewer, fuller pages where an even spread would leave them below the minimum.
+    while (pages > 1 && children / pages < min_children && (children + pages - 2) / (pages - 1) <= max_children) {
+      pages--;
+    }
+
+    std::vector<std::pair<KeyType, page_id_t>> parents;
+    parents.reserve(pages);
+    size_t child = 0;
+    for (size_t i = 0; i < pages; i++) {
+      const size_t count = children / pages + (i < children % pages ? 1 : 0);
+      page_id_t page_id;
+      BasicPageGuard guard = new_page(&page_id);
+      auto *internal = guard.AsMut<InternalPage>();
+      internal->Init(internal_max_size_);
+      parents.emplace_back(level[child].first, page_id);
+      for (size_t j = 0; j < count; j++, child++) {
+        internal->SetAt(static_cast<int>(j), level[child].first, level[child].second);
+      }
+      internal->SetSize(static_cast<int>(count));
+    }
+    level = std::move(parents);
+  }
+
+  header_page->root_page_id_ = level[0].second;
+  return true;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -623,98 +832,60 @@ void BPLUSTREE_TYPE::RemoveResGuardsPop(std::deque<WritePageGuard> &guards, std:
   }
 }
 
-// 乐观remove：一路crabbing读锁，直到叶节点拿写锁，若安全，则直接操作返回true
+// 乐观remove：内部节点乐观读（不加锁），直到叶节点拿写锁，若安全，则直接操作返回true
 // （key的数量大于一半，且删的不是第一个key，如果要删第一个key的话，父节点的key要变）
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::OptimalRemove(const KeyType &key, Transaction *txn) -> bool {
-  Context ctx;
-
-  auto header_page_guard = bpm_->FetchPageRead(header_page_id_);
-  auto header_page = header_page_guard.As<BPlusTreeHeaderPage>();
-
-  // 没有根节点不用删，返回true
-  if (header_page->root_page_id_ == INVALID_PAGE_ID) {
-    header_page_guard.SetDirty(false);
-    header_page_guard.Drop();
-    return true;
-  }
-
-  auto root_page_guard = bpm_->FetchPageRead(header_page->root_page_id_);
-  auto root_page = root_page_guard.As<BPlusTreePage>();
-  ctx.root_page_id_ = root_page_guard.PageId();
-
-  ctx.read_set_.emplace_back(std::move(header_page_guard));
-
-  while (true) {
-    if (root_page->IsLeafPage()) {
-      page_id_t leaf_id = root_page_guard.PageId();
-
-      // 如果是叶节点，先把读锁放掉
-      root_page_guard.SetDirty(false);
-      root_page_guard.Drop();
-
-      // 到了叶节点先拿写锁
-      auto leaf_guard = bpm_->FetchPageWrite(leaf_id);
-
-      // 再把父节点的读锁放掉
-      while (!ctx.read_set_.empty()) {
-        ctx.read_set_.back().SetDirty(false);
-        ctx.read_set_.back().Drop();
-        ctx.read_set_.pop_back();
-      }
-
-      auto *leaf = leaf_guard.AsMut<LeafPage>();
-
-      int index = BinaryFind(leaf, key);
+  for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; attempt++) {
+    OptimisticPageGuard parent;
+    OptimisticPageGuard leaf_ref;
+    if (!OptimisticFindLeaf(key, &parent, &leaf_ref)) {
+      continue;
+    }
+    // 没有根节点不用删，返回true
+    if (!leaf_ref.IsValid()) {
+      return true;
+    }
 
-      // 找不到删除的key，直接返回true
-      if (index < 0 || comparator_(leaf->KeyAt(index), key) != 0) {
-        leaf_guard.SetDirty(false);
-        leaf_guard.Drop();
-        break;
-      }
+    // 到了叶节点先拿写锁，再检查父节点没有变过
+    auto leaf_guard = bpm_->FetchPageWrite(leaf_ref.PageId(), AccessType::Index);
+    if (!parent.Validate()) {
+      leaf_guard.SetDirty(false);
+      leaf_guard.Drop();
+      continue;
+    }
 
-      // 不安全返回false(删的是第一个key也不安全)
-      if (leaf->GetSize() <= leaf->GetMinSize() || index == 0) {
-        leaf_guard.SetDirty(false);
-        leaf_guard.Drop();
-        return false;
-      }
+    auto *leaf = leaf_guard.AsMut<LeafPage>();
 
-      // 安全删完直接返回true
-      for (int i = index; i < leaf->GetSize() - 1; i++) {
-        leaf->SetAt(i, leaf->KeyAt(i + 1), leaf->ValueAt(i + 1));
-      }
-      leaf->IncreaseSize(-1);
+    int index = BinaryFind(leaf, key);
 
-      leaf_guard.SetDirty(true);
+    // 找不到删除的key，直接返回true
+    if (index < 0 || comparator_(leaf->KeyAt(index), key) != 0) {
+      leaf_guard.SetDirty(false);
       leaf_guard.Drop();
-
-      break;
+      return true;
     }
 
-    // 把父节点读锁放掉
-    while (!ctx.read_set_.empty()) {
-      ctx.read_set_.back().SetDirty(false);
-      ctx.read_set_.back().Drop();
-      ctx.read_set_.pop_back();
+    // 不安全返回false(删的是第一个key也不安全)
+    if (leaf->GetSize() <= leaf->GetMinSize() || index == 0) {
+      leaf_guard.SetDirty(false);
+      leaf_guard.Drop();
+      return false;
     }
 
-    auto *internal = reinterpret_cast<const InternalPage *>(root_page);
-
-    int index = BinaryFind(internal, key);
-
-    page_id_t child_id = internal->ValueAt(index);
+    // 安全删完直接返回true
+    for (int i = index; i < leaf->GetSize() - 1; i++) {
+      leaf->SetAt(i, leaf->KeyAt(i + 1), leaf->ValueAt(i + 1));
+    }
+    leaf->IncreaseSize(-1);
 
-    // 将当前锁加入队列
-    ctx.read_set_.emplace_back(std::move(root_page_guard));
+    leaf_guard.SetDirty(true);
+    leaf_guard.Drop();
 
-    // 拿子节点的读锁
-    root_page_guard = bpm_->FetchPageRead(child_id);
-    root_page = root_page_guard.As<BPlusTreePage>();
+    return true;
   }
 
-  return true;
+  return false;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -729,7 +900,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
 
   Context ctx;
 
-  auto header_page_guard = bpm_->FetchPageWrite(header_page_id_);
+  auto header_page_guard = bpm_->FetchPageWrite(header_page_id_, AccessType::Index);
   auto header_page = header_page_guard.AsMut<BPlusTreeHeaderPage>();
 
   if (header_page->root_page_id_ == INVALID_PAGE_ID) {
@@ -741,7 +912,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
   // 记录沿路的key
   std::deque<int> keys_index;
 
-  auto root_page_guard = bpm_->FetchPageWrite(header_page->root_page_id_);
+  auto root_page_guard = bpm_->FetchPageWrite(header_page->root_page_id_, AccessType::Index);
   auto root_page = root_page_guard.AsMut<BPlusTreePage>();
 
   bool header_drop = false;
@@ -817,7 +988,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
       //  看下是否有叶子左兄弟
       if (parent_index > 0) {
         auto left_id = parent_internal->ValueAt(parent_index - 1);
-        auto left_guard = bpm_->FetchPageWrite(left_id);
+        auto left_guard = bpm_->FetchPageWrite(left_id, AccessType::Index);
         auto left_leaf = left_guard.template AsMut<LeafPage>();
 
         // 把左兄弟最后一个借走，放到leaf的第一个位置
@@ -856,7 +1027,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
       // 看下是否有叶子右兄弟
       if (parent_index < parent_internal->GetSize() - 1) {
         auto right_id = parent_internal->ValueAt(parent_index + 1);
-        auto right_guard = bpm_->FetchPageWrite(right_id);
+        auto right_guard = bpm_->FetchPageWrite(right_id, AccessType::Index);
         auto right_leaf = right_guard.template AsMut<LeafPage>();
 
         // 看是否可借
@@ -903,7 +1074,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
       if (parent_index > 0) {
         // printf("融合左叶子\n");
         auto left_id = parent_internal->ValueAt(parent_index - 1);
-        auto left_guard = bpm_->FetchPageWrite(left_id);
+        auto left_guard = bpm_->FetchPageWrite(left_id, AccessType::Index);
         auto left_leaf = left_guard.template AsMut<LeafPage>();
 
         // 将该节点的内容接到左兄弟后面
@@ -923,13 +1094,14 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
         left_guard.SetDirty(true);
         left_guard.Drop();
 
+        ctx.deleted_pages_.push_back(leaf_guard.PageId());
         leaf_guard.SetDirty(false);
         leaf_guard.Drop();
 
       } else {
         // 否则融合右叶子
         auto right_id = parent_internal->ValueAt(parent_index + 1);
-        auto right_guard = bpm_->FetchPageWrite(right_id);
+        auto right_guard = bpm_->FetchPageWrite(right_id, AccessType::Index);
         auto right_leaf = right_guard.template AsMut<LeafPage>();
 
         // 将右叶子的内容加到当前叶子的后面
@@ -947,6 +1119,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
 
         parent_internal->IncreaseSize(-1);
 
+        ctx.deleted_pages_.push_back(right_guard.PageId());
         right_guard.SetDirty(false);
         right_guard.Drop();
 
@@ -974,7 +1147,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
         // 是否有internal左兄弟
         if (parent_index > 0) {
           auto left_id = parent_internal->ValueAt(parent_index - 1);
-          auto left_guard = bpm_->FetchPageWrite(left_id);
+          auto left_guard = bpm_->FetchPageWrite(left_id, AccessType::Index);
           auto left_internal = left_guard.template AsMut<InternalPage>();
 
           if (left_internal->GetSize() - 1 > left_internal->GetMinSize()) {
@@ -1017,7 +1190,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
         // 是否有internal右兄弟
         if (parent_index < parent_internal->GetSize() - 1) {
           auto right_id = parent_internal->ValueAt(parent_index + 1);
-          auto right_guard = bpm_->FetchPageWrite(right_id);
+          auto right_guard = bpm_->FetchPageWrite(right_id, AccessType::Index);
           auto right_internal = right_guard.template AsMut<InternalPage>();
 
           if (right_internal->GetSize() - 1 > right_internal->GetMinSize()) {
@@ -1066,7 +1239,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
         // 和左节点融合
         if (parent_index > 0) {
           auto left_id = parent_internal->ValueAt(parent_index - 1);
-          auto left_guard = bpm_->FetchPageWrite(left_id);
+          auto left_guard = bpm_->FetchPageWrite(left_id, AccessType::Index);
           auto left_internal = left_guard.template AsMut<InternalPage>();
 
           // 先把key接到左节点后面
@@ -1086,6 +1259,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
           }
           parent_internal->IncreaseSize(-1);
 
+          ctx.deleted_pages_.push_back(cur_guard.PageId());
           cur_guard.SetDirty(false);
           cur_guard.Drop();
 
@@ -1098,7 +1272,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
         } else {
           // 和右节点融合
           auto right_id = parent_internal->ValueAt(parent_index + 1);
-          auto right_guard = bpm_->FetchPageWrite(right_id);
+          auto right_guard = bpm_->FetchPageWrite(right_id, AccessType::Index);
           auto right_internal = right_guard.template AsMut<InternalPage>();
 
           // 把index+1的parent_key拉到当前节点后面
@@ -1121,6 +1295,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
           cur_guard.SetDirty(true);
           cur_guard.Drop();
 
+          ctx.deleted_pages_.push_back(right_guard.PageId());
           right_guard.SetDirty(false);
           right_guard.Drop();
 
@@ -1133,6 +1308,8 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
 
       if (parent_internal->GetSize() == 1) {
         header_page->root_page_id_ = parent_internal->ValueAt(0);
+        // 旧的根只剩一个孩子，换根之后也没用了
+        ctx.deleted_pages_.push_back(cur_guard.PageId());
       }
 
       break;
@@ -1143,7 +1320,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
     int index = BinaryFind(internal, key);
     keys_index.emplace_back(index);
 
-    root_page_guard = bpm_->FetchPageWrite(internal->ValueAt(index));
+    root_page_guard = bpm_->FetchPageWrite(internal->ValueAt(index), AccessType::Index);
     root_page = root_page_guard.AsMut<BPlusTreePage>();
 
     // crabbing，若当前节点安全（数量大于一半），则把祖先节点的锁全部放掉
@@ -1163,6 +1340,9 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
     header_page_guard.SetDirty(true);
     header_page_guard.Drop();
   }
+
+  // 合并掉的页面已经从树上摘下来了，还给缓冲池，之后分裂的时候可以重用
+  DeletePages(ctx.deleted_pages_);
 }
 
 /*****************************************************************************
@@ -1177,7 +1357,7 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
   Context ctx;
 
-  auto header_page_guard = bpm_->FetchPageRead(header_page_id_);
+  auto header_page_guard = bpm_->FetchPageRead(header_page_id_, AccessType::Index);
   auto header_page = header_page_guard.As<BPlusTreeHeaderPage>();
 
   if (header_page->root_page_id_ == INVALID_PAGE_ID) {
@@ -1186,7 +1366,7 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
     return End();
   }
 
-  auto root_page_guard = bpm_->FetchPageRead(header_page->root_page_id_);
+  auto root_page_guard = bpm_->FetchPageRead(header_page->root_page_id_, AccessType::Index);
   auto root_page = root_page_guard.As<BPlusTreePage>();
 
   // crabbing
@@ -1204,7 +1384,7 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
   } else {
     while (true) {
       auto internal = reinterpret_cast<const InternalPage *>(root_page);
-      root_page_guard = bpm_->FetchPageRead(internal->ValueAt(0));
+      root_page_guard = bpm_->FetchPageRead(internal->ValueAt(0), AccessType::Index);
       root_page = root_page_guard.As<BPlusTreePage>();
 
       // crabbing
@@ -1229,7 +1409,7 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
     }
   }
 
-  auto guard = bpm_->FetchPageRead(begin_leaf);
+  auto guard = bpm_->FetchPageRead(begin_leaf, AccessType::Index);
   auto leaf = guard.As<LeafPage>();
   if (leaf->GetSize() == 0) {
     guard.SetDirty(false);
@@ -1252,7 +1432,7 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
   Context ctx;
 
-  auto header_page_guard = bpm_->FetchPageRead(header_page_id_);
+  auto header_page_guard = bpm_->FetchPageRead(header_page_id_, AccessType::Index);
   auto header_page = header_page_guard.As<BPlusTreeHeaderPage>();
 
   if (header_page->root_page_id_ == INVALID_PAGE_ID) {
@@ -1260,7 +1440,7 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
     header_page_guard.Drop();
     return End();
   }
-  auto root_page_guard = bpm_->FetchPageRead(header_page->root_page_id_);
+  auto root_page_guard = bpm_->FetchPageRead(header_page->root_page_id_, AccessType::Index);
   auto root_page = root_page_guard.As<BPlusTreePage>();
 
   // crabbing
@@ -1286,7 +1466,7 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
     while (true) {
       auto internal = reinterpret_cast<const InternalPage *>(root_page);
       int idx = BinaryFind(internal, key);
-      root_page_guard = bpm_->FetchPageRead(internal->ValueAt(idx));
+      root_page_guard = bpm_->FetchPageRead(internal->ValueAt(idx), AccessType::Index);
       root_page = root_page_guard.As<BPlusTreePage>();
 
       // crabbing
@@ -1317,7 +1497,7 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
     }
   }
 
-  auto guard = bpm_->FetchPageRead(begin_leaf);
+  auto guard = bpm_->FetchPageRead(begin_leaf, AccessType::Index);
   auto leaf = guard.As<LeafPage>();
   if (leaf->GetSize() == 0) {
     guard.SetDirty(false);
@@ -1339,12 +1519,54 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(bpm_, -1, -1); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::ScanRange(const KeyType *lo, bool lo_inclusive, const KeyType *hi, bool hi_inclusive)
+    -> INDEXRANGEITERATOR_TYPE {
+  std::optional<KeyType> lo_key;
+  std::optional<KeyType> hi_key;
+  if (lo != nullptr) {
+    lo_key = *lo;
+  }
+  if (hi != nullptr) {
+    hi_key = *hi;
+  }
+  return INDEXRANGEITERATOR_TYPE(bpm_, comparator_, FindLeafPageId(lo), std::move(lo_key), lo_inclusive,
+                                 std::move(hi_key), hi_inclusive,
+                                 [this](const KeyType *key) { return FindLeafPageId(key); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePages(const std::vector<page_id_t> &page_ids) {
+  std::lock_guard<std::mutex> lock(pending_deletes_latch_);
+  pending_deletes_.insert(pending_deletes_.end(), page_ids.begin(), page_ids.end());
+  pending_deletes_.erase(std::remove_if(pending_deletes_.begin(), pending_deletes_.end(),
+                                        [&](page_id_t page_id) { return bpm_->DeletePage(page_id); }),
+                         pending_deletes_.end());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageId(const KeyType *key) -> page_id_t {
+  auto guard = bpm_->FetchPageRead(header_page_id_, AccessType::Index);
+  page_id_t page_id = guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return INVALID_PAGE_ID;
+  }
+  // crabbing: the child is latched before its parent is released
+  guard = bpm_->FetchPageRead(page_id, AccessType::Index);
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    auto internal = guard.As<InternalPage>();
+    page_id = internal->ValueAt(key == nullptr ? 0 : BinaryFind(internal, *key));
+    guard = bpm_->FetchPageRead(page_id, AccessType::Index);
+  }
+  return page_id;
+}
+
 /**
  * @return Page id of the root of this tree
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
-  auto header_page_guard = bpm_->FetchPageRead(header_page_id_);
+  auto header_page_guard = bpm_->FetchPageRead(header_page_id_, AccessType::Index);
   auto header_page = header_page_guard.As<BPlusTreeHeaderPage>();
 
   page_id_t root_page_id = header_page->root_page_id_;
@@ -1361,12 +1583,23 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
 
 /*
  * This method is used for test only
- * Read data from file and insert one by one
+ * Read data from file and insert it: sorted and bulk loaded into an empty tree, otherwise one by one
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertFromFile(const std::string &file_name, Transaction *txn) {
   int64_t key;
   std::ifstream input(file_name);
+  if (IsEmpty()) {
+    ExternalSorter<KeyType, ValueType, KeyComparator> sorter(comparator_);
+    while (input >> key) {
+      KeyType index_key;
+      index_key.SetFromInteger(key);
+      sorter.Add(index_key, RID(key));
+    }
+    sorter.Finish();
+    BulkLoad([&sorter](KeyType *out_key, ValueType *out_value) { return sorter.Next(out_key, out_value); });
+    return;
+  }
   while (input) {
     input >> key;
 
@@ -1588,4 +1821,20 @@ template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTree<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+
+template class BPlusTree<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+
+template class BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
+template class BPlusTree<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+
+template class BPlusTree<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class BPlusTree<IntegerKey<int32_t>, RID, IntegerComparator<IntegerKey<int32_t>>>;
+
+template class BPlusTree<IntegerKey<int64_t>, RID, IntegerComparator<IntegerKey<int64_t>>>;
+
+template class BPlusTree<IntegerPairKey, RID, IntegerComparator<IntegerPairKey>>;
+
 }  // namespace bustub
@@ -11,15 +11,19 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include "storage/index/external_sorter.h"
+
 namespace bustub {
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     segment_id_t segment)
     : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()) {
   page_id_t header_page_id;
-  buffer_pool_manager->NewPage(&header_page_id);
+  // The tree fetches the header page itself, so the pin of the new page is dropped right away.
+  buffer_pool_manager->NewPageGuarded(&header_page_id, segment).Drop();
   container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(GetMetadata()->GetName(), header_page_id,
                                                                               buffer_pool_manager, comparator_);
 }
@@ -28,7 +32,7 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   return container_->Insert(index_key, rid, transaction);
 }
@@ -37,7 +41,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_->Remove(index_key, transaction);
 }
@@ -46,11 +50,29 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_->GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(Tuple *, RID *)> &next, double fill_factor) -> bool {
+  if (!container_->IsEmpty()) {
+    return false;
+  }
+  ExternalSorter<KeyType, ValueType, KeyComparator> sorter(comparator_);
+  Tuple key;
+  RID rid;
+  while (next(&key, &rid)) {
+    KeyType index_key;
+    index_key.SetFromKey(key, *GetKeySchema());
+    sorter.Add(index_key, rid);
+  }
+  sorter.Finish();
+  return container_->BulkLoad([&sorter](KeyType *out_key, RID *out_rid) { return sorter.Next(out_key, out_rid); },
+                              fill_factor);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_->Begin(); }
 
@@ -60,10 +82,33 @@ auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_->End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive)
+    -> INDEXRANGEITERATOR_TYPE {
+  KeyType lo_key;
+  KeyType hi_key;
+  if (lo != nullptr) {
+    lo_key.SetFromKey(*lo, *GetKeySchema());
+  }
+  if (hi != nullptr) {
+    hi_key.SetFromKey(*hi, *GetKeySchema());
+  }
+  return container_->ScanRange(lo == nullptr ? nullptr : &lo_key, lo_inclusive, hi == nullptr ? nullptr : &hi_key,
+                               hi_inclusive);
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class BPlusTreeIndex<IntegerKey<int32_t>, RID, IntegerComparator<IntegerKey<int32_t>>>;
+template class BPlusTreeIndex<IntegerKey<int64_t>, RID, IntegerComparator<IntegerKey<int64_t>>>;
+template class BPlusTreeIndex<IntegerPairKey, RID, IntegerComparator<IntegerPairKey>>;
 
 }  // namespace bustub
@@ -18,7 +18,7 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   return container_.Insert(transaction, index_key, rid);
 }
@@ -27,7 +27,7 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.Remove(transaction, index_key, rid);
 }
@@ -36,7 +36,7 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.GetValue(transaction, index_key, result);
 }
@@ -45,5 +45,10 @@ template class ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>
 template class ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class ExtendibleHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExtendibleHashTableIndex<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class ExtendibleHashTableIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class ExtendibleHashTableIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class ExtendibleHashTableIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class ExtendibleHashTableIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 
 }  // namespace bustub
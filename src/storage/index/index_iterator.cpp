@@ -1,7 +1,10 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <utility>
 
 #include "storage/index/index_iterator.h"
 
@@ -16,8 +19,9 @@ INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, page_i
   bpm_ = buffer_pool_manager;
   index_ = index;
   cur_ = cur;
+  read_ahead_ = ReadAhead(bpm_, AccessType::Index);
   if (cur != -1) {
-    auto guard = bpm_->FetchPageRead(cur);
+    auto guard = bpm_->FetchPageRead(cur, AccessType::Index);
     auto leaf = guard.As<LeafPage>();
     item_ = {leaf->KeyAt(index), leaf->ValueAt(index)};
     guard.Drop();
@@ -37,16 +41,17 @@ INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
   index_++;
 
-  auto guard = bpm_->FetchPageRead(cur_);
+  auto guard = bpm_->FetchPageRead(cur_, AccessType::Index);
   auto leaf = guard.As<LeafPage>();
 
   if (index_ >= leaf->GetSize()) {
     auto next_id = leaf->GetNextPageId();
     guard.Drop();
     if (next_id != -1) {
+      read_ahead_.OnHop(cur_, next_id);
       index_ = 0;
       cur_ = next_id;
-      guard = bpm_->FetchPageRead(cur_);
+      guard = bpm_->FetchPageRead(cur_, AccessType::Index);
       leaf = guard.As<LeafPage>();
       item_ = {leaf->KeyAt(index_), leaf->ValueAt(index_)};
       guard.Drop();
@@ -62,6 +67,93 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
   return *this;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXRANGEITERATOR_TYPE::IndexRangeIterator(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                                            page_id_t leaf, std::optional<KeyType> lo, bool lo_inclusive,
+                                            std::optional<KeyType> hi, bool hi_inclusive,
+                                            std::function<page_id_t(const KeyType *)> find_leaf)
+    : bpm_(buffer_pool_manager),
+      comparator_(comparator),
+      next_leaf_(leaf),
+      lo_(std::move(lo)),
+      lo_inclusive_(lo_inclusive),
+      hi_(std::move(hi)),
+      hi_inclusive_(hi_inclusive),
+      read_ahead_(buffer_pool_manager, AccessType::Index),
+      find_leaf_(std::move(find_leaf)) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXRANGEITERATOR_TYPE::AboveRange(const KeyType &key) const -> bool {
+  if (!hi_.has_value()) {
+    return false;
+  }
+  const int cmp = comparator_(key, *hi_);
+  return cmp > 0 || (cmp == 0 && !hi_inclusive_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXRANGEITERATOR_TYPE::NextBatch(std::vector<ValueType> *values) -> bool {
+  values->clear();
+  while (values->empty() && next_leaf_ != INVALID_PAGE_ID) {
+    auto guard = bpm_->FetchPageRead(next_leaf_, AccessType::Index);
+    auto leaf = guard.template As<LeafPage>();
+    const int size = leaf->GetSize();
+    // A leaf reached through a link must hold the keys after the last one returned; the first one covers the lower
+    // bound by lookup. Otherwise its page was taken off the tree since, so look the leaf up again.
+    bool stale = !leaf->IsLeafPage();
+    if (!stale && !first_leaf_ && lo_.has_value() && size > 0) {
+      const int cmp = comparator_(leaf->KeyAt(0), *lo_);
+      stale = cmp < 0 || (cmp == 0 && !lo_inclusive_);
+    }
+    if (stale) {
+      guard.Drop();
+      next_leaf_ = find_leaf_(lo_.has_value() ? &*lo_ : nullptr);
+      first_leaf_ = true;
+      continue;
+    }
+
+    // The first entry in range: the first key not below the lower bound in the first leaf, the first entry after it.
+    int begin = 0;
+    if (first_leaf_ && lo_.has_value()) {
+      const KeyType *keys = leaf->KeyArray();
+      begin = static_cast<int>(std::partition_point(keys, keys + size,
+                                                    [&](const KeyType &key) {
+                                                      const int cmp = comparator_(key, *lo_);
+                                                      return cmp < 0 || (cmp == 0 && !lo_inclusive_);
+                                                    }) -
+                               keys);
+    }
+    first_leaf_ = false;
+
+    // The leaf is copied out whole up to its end, unless its last key is past the upper bound.
+    int end = size;
+    bool last_leaf = false;
+    if (size > 0 && AboveRange(leaf->KeyAt(size - 1))) {
+      end = begin;
+      while (end < size && !AboveRange(leaf->KeyAt(end))) {
+        end++;
+      }
+      last_leaf = true;
+    }
+    values->reserve(end - begin);
+    for (int i = begin; i < end; i++) {
+      values->push_back(leaf->ValueAt(i));
+    }
+    if (end > begin) {
+      lo_ = leaf->KeyAt(end - 1);
+      lo_inclusive_ = false;
+    }
+
+    const page_id_t next_leaf = last_leaf ? INVALID_PAGE_ID : leaf->GetNextPageId();
+    guard.Drop();
+    if (next_leaf != INVALID_PAGE_ID) {
+      read_ahead_.OnHop(next_leaf_, next_leaf);
+    }
+    next_leaf_ = next_leaf;
+  }
+  return !values->empty();
+}
+
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
@@ -71,5 +163,27 @@ template class IndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
 template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
+template class IndexIterator<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class IndexIterator<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class IndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class IndexIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class IndexIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class IndexIterator<IntegerKey<int32_t>, RID, IntegerComparator<IntegerKey<int32_t>>>;
+template class IndexIterator<IntegerKey<int64_t>, RID, IntegerComparator<IntegerKey<int64_t>>>;
+template class IndexIterator<IntegerPairKey, RID, IntegerComparator<IntegerPairKey>>;
+
+template class IndexRangeIterator<GenericKey<4>, RID, GenericComparator<4>>;
+template class IndexRangeIterator<GenericKey<8>, RID, GenericComparator<8>>;
+template class IndexRangeIterator<GenericKey<16>, RID, GenericComparator<16>>;
+template class IndexRangeIterator<GenericKey<32>, RID, GenericComparator<32>>;
+template class IndexRangeIterator<GenericKey<64>, RID, GenericComparator<64>>;
+template class IndexRangeIterator<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class IndexRangeIterator<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class IndexRangeIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class IndexRangeIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class IndexRangeIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class IndexRangeIterator<IntegerKey<int32_t>, RID, IntegerComparator<IntegerKey<int32_t>>>;
+template class IndexRangeIterator<IntegerKey<int64_t>, RID, IntegerComparator<IntegerKey<int64_t>>>;
+template class IndexRangeIterator<IntegerPairKey, RID, IntegerComparator<IntegerPairKey>>;
 
 }  // namespace bustub
@@ -0,0 +1,194 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.cpp
+//
+// Identification: src/storage/index/key_search.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_search.h"
+
+#include <atomic>
+
+#include "common/exception.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BUSTUB_KEY_SEARCH_X86
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** Keys left for the vector compares once the binary search is done: four cache lines of them. */
+template <typename T>
+constexpr int SIMD_WINDOW = 256 / sizeof(T);
+
+/** Keys left for the scalar count once the binary search is done. */
+constexpr int SCALAR_WINDOW = 8;
+
+/**
+ * Binary search without a branch on the keys, until at most `window` keys are left.
+ * @return lo, such that the upper bound of `key` is in [lo, lo + *len], with *len <= window
+ */
+template <typename T>
+inline auto Narrow(const T *keys, int *len, T key, int window) -> int {
+  int lo = 0;
+  while (*len > window) {
+    const int half = *len / 2;
+    lo = keys[lo + half - 1] <= key ? lo + half : lo;
+    *len -= half;
+  }
+  return lo;
+}
+
+template <typename T>
+auto UpperBoundScalar(const T *keys, int n, T key) -> int {
+  int len = n;
+  const int lo = Narrow(keys, &len, key, SCALAR_WINDOW);
+  int count = 0;
+  for (int i = lo; i < lo + len; i++) {
+    count += static_cast<int>(keys[i] <= key);
+  }
+  return lo + count;
+}
+
+#ifdef BUSTUB_KEY_SEARCH_X86
+
+// Each function counts the keys of the window that are not greater than `key`, a vector of keys at a time: a compare
+// sets the lanes greater than `key`, and a movemask and a popcount count them.
+
+__attribute__((target("sse4.2,popcnt"))) auto UpperBoundSse42(const int32_t *keys, int n, int32_t key) -> int {
+  int len = n;
+  const int lo = Narrow(keys, &len, key, SIMD_WINDOW<int32_t>);
+  const __m128i needle = _mm_set1_epi32(key);
+  int count = 0;
+  int i = lo;
+  for (; i + 4 <= lo + len; i += 4) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+    count += 4 - __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(chunk, needle))));
+  }
+  for (; i < lo + len; i++) {
+    count += static_cast<int>(keys[i] <= key);
+  }
+  return lo + count;
+}
+
+__attribute__((target("sse4.2,popcnt"))) auto UpperBoundSse42(const int64_t *keys, int n, int64_t key) -> int {
+  int len = n;
+  const int lo = Narrow(keys, &len, key, SIMD_WINDOW<int64_t>);
+  const __m128i needle = _mm_set1_epi64x(key);
+  int count = 0;
+  int i = lo;
+  for (; i + 2 <= lo + len; i += 2) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+    count += 2 - __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(chunk, needle))));
+  }
+  for (; i < lo + len; i++) {
+    count += static_cast<int>(keys[i] <= key);
+  }
+  return lo + count;
+}
+
+__attribute__((target("avx2,popcnt"))) auto UpperBoundAvx2(const int32_t *keys, int n, int32_t key) -> int {
+  int len = n;
+  const int lo = Narrow(keys, &len, key, SIMD_WINDOW<int32_t>);
+  const __m256i needle = _mm256_set1_epi32(key);
+  int count = 0;
+  int i = lo;
+  for (; i + 8 <= lo + len; i += 8) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+    count += 8 - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(chunk, needle))));
+  }
+  for (; i < lo + len; i++) {
+    count += static_cast<int>(keys[i] <= key);
+  }
+  return lo + count;
+}
+
+__attribute__((target("avx2,popcnt"))) auto UpperBoundAvx2(const int64_t *keys, int n, int64_t key) -> int {
+  int len = n;
+  const int lo = Narrow(keys, &len, key, SIMD_WINDOW<int64_t>);
+  const __m256i needle = _mm256_set1_epi64x(key);
+  int count = 0;
+  int i = lo;
+  for (; i + 4 <= lo + len; i += 4) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+    count += 4 - __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(chunk, needle))));
+  }
+  for (; i < lo + len; i++) {
+    count += static_cast<int>(keys[i] <= key);
+  }
+  return lo + count;
+}
+
+#endif
+
+auto CurrentIsa() -> std::atomic<KeySearchIsa> & {
+  static std::atomic<KeySearchIsa> isa{DetectKeySearchIsa()};
+  return isa;
+}
+
+template <typename T>
+auto UpperBound(const T *keys, int n, T key) -> int {
+  switch (CurrentIsa().load(std::memory_order_relaxed)) {
+#ifdef BUSTUB_KEY_SEARCH_X86
+    case KeySearchIsa::Avx2:
+      return UpperBoundAvx2(keys, n, key);
+    case KeySearchIsa::Sse42:
+      return UpperBoundSse42(keys, n, key);
+#endif
+    default:
+      return UpperBoundScalar(keys, n, key);
+  }
+}
+
+}  // namespace
+
+auto KeySearchIsaName(KeySearchIsa isa) -> std::string {
+  switch (isa) {
+    case KeySearchIsa::Scalar:
+      return "scalar";
+    case KeySearchIsa::Sse42:
+      return "sse4.2";
+    case KeySearchIsa::Avx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+auto DetectKeySearchIsa() -> KeySearchIsa {
+#ifdef BUSTUB_KEY_SEARCH_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("popcnt") == 0) {
+    return KeySearchIsa::Scalar;
+  }
+  if (__builtin_cpu_supports("avx2") != 0) {
+    return KeySearchIsa::Avx2;
+  }
+  if (__builtin_cpu_supports("sse4.2") != 0) {
+    return KeySearchIsa::Sse42;
+  }
+#endif
+  return KeySearchIsa::Scalar;
+}
+
+auto GetKeySearchIsa() -> KeySearchIsa { return CurrentIsa().load(); }
+
+void SetKeySearchIsa(KeySearchIsa isa) {
+  if (static_cast<int>(isa) > static_cast<int>(DetectKeySearchIsa())) {
+    throw Exception("this CPU can't search keys with " + KeySearchIsaName(isa));
+  }
+  CurrentIsa().store(isa);
+}
+
+auto KeyUpperBound(const int32_t *keys, int n, int32_t key) -> int { return UpperBound(keys, n, key); }
+
+auto KeyUpperBound(const int64_t *keys, int n, int64_t key) -> int { return UpperBound(keys, n, key); }
+
+}  // namespace bustub
@@ -106,5 +106,10 @@ template class ExtendibleHTableBucketPage<GenericKey<8>, RID, GenericComparator<
 template class ExtendibleHTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class ExtendibleHTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExtendibleHTableBucketPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class ExtendibleHTableBucketPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class ExtendibleHTableBucketPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class ExtendibleHTableBucketPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class ExtendibleHTableBucketPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 
 }  // namespace bustub
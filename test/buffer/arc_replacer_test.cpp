@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: load pages 10 to 13 into frames 0 to 3. They all go to T1.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    arc_replacer.RecordAccess(frame_id, AccessType::Lookup, 10 + frame_id);
+    arc_replacer.SetEvictable(frame_id, true);
+  }
+  EXPECT_EQ(4, arc_replacer.Size());
+
+  // Scenario: the least recently used frame of T1 goes first. Its page is remembered in B1.
+  frame_id_t value;
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: a second access moves frame 1 to T2, so frame 2 is the next victim.
+  arc_replacer.RecordAccess(1, AccessType::Lookup, 11);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(2, arc_replacer.Size());
+
+  // Scenario: reloading page 10 hits B1. T1 was too small, so its target grows and the page goes to T2.
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+  arc_replacer.RecordAccess(0, AccessType::Lookup, 10);
+  arc_replacer.SetEvictable(0, true);
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+
+  // Scenario: a scan that reloads page 12 neither adapts the target nor enters T2.
+  arc_replacer.RecordAccess(2, AccessType::Scan, 12);
+  arc_replacer.SetEvictable(2, true);
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+
+  // T1 = {3, 2} is larger than its target of 1, so it gives up one frame before T2 = {1, 0} is touched.
+  EXPECT_EQ((std::vector<frame_id_t>{3, 1, 0, 2}), arc_replacer.EvictionCandidates(4));
+
+  // Scenario: pinned frames are skipped, and cannot be removed.
+  arc_replacer.SetEvictable(3, false);
+  EXPECT_EQ((std::vector<frame_id_t>{2, 1, 0}), arc_replacer.EvictionCandidates(4));
+  EXPECT_THROW(arc_replacer.Remove(3), Exception);
+
+  // Scenario: removing a frame counts as an eviction.
+  arc_replacer.Remove(2);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+  EXPECT_FALSE(arc_replacer.Evict(&value));
+  EXPECT_EQ(0, arc_replacer.Size());
+
+  // Scenario: page 11 was evicted from T2, so reloading it hits B2 and shrinks the target of T1.
+  arc_replacer.RecordAccess(1, AccessType::Lookup, 11);
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+  EXPECT_THROW(arc_replacer.RecordAccess(4), Exception);
+}
+
+}  // namespace bustub
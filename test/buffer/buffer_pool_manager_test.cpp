@@ -12,11 +12,25 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
+#include "buffer/read_ahead.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_scheduler.h"
 
 namespace bustub {
 
@@ -144,4 +158,729 @@ TEST(BufferPoolManagerTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, AlignedFramesTest) {
+  const size_t buffer_pool_size = 10;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+
+  // Scenario: the frames are one page-aligned block, with or without huge pages.
+  for (bool huge_pages : {false, true}) {
+    buffer_pool_huge_pages = huge_pages;
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+    char *base = bpm->GetPages()[0].GetData();
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(base) % FrameArena::FRAME_ALIGNMENT);
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      EXPECT_EQ(base + i * BUSTUB_PAGE_SIZE, bpm->GetPages()[i].GetData());
+    }
+  }
+  buffer_pool_huge_pages = false;
+
+  // Scenario: pages read through an O_DIRECT disk manager land in the frames directly.
+  remove("test_direct.db");
+  auto direct_disk_manager = std::make_unique<DiskManager>("test_direct.db", true);
+  {
+    auto bpm = std::make_unique<BufferPoolManager>(2, direct_disk_manager.get(), 2);
+    for (size_t i = 0; i < 4; i++) {
+      page_id_t page_id;
+      auto guard = bpm->NewPageGuarded(&page_id);
+      snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    }
+    for (page_id_t page_id = 0; page_id < 4; page_id++) {
+      auto guard = bpm->FetchPageRead(page_id);
+      EXPECT_EQ("page-" + std::to_string(page_id), std::string(guard.GetData()));
+    }
+  }
+  direct_disk_manager->ShutDown();
+  remove("test_direct.db");
+  remove("test_direct.log");
+}
+
+// NOLINTNEXTLINE
+// Concurrent misses on the same page share one read, and misses on other pages do not corrupt each other.
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 32;
+  const size_t num_threads = 8;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+
+  // Write more pages than fit in the pool, so that every one of them has to be evicted (and written back) once.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  disk_manager->SetLatency(1);
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      for (size_t round = 0; round < num_pages; round++) {
+        // Half of the threads chase the same page, the others spread over the rest.
+        auto page_id = page_ids[tid % 2 == 0 ? round : (round * 7 + tid) % num_pages];
+        auto guard = bpm->FetchPageRead(page_id);
+        ASSERT_EQ(page_id, guard.PageId());
+        EXPECT_EQ("page-" + std::to_string(page_id), std::string(guard.GetData()));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+// NOLINTNEXTLINE
+// Hits are served without the pool latch, while other threads evict and read pages into the same frames.
+TEST(BufferPoolManagerTest, ConcurrentHitTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 24;
+  const size_t num_threads = 8;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+
+  // Scenario: a hit is recorded in the replacer even though it never took the latch. Page 0 has been accessed twice,
+  // so page 1 is the victim.
+  {
+    auto small_disk = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto small_bpm = std::make_unique<BufferPoolManager>(3, small_disk.get(), 2);
+    page_id_t page_id;
+    for (size_t i = 0; i < 3; i++) {
+      ASSERT_NE(nullptr, small_bpm->NewPage(&page_id));
+      EXPECT_TRUE(small_bpm->UnpinPage(page_id, false));
+    }
+    small_bpm->FetchPageRead(0).Drop();
+    ASSERT_NE(nullptr, small_bpm->NewPage(&page_id));
+    EXPECT_TRUE(small_bpm->UnpinPage(page_id, false));
+    EXPECT_TRUE(small_bpm->FlushPage(0));
+    EXPECT_FALSE(small_bpm->FlushPage(1));
+    EXPECT_TRUE(small_bpm->FlushPage(2));
+  }
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    page_ids.push_back(page_id);
+  }
+  for (auto page_id : page_ids) {
+    auto guard = bpm->FetchPageWrite(page_id);
+    snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+  }
+
+  // Most fetches are hits on the first pages, but the tail of the page range keeps the pool evicting.
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<size_t> dist(0, num_pages - 1);
+      for (size_t round = 0; round < 2000; round++) {
+        auto page_id = page_ids[round % 4 == 0 ? dist(gen) : dist(gen) % (buffer_pool_size / 2)];
+        if (round % 8 == tid % 8) {
+          auto guard = bpm->FetchPageWrite(page_id);
+          ASSERT_EQ(page_id, guard.PageId());
+          snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+        } else {
+          auto guard = bpm->FetchPageRead(page_id);
+          ASSERT_EQ(page_id, guard.PageId());
+          EXPECT_EQ("page-" + std::to_string(page_id), std::string(guard.GetData()));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: no pin was lost or leaked, so every frame can be taken by a new page.
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, StatsTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(2, disk_manager.get(), 2);
+
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+
+  // Scenario: a hit. Page 0 now has two accesses, so page 1 is evicted for page 2, without a write-back.
+  ASSERT_NE(nullptr, bpm->FetchPage(0, AccessType::Lookup));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // Scenario: a miss, which evicts the dirty page 2.
+  ASSERT_NE(nullptr, bpm->FetchPage(1, AccessType::Scan));
+
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_DOUBLE_EQ(0.5, stats.HitRatio());
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(1, stats.dirty_write_backs_);
+  EXPECT_EQ(0, stats.pin_waits_);
+  // Page 1 is still pinned, so its interval has not ended yet.
+  EXPECT_EQ(4, stats.pin_intervals_);
+  EXPECT_EQ(stats.pinned_time_ / 4, stats.AveragePinDuration());
+  EXPECT_EQ(1, stats.frames_by_access_type_[static_cast<size_t>(AccessType::Lookup)]);
+  EXPECT_EQ(1, stats.frames_by_access_type_[static_cast<size_t>(AccessType::Scan)]);
+  EXPECT_EQ(0, stats.frames_by_access_type_[static_cast<size_t>(AccessType::Unknown)]);
+
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+  EXPECT_EQ(5, bpm->GetStats().pin_intervals_);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, SetReplacerTest) {
+  const size_t buffer_pool_size = 3;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+
+  std::vector<page_id_t> page_ids;
+  auto new_page = [&]() -> page_id_t {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    if (page == nullptr) {
+      return INVALID_PAGE_ID;
+    }
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    page_ids.push_back(page_id);
+    return page_id;
+  };
+
+  // Scenario: fill the pool, and keep page 0 pinned.
+  auto pinned_page_id = new_page();
+  for (size_t i = 1; i < buffer_pool_size; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(new_page(), true));
+  }
+
+  // Scenario: an unknown policy is rejected, and the current one is kept.
+  EXPECT_THROW(bpm->SetReplacer("mru"), Exception);
+
+  // Scenario: under every policy, the resident pages can be evicted, but never a pinned one.
+  for (const auto *policy : {"ARC", "2q", "clock", "lru", "lru_k"}) {
+    bpm->SetReplacer(policy);
+    for (size_t round = 0; round < 4; round++) {
+      auto page_id = new_page();
+      ASSERT_NE(INVALID_PAGE_ID, page_id) << policy;
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    auto first = new_page();
+    auto second = new_page();
+    ASSERT_NE(INVALID_PAGE_ID, second) << policy;
+    EXPECT_EQ(INVALID_PAGE_ID, new_page()) << policy;
+    EXPECT_TRUE(bpm->UnpinPage(first, true));
+    EXPECT_TRUE(bpm->UnpinPage(second, true));
+  }
+
+  for (auto page_id : page_ids) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(guard.GetData()));
+  }
+  EXPECT_TRUE(bpm->UnpinPage(pinned_page_id, false));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundFlusherTest) {
+  const size_t buffer_pool_size = 10;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+
+  // Scenario: fill the pool with dirty, unpinned pages.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: the flusher keeps the half of the pool closest to eviction clean.
+  BackgroundFlusherOptions options;
+  options.interval_ = std::chrono::milliseconds(1);
+  options.target_clean_ratio_ = 0.5;
+  bpm->StartBackgroundFlusher(options);
+  for (int i = 0; i < 1000 && bpm->GetBackgroundFlusherStats().pages_cleaned_ < buffer_pool_size / 2; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  bpm->StopBackgroundFlusher();
+  auto stats = bpm->GetBackgroundFlusherStats();
+  EXPECT_EQ(buffer_pool_size / 2, stats.pages_cleaned_);
+
+  // Scenario: evicting those pages needs no write-back on this thread; the other half still does.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  stats = bpm->GetBackgroundFlusherStats();
+  EXPECT_EQ(buffer_pool_size / 2, stats.write_backs_avoided_);
+  EXPECT_EQ(buffer_pool_size / 2, stats.foreground_write_backs_);
+
+  // Scenario: every page made it to disk.
+  for (auto page_id : page_ids) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(guard.GetData()));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_pages = 12;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    page_ids.push_back(page_id);
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: pages that were never allocated are not prefetched.
+  EXPECT_FALSE(bpm->PrefetchPage(static_cast<page_id_t>(num_pages)));
+  EXPECT_FALSE(bpm->PrefetchPage(INVALID_PAGE_ID));
+
+  // Scenario: prefetched pages are not pinned, and fetching them returns their contents.
+  EXPECT_EQ(buffer_pool_size, bpm->PrefetchRange(0, buffer_pool_size));
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ("page-" + std::to_string(page_ids[i]), std::string(page->GetData()));
+  }
+
+  // Scenario: with every frame pinned, a prefetch is dropped instead of failing a later fetch.
+  EXPECT_FALSE(bpm->PrefetchPage(page_ids[buffer_pool_size]));
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+
+  // Scenario: a read-ahead that follows pages 4, 5, 6 keeps the window after page 6 in flight.
+  read_ahead_window = 3;
+  ReadAhead read_ahead(bpm.get(), AccessType::Scan, static_cast<page_id_t>(num_pages - 1));
+  read_ahead.OnHop(4, 5);
+  read_ahead.OnHop(5, 6);
+  // FlushPage only succeeds on resident pages, and waits for outstanding reads.
+  EXPECT_TRUE(bpm->FlushPage(7));
+  EXPECT_TRUE(bpm->FlushPage(9));
+  EXPECT_FALSE(bpm->FlushPage(10));
+  for (page_id_t page_id = 7; page_id <= 9; page_id++) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(guard.GetData()));
+  }
+  read_ahead_window = 8;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PageReuseTest) {
+  const size_t buffer_pool_size = 10;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: deleted pages are handed out again, lowest first, before the file grows.
+  EXPECT_TRUE(bpm->DeletePage(7));
+  EXPECT_TRUE(bpm->DeletePage(3));
+  EXPECT_TRUE(bpm->DeletePage(3));
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(3, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(7, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(10, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // Scenario: a reused page never reads back the contents it had before it was deleted.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  {
+    auto guard = bpm->FetchPageRead(3);
+    EXPECT_EQ(0, guard.GetData()[0]);
+  }
+
+  // Scenario: under delete/insert churn the page ids, and so the file size, stay bounded by the live pages.
+  std::vector<page_id_t> live;
+  for (page_id_t i = 0; i <= 20; i++) {
+    live.push_back(i);
+  }
+  std::mt19937 gen(15445);
+  page_id_t max_page_id = 0;
+  for (int round = 0; round < 1000; round++) {
+    auto victim = live.begin() + static_cast<std::ptrdiff_t>(gen() % live.size());
+    EXPECT_TRUE(bpm->DeletePage(*victim));
+    live.erase(victim);
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    live.push_back(page_id);
+    max_page_id = std::max(max_page_id, page_id);
+  }
+  EXPECT_LE(max_page_id, 20);
+
+  // Scenario: the free-page map survives a restart, so a new pool fills the holes before extending the file.
+  std::sort(live.begin(), live.end());
+  EXPECT_TRUE(bpm->DeletePage(live[0]));
+  bpm->FlushAllPages();
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(live[0], page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(21, page_id);
+}
+
+/** Records the runs a checkpoint writes. */
+class RunRecordingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void WritePages(page_id_t page_id, const std::vector<const char *> &pages) override {
+    {
+      std::lock_guard<std::mutex> lock(runs_mutex_);
+      runs_.emplace_back(page_id, pages.size());
+    }
+    DiskManager::WritePages(page_id, pages);
+  }
+
+  std::mutex runs_mutex_;
+  std::vector<std::pair<page_id_t, size_t>> runs_;
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, CheckpointTest) {
+  const size_t buffer_pool_size = 150;
+
+  auto disk_manager = std::make_unique<RunRecordingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+
+  // Scenario: every page but 40 is dirty, and page 10 is still pinned.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, page_id != 40));
+  }
+  auto *pinned = bpm->FetchPage(10);
+
+  // Scenario: the dirty pages are written in page id order, in runs of consecutive pages. Pinned pages are written
+  // too, and the runs are cut at clean pages and at CHECKPOINT_RUN_PAGES pages.
+  checkpoint_writers = 3;
+  bpm->FlushAllPages();
+  checkpoint_writers = 1;
+  std::sort(disk_manager->runs_.begin(), disk_manager->runs_.end());
+  std::vector<std::pair<page_id_t, size_t>> expected{{0, 40}, {41, 64}, {105, 45}};
+  EXPECT_EQ(expected, disk_manager->runs_);
+  EXPECT_EQ(1, pinned->GetPinCount());
+  EXPECT_FALSE(pinned->IsDirty());
+  EXPECT_TRUE(bpm->UnpinPage(10, false));
+
+  // Scenario: the pages are clean now, so a second checkpoint writes only what was dirtied since.
+  disk_manager->runs_.clear();
+  EXPECT_TRUE(bpm->UnpinPage(bpm->FetchPage(7)->GetPageId(), true));
+  bpm->FlushAllPages();
+  expected = {{7, 1}};
+  EXPECT_EQ(expected, disk_manager->runs_);
+
+  // Scenario: what was written comes back after the pages are evicted.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    if (page_id != 40) {
+      auto guard = bpm->FetchPageRead(page_id);
+      EXPECT_EQ("page-" + std::to_string(page_id), std::string(guard.GetData()));
+    }
+  }
+}
+
+/** Hands io_uring a directory instead of the database file while failing_ is set, so that page I/O fails. */
+class FailingDiskManager : public DiskManager {
+ public:
+  explicit FailingDiskManager(const std::string &db_file)
+      : DiskManager(db_file), dir_fd_(open(".", O_RDONLY | O_DIRECTORY)) {}
+  ~FailingDiskManager() override { close(dir_fd_); }
+
+  auto GetPageFile(page_id_t page_id, off_t *offset) -> int override {
+    if (failing_) {
+      *offset = 0;
+      return dir_fd_;
+    }
+    return DiskManager::GetPageFile(page_id, offset);
+  }
+
+  std::atomic<bool> failing_{false};
+
+ private:
+  int dir_fd_;
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FailedIoTest) {
+  const std::string db_name = "test_failed_io.db";
+  remove(db_name.c_str());
+  auto disk_manager = std::make_unique<FailingDiskManager>(db_name);
+  const size_t io_depth = disk_io_depth;
+  disk_io_depth = 4;
+  if (DiskScheduler(disk_manager.get()).GetBackend() != DiskSchedulerBackend::IoUring) {
+    disk_io_depth = io_depth;
+    disk_manager->ShutDown();
+    GTEST_SKIP() << "io_uring is not available";
+  }
+  {
+    auto bpm = std::make_unique<BufferPoolManager>(1, disk_manager.get(), 2);
+    page_id_t page0;
+    auto *page = bpm->NewPage(&page0);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-0");
+    EXPECT_TRUE(bpm->UnpinPage(page0, true));
+
+    // Scenario: the dirty victim cannot be written back. The new page is given up, and the old one stays, dirty.
+    disk_manager->failing_ = true;
+    page_id_t page_id;
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(INVALID_PAGE_ID, page_id);
+    EXPECT_EQ(nullptr, bpm->FetchPage(page0 + 1));
+    page = bpm->FetchPage(page0);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(page->IsDirty());
+    EXPECT_EQ("page-0", std::string(page->GetData()));
+    EXPECT_FALSE(bpm->FlushPage(page0));
+    EXPECT_TRUE(page->IsDirty());
+    EXPECT_TRUE(bpm->UnpinPage(page0, false));
+
+    // Scenario: once the disk works again, the page is written back and can be evicted.
+    disk_manager->failing_ = false;
+    EXPECT_TRUE(bpm->FlushPage(page0));
+    EXPECT_FALSE(page->IsDirty());
+    page_id_t page1;
+    page = bpm->NewPage(&page1);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-1");
+    EXPECT_TRUE(bpm->UnpinPage(page1, true));
+    EXPECT_TRUE(bpm->FlushPage(page1));
+
+    // Scenario: a failed read hands out no frame, and leaves it free for the next fetch.
+    disk_manager->failing_ = true;
+    EXPECT_EQ(nullptr, bpm->FetchPage(page0));
+    EXPECT_EQ(nullptr, bpm->FetchPage(page0));
+    disk_manager->failing_ = false;
+    for (page_id_t id : {page0, page1}) {
+      auto guard = bpm->FetchPageRead(id);
+      EXPECT_EQ("page-" + std::to_string(id), std::string(guard.GetData()));
+    }
+  }
+  disk_io_depth = io_depth;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove("test_failed_io.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t grown_size = 10;
+  const size_t shrunk_size = 3;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+  bpm->SetReplacer("arc");
+
+  // Scenario: after growing, the new frames can all be pinned at once, and no more than that.
+  bpm->Resize(grown_size);
+  EXPECT_EQ(grown_size, bpm->GetPoolSize());
+  std::vector<Page *> pages;
+  for (size_t i = 0; i < grown_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    pages.push_back(page);
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  // Scenario: a shrink waits for the pins on the frames it takes away, and writes their dirty pages back.
+  std::thread unpinner([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (auto *page : pages) {
+      EXPECT_TRUE(bpm->UnpinPage(page->GetPageId(), true));
+    }
+  });
+  bpm->Resize(shrunk_size);
+  unpinner.join();
+  EXPECT_EQ(shrunk_size, bpm->GetPoolSize());
+  for (page_id_t id = 0; id < static_cast<page_id_t>(grown_size); id++) {
+    auto guard = bpm->FetchPageRead(id);
+    EXPECT_EQ("page-" + std::to_string(id), std::string(guard.GetData()));
+  }
+  std::vector<BasicPageGuard> guards;
+  for (size_t i = 0; i < shrunk_size; i++) {
+    guards.push_back(bpm->FetchPageBasic(static_cast<page_id_t>(i)));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(static_cast<page_id_t>(shrunk_size)));
+  guards.clear();
+
+  // Scenario: growing again reuses the drained frames.
+  bpm->Resize(buffer_pool_size);
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    guards.push_back(bpm->FetchPageBasic(static_cast<page_id_t>(i)));
+    EXPECT_EQ("page-" + std::to_string(i), std::string(guards.back().GetData()));
+  }
+  guards.clear();
+
+  EXPECT_THROW(bpm->Resize(0), Exception);
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, SegmentTest) {
+  const size_t buffer_pool_size = 4;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), 2);
+  bpm->CreateSegment(1);
+  bpm->CreateSegment(2);
+
+  // Scenario: the pages of a segment are numbered from 0 within it, apart from the default segment.
+  page_id_t default_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&default_page_id));
+  std::vector<page_id_t> page_ids;
+  for (page_id_t i = 0; i < 6; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id, i % 2 + 1);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i % 2 + 1, SegmentOf(page_id));
+    EXPECT_EQ(i / 2, SegmentPageNumber(page_id));
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    page_ids.push_back(page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_TRUE(bpm->UnpinPage(default_page_id, false));
+  EXPECT_THROW(bpm->NewPage(&default_page_id, MAX_SEGMENT_ID + 1), Exception);
+
+  // Scenario: the pages were written back on eviction, and read back from their segment.
+  for (auto page_id : page_ids) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(guard.GetData()));
+  }
+
+  // Scenario: a page deleted in a segment is handed out again by that segment only.
+  EXPECT_TRUE(bpm->DeletePage(page_ids[2]));
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id, 2));
+  EXPECT_EQ(MakeSegmentPageId(2, 3), page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id, 1));
+  EXPECT_EQ(page_ids[2], page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // Scenario: dropping a segment discards its pages, resident or not, and leaves the others alone.
+  {
+    auto guard = bpm->FetchPageRead(page_ids[0]);
+  }
+  bpm->DropSegment(1);
+  EXPECT_FALSE(bpm->PrefetchPage(page_ids[4]));
+  {
+    auto guard = bpm->FetchPageRead(page_ids[1]);
+    EXPECT_EQ("page-" + std::to_string(page_ids[1]), std::string(guard.GetData()));
+  }
+  EXPECT_THROW(bpm->DropSegment(DEFAULT_SEGMENT_ID), Exception);
+
+  // Scenario: a segment created again starts out empty.
+  bpm->CreateSegment(1);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id, 1));
+  EXPECT_EQ(MakeSegmentPageId(1, 0), page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // Scenario: a page pinned when its segment is dropped keeps the segment from being reused, until it is unpinned and
+  // discarded. The segment created again then starts out empty, without the stale page.
+  auto *stale_page = bpm->NewPage(&page_id, 1);
+  ASSERT_NE(nullptr, stale_page);
+  snprintf(stale_page->GetData(), BUSTUB_PAGE_SIZE, "stale");
+  EXPECT_FALSE(bpm->DropSegment(1));
+  EXPECT_FALSE(bpm->DiscardSegment(1));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  EXPECT_TRUE(bpm->DiscardSegment(1));
+  bpm->CreateSegment(1);
+  page_id_t new_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&new_page_id, 1));
+  EXPECT_EQ(MakeSegmentPageId(1, 0), new_page_id);
+  EXPECT_TRUE(bpm->UnpinPage(new_page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&new_page_id, 1));
+  EXPECT_EQ(page_id, new_page_id);
+  EXPECT_TRUE(bpm->UnpinPage(new_page_id, false));
+  {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(0, guard.GetData()[0]);
+  }
+
+  // Scenario: the default segment is full at DEFAULT_SEGMENT_PAGES pages, where segment 1 begins. The last of 256
+  // instances of a parallel pool holds every 256th page, and its free-page map has them all in use but the last one.
+  disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  const uint32_t num_instances = 256;
+  std::vector<char> map_page(BUSTUB_PAGE_SIZE, static_cast<char>(0xff));
+  const size_t map_pages = DEFAULT_SEGMENT_PAGES / num_instances / (BUSTUB_PAGE_SIZE * 8);
+  for (size_t k = 0; k < map_pages; k++) {
+    if (k == map_pages - 1) {
+      map_page[BUSTUB_PAGE_SIZE - 1] = 0x7f;
+    }
+    disk_manager->WriteFreeMapPage(k * num_instances + num_instances - 1, map_page.data());
+  }
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, num_instances, num_instances - 1, disk_manager.get(), 2);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(DEFAULT_SEGMENT_PAGES - 1, page_id);
+  EXPECT_EQ(DEFAULT_SEGMENT_ID, SegmentOf(page_id));
+  EXPECT_EQ(1, SegmentOf(page_id + 1));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  EXPECT_THROW(bpm->NewPage(&page_id), Exception);
+}
+
 }  // namespace bustub
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <map>
 #include <memory>
 #include <random>
 #include <set>
@@ -13,6 +14,7 @@
 #include <utility>
 #include <vector>
 
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -57,4 +59,199 @@ TEST(LRUKReplacerTest, DISABLED_SampleTest) {
   lru_replacer.Evict(&value);
   lru_replacer.Eroll(2);
 }
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, EvictionOrderTest) {
+  LRUKReplacer lru_replacer(7, 2);
+
+  // Scenario: add six elements to the replacer. We have [1,2,3,4,5]. Frame 6 is non-evictable.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_replacer.RecordAccess(frame_id);
+  }
+  for (frame_id_t frame_id = 1; frame_id <= 5; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  lru_replacer.SetEvictable(6, false);
+  ASSERT_EQ(5, lru_replacer.Size());
+
+  // Scenario: Insert access history for frame 1. Now frame 1 has two access histories.
+  // All other frames have max backward k-dist. The order of eviction is [2,3,4,5,1].
+  lru_replacer.RecordAccess(1);
+
+  // Scenario: Evict three pages from the replacer. Elements with max k-distance should be popped
+  // first based on LRU.
+  int value;
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(4, value);
+  ASSERT_EQ(2, lru_replacer.Size());
+
+  // Scenario: Now replacer has frames [5,1]. Insert new frames 3, 4, and update access history for 5.
+  // We should end with [3,1,5,4].
+  lru_replacer.RecordAccess(3);
+  lru_replacer.RecordAccess(4);
+  lru_replacer.RecordAccess(5);
+  lru_replacer.RecordAccess(4);
+  lru_replacer.SetEvictable(3, true);
+  lru_replacer.SetEvictable(4, true);
+  ASSERT_EQ(4, lru_replacer.Size());
+
+  // Scenario: continue looking for victims. We expect 3 to be evicted next.
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_EQ(3, lru_replacer.Size());
+
+  // Set 6 to be evictable. 6 Should be evicted next since it has max backward k-dist.
+  lru_replacer.SetEvictable(6, true);
+  ASSERT_EQ(4, lru_replacer.Size());
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(6, value);
+  ASSERT_EQ(3, lru_replacer.Size());
+
+  // Now we have [1,5,4]. Continue looking for victims.
+  lru_replacer.SetEvictable(1, false);
+  ASSERT_EQ(2, lru_replacer.Size());
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(5, value);
+  ASSERT_EQ(1, lru_replacer.Size());
+
+  // Update access history for 1. Now we have [4,1]. Next victim is 4.
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.SetEvictable(1, true);
+  ASSERT_EQ(2, lru_replacer.Size());
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(value, 4);
+
+  ASSERT_EQ(1, lru_replacer.Size());
+  lru_replacer.Evict(&value);
+  ASSERT_EQ(value, 1);
+  ASSERT_EQ(0, lru_replacer.Size());
+
+  // These operations should not modify size
+  ASSERT_FALSE(lru_replacer.Evict(&value));
+  ASSERT_EQ(0, lru_replacer.Size());
+  lru_replacer.Remove(1);
+  ASSERT_EQ(0, lru_replacer.Size());
+
+  // Invalid frames and removing a pinned frame are rejected.
+  EXPECT_THROW(lru_replacer.RecordAccess(7), Exception);
+  lru_replacer.RecordAccess(2);
+  EXPECT_THROW(lru_replacer.Remove(2), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_replacer(8, 2);
+  int value;
+
+  // Scenario: frames 0-3 hold pages that were looked up once, so they all have +inf backward k-distance.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    lru_replacer.RecordAccess(frame_id, AccessType::Lookup);
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scenario: a sequential scan then streams through frames 4-7, touching every page twice.
+  for (frame_id_t frame_id = 4; frame_id < 8; frame_id++) {
+    lru_replacer.RecordAccess(frame_id, AccessType::Scan);
+    lru_replacer.RecordAccess(frame_id, AccessType::Scan);
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(8, lru_replacer.Size());
+
+  // Scenario: frame 5 is also read by a point lookup, which makes it a regular frame again.
+  lru_replacer.RecordAccess(5, AccessType::Lookup);
+
+  // Scan-only frames go first in load order, even though they are newer than the looked-up ones.
+  ASSERT_EQ((std::vector<frame_id_t>{4, 6, 7, 0, 1}), lru_replacer.EvictionCandidates(5));
+  ASSERT_EQ(8, lru_replacer.EvictionCandidates(100).size());
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(4, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(6, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(7, value);
+
+  // The remaining frames follow plain LRU-K order. Frame 5 has two accesses, so it is evicted last.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+    ASSERT_EQ(frame_id, value);
+  }
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(5, value);
+  ASSERT_EQ(0, lru_replacer.Size());
+
+  // Scenario: an evicted scan frame that is reused by a lookup is not treated as a scan frame.
+  lru_replacer.RecordAccess(4, AccessType::Lookup);
+  lru_replacer.RecordAccess(6, AccessType::Scan);
+  lru_replacer.SetEvictable(4, true);
+  lru_replacer.SetEvictable(6, true);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(6, value);
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, RandomizedAgainstReferenceTest) {
+  const size_t num_frames = 64;
+  const size_t k = 3;
+  LRUKReplacer lru_replacer(num_frames, k);
+
+  // A straightforward model of LRU-K: evict the evictable frame with the smallest kth most recent access, where frames
+  // with fewer than k accesses come first, ordered by their first access.
+  std::vector<std::vector<size_t>> history(num_frames);
+  std::vector<bool> evictable(num_frames, false);
+  size_t timestamp = 0;
+  auto reference_evict = [&]() -> frame_id_t {
+    frame_id_t victim = -1;
+    std::pair<bool, size_t> victim_key;
+    for (size_t i = 0; i < num_frames; i++) {
+      if (!evictable[i]) {
+        continue;
+      }
+      auto &h = history[i];
+      auto key = h.size() < k ? std::make_pair(false, h.front()) : std::make_pair(true, h[h.size() - k]);
+      if (victim == -1 || key < victim_key) {
+        victim = static_cast<frame_id_t>(i);
+        victim_key = key;
+      }
+    }
+    return victim;
+  };
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<frame_id_t> frame_dis(0, num_frames - 1);
+  std::uniform_int_distribution<int> op_dis(0, 9);
+  for (int round = 0; round < 20000; round++) {
+    auto frame_id = frame_dis(gen);
+    int op = op_dis(gen);
+    if (op < 6) {
+      lru_replacer.RecordAccess(frame_id);
+      history[frame_id].push_back(timestamp++);
+    } else if (op < 8) {
+      if (!history[frame_id].empty()) {
+        lru_replacer.SetEvictable(frame_id, op == 6);
+        evictable[frame_id] = op == 6;
+      }
+    } else if (op == 8) {
+      if (evictable[frame_id]) {
+        lru_replacer.Remove(frame_id);
+        history[frame_id].clear();
+        evictable[frame_id] = false;
+      }
+    } else {
+      frame_id_t victim;
+      auto expected = reference_evict();
+      ASSERT_EQ(expected != -1, lru_replacer.Evict(&victim));
+      if (expected != -1) {
+        ASSERT_EQ(expected, victim);
+        history[victim].clear();
+        evictable[victim] = false;
+      }
+    }
+    ASSERT_EQ(static_cast<size_t>(std::count(evictable.begin(), evictable.end(), true)), lru_replacer.Size());
+  }
+}
 }  // namespace bustub
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(4);
+  EXPECT_EQ(-1, page_table.Find(0));
+
+  page_table.Insert(0, 3);
+  page_table.Insert(8, 1);
+  page_table.Insert(16, 2);
+  EXPECT_EQ(3, page_table.Size());
+  EXPECT_EQ(3, page_table.Find(0));
+  EXPECT_EQ(1, page_table.Find(8));
+  EXPECT_EQ(2, page_table.Find(16));
+  EXPECT_EQ(-1, page_table.Find(1));
+
+  page_table.Erase(8);
+  page_table.Erase(42);
+  EXPECT_EQ(2, page_table.Size());
+  EXPECT_EQ(-1, page_table.Find(8));
+  EXPECT_EQ(2, page_table.Find(16));
+
+  auto page_ids = page_table.PageIds();
+  std::sort(page_ids.begin(), page_ids.end());
+  EXPECT_EQ((std::vector<page_id_t>{0, 16}), page_ids);
+}
+
+// NOLINTNEXTLINE
+// Erasing shifts entries back into the hole; every entry must stay reachable from its home slot.
+TEST(PageTableTest, RandomizedAgainstReferenceTest) {
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> reference;
+  std::vector<frame_id_t> free_frames;
+  for (size_t i = 0; i < num_frames; i++) {
+    free_frames.push_back(static_cast<frame_id_t>(i));
+  }
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 255);
+  for (size_t round = 0; round < 20000; round++) {
+    page_id_t page_id = page_dist(gen);
+    auto it = reference.find(page_id);
+    if (it != reference.end()) {
+      page_table.Erase(page_id);
+      free_frames.push_back(it->second);
+      reference.erase(it);
+    } else if (!free_frames.empty()) {
+      frame_id_t frame_id = free_frames.back();
+      free_frames.pop_back();
+      page_table.Insert(page_id, frame_id);
+      reference.emplace(page_id, frame_id);
+    }
+
+    ASSERT_EQ(reference.size(), page_table.Size());
+    if (round % 64 == 0) {
+      for (page_id_t probe = 0; probe < 256; probe++) {
+        auto expected = reference.find(probe);
+        ASSERT_EQ(expected == reference.end() ? -1 : expected->second, page_table.Find(probe));
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ReserveTest) {
+  PageTable page_table(2);
+  page_table.Insert(5, 0);
+  page_table.Insert(9, 1);
+
+  // Scenario: growing keeps the entries, and makes room for the frames of the larger pool.
+  page_table.Reserve(64);
+  for (frame_id_t frame_id = 2; frame_id < 64; frame_id++) {
+    page_table.Insert(100 + frame_id, frame_id);
+  }
+  EXPECT_EQ(64, page_table.Size());
+  EXPECT_EQ(0, page_table.Find(5));
+  EXPECT_EQ(1, page_table.Find(9));
+  EXPECT_EQ(63, page_table.Find(163));
+
+  // Scenario: reserving less than the table holds is a no-op.
+  page_table.Reserve(2);
+  EXPECT_EQ(64, page_table.Size());
+  EXPECT_EQ(0, page_table.Find(5));
+}
+
+}  // namespace bustub
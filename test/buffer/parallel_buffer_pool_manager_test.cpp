@@ -0,0 +1,204 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** Records the ranges the buffer pool advises it of. */
+class AdviceDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void AdvisePages(page_id_t page_id, size_t num_pages, DiskAccessHint hint) override {
+    std::scoped_lock lock(latch_);
+    advised_.emplace_back(page_id, num_pages);
+  }
+
+  auto Advised() -> std::vector<std::pair<page_id_t, size_t>> {
+    std::scoped_lock lock(latch_);
+    return advised_;
+  }
+
+ private:
+  std::mutex latch_;
+  std::vector<std::pair<page_id_t, size_t>> advised_;
+};
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const size_t num_instances = 5;
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get(), k);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: Pages are handed out round-robin, and each page id belongs to the instance it was allocated from.
+  for (size_t i = 1; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+  }
+
+  // Scenario: Once every instance is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(INVALID_PAGE_ID, page_id_temp);
+  }
+
+  // Scenario: Unpinning page 0 frees a frame in instance 0 only. NewPage has to find that instance.
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0, page_id_temp % static_cast<page_id_t>(num_instances));
+
+  // Scenario: We should be able to fetch the data we wrote a while ago, through a guard bound to instance 0.
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  {
+    auto guard = bpm->FetchPageRead(0);
+    EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+  }
+  EXPECT_TRUE(bpm->DeletePage(0));
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrentTest) {
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 64;
+  const size_t num_threads = 8;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get(), 2);
+
+  // Every instance has a frame for each thread, so no fetch can fail even if all threads land on the same instance.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+    page_ids.push_back(page_id);
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      for (size_t round = 0; round < num_pages * 4; round++) {
+        auto page_id = page_ids[(round * 13 + tid) % num_pages];
+        auto guard = bpm->FetchPageRead(page_id);
+        EXPECT_EQ("page-" + std::to_string(page_id), std::string(guard.GetData()));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: every fetch is counted once, as a hit or a miss, in the instance that owns the page.
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(num_threads * num_pages * 4, stats.hits_ + stats.misses_);
+  auto shard_stats = bpm->GetShardStats();
+  ASSERT_EQ(num_instances, shard_stats.size());
+  BufferPoolStats sum;
+  for (const auto &shard : shard_stats) {
+    EXPECT_EQ(num_threads * num_pages, shard.hits_ + shard.misses_);
+    sum += shard;
+  }
+  EXPECT_EQ(stats.hits_, sum.hits_);
+  EXPECT_EQ(stats.evictions_, sum.evictions_);
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get(), 2);
+  for (size_t i = 0; i < num_instances * buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+  }
+
+  // Scenario: the new size is split over the instances, the first ones taking the remainder.
+  bpm->Resize(10);
+  EXPECT_EQ(10, bpm->GetPoolSize());
+  for (page_id_t page_id : {0, 4, 8}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(12));
+  for (page_id_t page_id : {0, 4, 8}) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: every instance keeps at least one frame, and the pages survive a shrink.
+  EXPECT_THROW(bpm->Resize(num_instances - 1), Exception);
+  bpm->Resize(num_instances);
+  EXPECT_EQ(num_instances, bpm->GetPoolSize());
+  for (size_t i = 0; i < num_instances * buffer_pool_size; i++) {
+    auto guard = bpm->FetchPageRead(static_cast<page_id_t>(i));
+    EXPECT_EQ("page-" + std::to_string(i), std::string(guard.GetData()));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, PrefetchTest) {
+  const size_t num_instances = 3;
+  const size_t buffer_pool_size = 4;
+
+  auto disk_manager = std::make_unique<AdviceDiskManager>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get(), 2);
+  for (size_t i = 0; i < num_instances * buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "page-%d", page_id);
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: a range is advised once on the shared disk manager, and each page is prefetched in its own instance.
+  EXPECT_EQ(6, bpm->PrefetchRange(3, 6, AccessType::Scan));
+  EXPECT_EQ((std::vector<std::pair<page_id_t, size_t>>{{3, 6}}), disk_manager->Advised());
+  for (page_id_t page_id = 3; page_id < 9; page_id++) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(guard.GetData()));
+  }
+
+  // Scenario: the pages live in the instances, not in one array of the parallel pool.
+  EXPECT_THROW(bpm->GetPages(), NotImplementedException);
+  for (size_t i = 0; i < num_instances; i++) {
+    EXPECT_NE(nullptr, bpm->GetInstance(i)->GetPages());
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer_test.cpp
+//
+// Identification: test/buffer/two_q_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_q_replacer.h"
+
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TwoQReplacerTest, SampleTest) {
+  // Kin = 2 frames, Kout = 4 pages.
+  TwoQReplacer two_q_replacer(8);
+
+  // Scenario: load pages 100 to 103 into frames 0 to 3. They all go to A1in.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    two_q_replacer.RecordAccess(frame_id, AccessType::Lookup, 100 + frame_id);
+    two_q_replacer.SetEvictable(frame_id, true);
+  }
+  EXPECT_EQ(4, two_q_replacer.Size());
+
+  // Scenario: A1in is a FIFO, so a second access to frame 0 does not save it.
+  two_q_replacer.RecordAccess(0, AccessType::Lookup, 100);
+  frame_id_t value;
+  ASSERT_TRUE(two_q_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(two_q_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: page 100 is still in A1out, so reloading it goes to Am. A scan reloading page 101 goes to A1in.
+  two_q_replacer.RecordAccess(0, AccessType::Lookup, 100);
+  two_q_replacer.SetEvictable(0, true);
+  two_q_replacer.RecordAccess(1, AccessType::Scan, 101);
+  two_q_replacer.SetEvictable(1, true);
+
+  // A1in = {2, 3, 1} holds more than Kin frames, so it gives up one frame before Am = {0} is touched.
+  EXPECT_EQ((std::vector<frame_id_t>{2, 0, 3, 1}), two_q_replacer.EvictionCandidates(4));
+
+  // Scenario: pinned frames are skipped, and cannot be removed.
+  two_q_replacer.SetEvictable(2, false);
+  EXPECT_EQ((std::vector<frame_id_t>{3, 0, 1}), two_q_replacer.EvictionCandidates(4));
+  EXPECT_THROW(two_q_replacer.Remove(2), Exception);
+  two_q_replacer.SetEvictable(2, true);
+
+  // Scenario: removing a frame counts as an eviction, so page 103 goes to A1out and comes back in Am. A1in now holds
+  // only Kin frames, so Am is evicted from first.
+  two_q_replacer.Remove(3);
+  two_q_replacer.RecordAccess(3, AccessType::Index, 103);
+  two_q_replacer.SetEvictable(3, true);
+  EXPECT_EQ((std::vector<frame_id_t>{0, 3, 2, 1}), two_q_replacer.EvictionCandidates(4));
+  EXPECT_EQ(4, two_q_replacer.Size());
+  EXPECT_THROW(two_q_replacer.RecordAccess(8), Exception);
+}
+
+}  // namespace bustub
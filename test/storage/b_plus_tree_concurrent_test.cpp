@@ -402,6 +402,56 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest2) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(BPlusTreeConcurrentTest, OptimisticReadTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  // A small pool and small nodes, so that readers race with splits, merges and evictions.
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get(), 10);
+  page_id_t page_id;
+  bpm->NewPageGuarded(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm.get(), comparator, 3, 5);
+
+  // The odd keys stay in the tree, the even keys come and go.
+  std::vector<int64_t> stable_keys;
+  std::vector<int64_t> dynamic_keys;
+  for (int64_t key = 1; key <= 400; key++) {
+    (key % 2 == 1 ? stable_keys : dynamic_keys).push_back(key);
+  }
+  InsertHelper(&tree, stable_keys);
+
+  std::vector<std::thread> threads;
+  for (uint64_t tid = 0; tid < 2; tid++) {
+    threads.emplace_back([&] {
+      for (int round = 0; round < 3; round++) {
+        InsertHelper(&tree, dynamic_keys);
+        DeleteHelper(&tree, dynamic_keys);
+      }
+    });
+  }
+  for (uint64_t tid = 0; tid < 2; tid++) {
+    threads.emplace_back([&, tid] {
+      for (int round = 0; round < 5; round++) {
+        LookupHelper(&tree, stable_keys, tid);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<RID> result;
+  GenericKey<8> index_key;
+  for (auto key : dynamic_keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_FALSE(tree.GetValue(index_key, &result));
+  }
+  LookupHelper(&tree, stable_keys, 0);
+}
+
 TEST(BPlusTreeConcurrentTest, DISABLED_MixTest3) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
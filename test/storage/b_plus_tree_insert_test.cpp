@@ -12,11 +12,14 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <numeric>
+#include <random>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager_memory.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sorter.h"
 #include "storage/page/b_plus_tree_page.h"
 #include "test_util.h"  // NOLINT
 
@@ -191,4 +194,160 @@ TEST(BPlusTreeTests, DISABLED_InsertTest3) {
   delete transaction;
   delete bpm;
 }
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeTests, ExternalSortTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  ExternalSorter<GenericKey<8>, RID, GenericComparator<8>> sorter(comparator, 100);
+
+  // Every key twice, shuffled, and told apart by the slot of their RID: 0 for the first copy added, 1 for the second.
+  std::vector<int64_t> keys(1000);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  for (int copy = 0; copy < 2; copy++) {
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      sorter.Add(index_key, RID(static_cast<page_id_t>(key), copy));
+    }
+  }
+  sorter.Finish();
+  EXPECT_EQ(20U, sorter.GetNumRuns());
+
+  // Scenario: the runs merge into one sorted stream, in which equal keys keep the order they were added in.
+  RID rid;
+  for (int64_t key = 0; key < 1000; key++) {
+    for (int copy = 0; copy < 2; copy++) {
+      ASSERT_TRUE(sorter.Next(&index_key, &rid));
+      EXPECT_EQ(key, index_key.ToString());
+      EXPECT_EQ(key, rid.GetPageId());
+      EXPECT_EQ(copy, rid.GetSlotNum());
+    }
+  }
+  EXPECT_FALSE(sorter.Next(&index_key, &rid));
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeTests, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPageGuarded(&page_id).Drop();
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 5, 4);
+  auto *transaction = new Transaction(0);
+
+  // Load the even keys 0, 2, ..., 2000, with a duplicate of each key that the tree should skip.
+  const int64_t num_keys = 1001;
+  int64_t next_key = 0;
+  bool duplicate = false;
+  auto source = [&](GenericKey<8> *key, RID *rid) {
+    if (next_key == num_keys) {
+      return false;
+    }
+    key->SetFromInteger(next_key * 2);
+    rid->Set(0, static_cast<uint32_t>(next_key * 2 + (duplicate ? 1 : 0)));
+    next_key += duplicate ? 1 : 0;
+    duplicate = !duplicate;
+    return true;
+  };
+  EXPECT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.BulkLoad(source));
+  EXPECT_FALSE(tree.IsEmpty());
+
+  // Scenario: the leaves are full but for the last two, which share what is left, and are all at the same depth.
+  page_id_t leaf_id = tree.GetRootPageId();
+  int depth = 0;
+  while (true) {
+    auto guard = bpm->FetchPageRead(leaf_id);
+    auto *page = guard.As<BPlusTreePage>();
+    if (page->IsLeafPage()) {
+      break;
+    }
+    leaf_id = reinterpret_cast<const BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>> *>(page)
+                  ->ValueAt(0);
+    depth++;
+  }
+  EXPECT_EQ(4, depth);
+  std::vector<int> leaf_sizes;
+  while (leaf_id != INVALID_PAGE_ID) {
+    auto guard = bpm->FetchPageRead(leaf_id);
+    auto *leaf = guard.As<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>>();
+    leaf_sizes.push_back(leaf->GetSize());
+    leaf_id = leaf->GetNextPageId();
+  }
+  ASSERT_EQ(201U, leaf_sizes.size());
+  EXPECT_EQ(199, std::count(leaf_sizes.begin(), leaf_sizes.end(), 5));
+  EXPECT_EQ(3, leaf_sizes[199]);
+  EXPECT_EQ(3, leaf_sizes[200]);
+
+  GenericKey<8> index_key;
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key += 2;
+  }
+  EXPECT_EQ(num_keys * 2, current_key);
+
+  // Scenario: a tree that is not empty is not loaded again.
+  next_key = 0;
+  EXPECT_FALSE(tree.BulkLoad(source));
+  EXPECT_EQ(0, next_key);
+
+  // Scenario: the loaded tree takes inserts and removes like any other.
+  RID rid;
+  for (int64_t key = 1; key < num_keys * 2; key += 2) {
+    index_key.SetFromInteger(key);
+    rid.Set(0, static_cast<uint32_t>(key));
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  for (int64_t key = 0; key < num_keys * 2; key += 3) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys * 2; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key % 3 != 0, tree.GetValue(index_key, &rids)) << key;
+  }
+
+  delete transaction;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeTests, BulkLoadUnsortedTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPageGuarded(&page_id).Drop();
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 3);
+
+  // Scenario: entries out of order are refused, and the tree stays empty.
+  std::vector<int64_t> keys = {1, 2, 4, 3};
+  size_t next = 0;
+  EXPECT_THROW(tree.BulkLoad([&](GenericKey<8> *key, RID *rid) {
+    if (next == keys.size()) {
+      return false;
+    }
+    key->SetFromInteger(keys[next]);
+    rid->Set(0, static_cast<uint32_t>(keys[next++]));
+    return true;
+  }),
+               Exception);
+  EXPECT_TRUE(tree.IsEmpty());
+
+  // Scenario: nothing to load leaves the tree empty too.
+  EXPECT_TRUE(tree.BulkLoad([](GenericKey<8> * /* key */, RID * /* rid */) { return false; }));
+  EXPECT_TRUE(tree.IsEmpty());
+
+  delete bpm;
+}
 }  // namespace bustub
@@ -10,11 +10,19 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sys/stat.h>
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/disk/disk_manager_simulated.h"
 
 namespace bustub {
 
@@ -24,12 +32,14 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   };
 };
 
@@ -72,6 +82,338 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoReadWritePageTest) {
+  struct alignas(BUSTUB_PAGE_SIZE) AlignedBuffer {
+    char data_[BUSTUB_PAGE_SIZE * 2];
+  };
+  AlignedBuffer aligned{};
+  AlignedBuffer unaligned{};
+  char *buf = aligned.data_;
+  char *data = unaligned.data_ + 1;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, true);
+  std::strncpy(data, "A test string.", BUSTUB_PAGE_SIZE);
+
+  dm.ReadPage(0, buf);  // tolerate empty read
+  EXPECT_EQ(0, buf[0]);
+
+  // Scenario: an unaligned buffer goes through a bounce buffer.
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data, BUSTUB_PAGE_SIZE), 0);
+
+  std::memset(data, 0, BUSTUB_PAGE_SIZE);
+  dm.WritePage(5, buf);
+  dm.ReadPage(5, data);
+  EXPECT_EQ(std::memcmp(buf, data, BUSTUB_PAGE_SIZE), 0);
+
+  // Scenario: the pages are in the file at the same place as without direct I/O.
+  dm.ShutDown();
+  auto buffered = DiskManager(db_file);
+  std::memset(buf, 0, BUSTUB_PAGE_SIZE);
+  buffered.ReadPage(5, buf);
+  EXPECT_STREQ("A test string.", buf);
+  buffered.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  struct alignas(BUSTUB_PAGE_SIZE) AlignedPages {
+    char data_[BUSTUB_PAGE_SIZE * 3];
+  };
+  AlignedPages pages{};
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  for (int i = 0; i < 3; i++) {
+    snprintf(pages.data_ + i * BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE, "page-%d", i + 4);
+  }
+  std::vector<const char *> run{pages.data_, pages.data_ + BUSTUB_PAGE_SIZE, pages.data_ + 2 * BUSTUB_PAGE_SIZE};
+
+  // Scenario: a run lands on consecutive pages, with and without O_DIRECT.
+  for (bool direct_io : {false, true}) {
+    auto dm = DiskManager(db_file, direct_io);
+    dm.WritePages(4, run);
+    EXPECT_EQ(3, dm.GetNumWrites());
+    for (int i = 0; i < 3; i++) {
+      std::memset(buf, 0, sizeof(buf));
+      dm.ReadPage(4 + i, buf);
+      EXPECT_EQ("page-" + std::to_string(4 + i), std::string(buf));
+    }
+    dm.ShutDown();
+    remove("test.db");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreeMapPageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  std::strncpy(data, "A free-page map.", sizeof(data));
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_FALSE(dm.ReadFreeMapPage(0, buf));
+    dm.WriteFreeMapPage(1, data);
+    EXPECT_TRUE(dm.ReadFreeMapPage(1, buf));
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm.ShutDown();
+  }
+
+  // Scenario: the map is kept next to an existing database file.
+  {
+    auto dm = DiskManager(db_file);
+    std::memset(buf, 0, sizeof(buf));
+    EXPECT_TRUE(dm.ReadFreeMapPage(1, buf));
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm.ShutDown();
+  }
+
+  // Scenario: a new database file starts with an empty map.
+  remove("test.db");
+  auto dm = DiskManager(db_file);
+  EXPECT_FALSE(dm.ReadFreeMapPage(1, buf));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWriteTest) {
+  const int num_threads = 8;
+  const int pages_per_thread = 64;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: threads write and read their own pages at the same time, with no file offset shared between them.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&dm, tid] {
+      char data[BUSTUB_PAGE_SIZE] = {0};
+      char buf[BUSTUB_PAGE_SIZE] = {0};
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id = i * num_threads + tid;
+        snprintf(data, sizeof(data), "page-%d", page_id);
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::string(data), std::string(buf));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < num_threads * pages_per_thread; page_id++) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(buf));
+  }
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SyncPagesTest) {
+  const int num_threads = 8;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: one call syncs the db file and the free-page map file.
+  dm.SyncPages();
+  EXPECT_EQ(2, dm.GetNumSyncs());
+
+  // Scenario: concurrent calls share their syncs; no call needs more than one round of its own.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&dm] { dm.SyncPages(); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(dm.GetNumSyncs(), 2 + 2 * num_threads);
+  EXPECT_GE(dm.GetNumSyncs(), 4);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MmapReadWritePageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char zeroes[BUSTUB_PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+  const auto far_page = static_cast<page_id_t>(DiskManagerMmap::EXTENT_PAGES * 2 + 3);
+  {
+    DiskManagerMmap dm("test.db");
+    EXPECT_EQ(dm.GetFileDescriptor(), -1);
+    std::memset(buf, 1, sizeof(buf));
+    dm.ReadPage(0, buf);  // a page past the end of the file reads as zeroes
+    EXPECT_EQ(std::memcmp(buf, zeroes, sizeof(buf)), 0);
+    EXPECT_EQ(dm.GetMappedPages(), 0);
+
+    dm.WritePage(0, data);
+    dm.ReadPage(0, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    EXPECT_EQ(dm.GetMappedPages(), DiskManagerMmap::EXTENT_PAGES);
+
+    // Growing by two extents keeps the pages mapped so far, and the pages in between read as zeroes.
+    dm.WritePages(far_page, {data, data});
+    dm.ReadPage(far_page + 1, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm.ReadPage(far_page - 1, buf);
+    EXPECT_EQ(std::memcmp(buf, zeroes, sizeof(buf)), 0);
+    dm.ReadPage(0, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    EXPECT_EQ(dm.GetMappedPages(), DiskManagerMmap::EXTENT_PAGES * 3);
+    EXPECT_EQ(dm.GetNumWrites(), 3);
+
+    dm.AdvisePages(0, DiskManagerMmap::EXTENT_PAGES * 4, DiskAccessHint::Sequential);
+    dm.AdvisePages(far_page, 2, DiskAccessHint::WillNeed);
+    dm.SyncPages();
+    dm.ShutDown();
+  }
+
+  // The pages are in the file: both kinds of disk manager read them back.
+  {
+    DiskManager dm("test.db");
+    dm.ReadPage(far_page, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm.ShutDown();
+  }
+  {
+    DiskManagerMmap dm("test.db");
+    EXPECT_EQ(dm.GetMappedPages(), DiskManagerMmap::EXTENT_PAGES * 3);
+    dm.ReadPage(far_page, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm.ShutDown();
+  }
+
+  // Opening a database leaves its file as it is; only a write past its end extends it.
+  remove("test.db");
+  {
+    DiskManager dm("test.db");
+    dm.WritePage(4, data);
+    dm.ShutDown();
+  }
+  struct stat stat_buf;
+  {
+    DiskManagerMmap dm("test.db");
+    ASSERT_EQ(stat("test.db", &stat_buf), 0);
+    EXPECT_EQ(stat_buf.st_size, 5 * BUSTUB_PAGE_SIZE);
+    dm.ReadPage(4, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    std::memset(buf, 1, sizeof(buf));
+    dm.ReadPage(5, buf);
+    EXPECT_EQ(std::memcmp(buf, zeroes, sizeof(buf)), 0);
+    ASSERT_EQ(stat("test.db", &stat_buf), 0);
+    EXPECT_EQ(stat_buf.st_size, 5 * BUSTUB_PAGE_SIZE);
+
+    dm.WritePage(7, data);
+    dm.ReadPage(7, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    ASSERT_EQ(stat("test.db", &stat_buf), 0);
+    EXPECT_EQ(stat_buf.st_size, DiskManagerMmap::EXTENT_PAGES * BUSTUB_PAGE_SIZE);
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SimulatedDeviceTest) {
+  auto ssd = DeviceProfile::Parse("ssd,channels=2,read_us=1000");
+  EXPECT_EQ(ssd.channels_, 2U);
+  EXPECT_EQ(ssd.random_read_latency_, std::chrono::microseconds(1000));
+  EXPECT_EQ(ssd.random_write_latency_, std::chrono::microseconds(60));
+  EXPECT_EQ(ssd.sequential_read_latency_, std::chrono::microseconds(1000));
+  EXPECT_EQ(ssd.sequential_write_latency_, std::chrono::microseconds(60));
+  auto none = DeviceProfile::Parse("none,read_us=100,seq_write_us=5,write_us=30");
+  EXPECT_EQ(none.sequential_read_latency_, std::chrono::microseconds(100));
+  EXPECT_EQ(none.sequential_write_latency_, std::chrono::microseconds(5));
+  auto hdd = DeviceProfile::Parse("hdd,read_us=1000");
+  EXPECT_EQ(hdd.sequential_read_latency_, std::chrono::microseconds(50));
+  auto round_trip = DeviceProfile::Parse(ssd.ToString());
+  EXPECT_EQ(round_trip.ToString(), ssd.ToString());
+  EXPECT_THROW(DeviceProfile::Parse("floppy"), Exception);
+  EXPECT_THROW(DeviceProfile::Parse("ssd,read_us"), Exception);
+  EXPECT_THROW(DeviceProfile::Parse("ssd,read_us=fast"), Exception);
+  EXPECT_THROW(DeviceProfile::Parse("ssd,color=3"), Exception);
+
+  DeviceProfile profile = DeviceProfile::Parse("none,read_us=2000,write_us=1000,seq_read_us=0");
+  DiskManagerSimulated dm(profile);
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  auto start = std::chrono::steady_clock::now();
+  dm.WritePage(5, data);
+  dm.ReadPage(5, buf);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::microseconds(3000));
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // Reading page 6 right after page 5 is sequential, and costs nothing with seq_read_us=0.
+  dm.ReadPage(6, buf);
+  dm.ReadPage(7, buf);
+  EXPECT_EQ(dm.GetNumSequential(), 2U);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SegmentTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char zeroes[BUSTUB_PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+  const page_id_t segment_page = MakeSegmentPageId(1, 2);
+
+  DiskManager dm("test.db");
+  EXPECT_THROW(dm.CreateSegment(DEFAULT_SEGMENT_ID), Exception);
+  EXPECT_THROW(dm.CreateSegment(MAX_SEGMENT_ID + 1), Exception);
+  EXPECT_THROW(dm.DropSegment(DEFAULT_SEGMENT_ID), Exception);
+
+  // A segment without a file reads as zeroes.
+  dm.WritePage(segment_page, data);
+  dm.ReadPage(segment_page, buf);
+  EXPECT_EQ(std::memcmp(buf, zeroes, sizeof(buf)), 0);
+
+  // The pages of a segment are numbered from 0 in a file of its own.
+  dm.CreateSegment(1);
+  dm.CreateSegment(2, ".");
+  EXPECT_EQ(dm.GetSegmentFileName(1), "test.db.1");
+  EXPECT_EQ(dm.GetSegmentFileName(2), "./test.db.2");
+  dm.WritePage(segment_page, data);
+  dm.WritePages(MakeSegmentPageId(2, 0), {data, data});
+  dm.ReadPage(segment_page, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  dm.ReadPage(MakeSegmentPageId(2, 1), buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  dm.ReadPage(2, buf);
+  EXPECT_EQ(std::memcmp(buf, zeroes, sizeof(buf)), 0);
+  struct stat stat_buf;
+  ASSERT_EQ(stat("test.db.1", &stat_buf), 0);
+  EXPECT_EQ(stat_buf.st_size, 3 * BUSTUB_PAGE_SIZE);
+  off_t offset;
+  EXPECT_GE(dm.GetPageFile(segment_page, &offset), 0);
+  EXPECT_EQ(offset, 2 * BUSTUB_PAGE_SIZE);
+  dm.SyncPages();
+
+  // Dropping a segment unlinks its file.
+  dm.DropSegment(1);
+  EXPECT_NE(stat("test.db.1", &stat_buf), 0);
+  EXPECT_EQ(dm.GetSegmentFileName(1), "");
+  EXPECT_LT(dm.GetPageFile(segment_page, &offset), 0);
+  dm.ReadPage(segment_page, buf);
+  EXPECT_EQ(std::memcmp(buf, zeroes, sizeof(buf)), 0);
+  dm.DropSegment(2);
+
+  // ShutDown() and the destructor remove the files of the segments that are left.
+  dm.CreateSegment(3);
+  ASSERT_EQ(stat("test.db.3", &stat_buf), 0);
+  dm.ShutDown();
+  EXPECT_NE(stat("test.db.3", &stat_buf), 0);
+  {
+    DiskManager other("test.db");
+    other.CreateSegment(4);
+    ASSERT_EQ(stat("test.db.4", &stat_buf), 0);
+  }
+  EXPECT_NE(stat("test.db.4", &stat_buf), 0);
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
@@ -10,12 +10,18 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdio>
+#include <chrono>  // NOLINT
 #include <cstring>
 #include <future>  // NOLINT
 #include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
 #include "storage/disk/disk_scheduler.h"
 
@@ -24,7 +30,7 @@ namespace bustub {
 using bustub::DiskManagerUnlimitedMemory;
 
 // NOLINTNEXTLINE
-TEST(DiskSchedulerTest, DISABLED_ScheduleWriteReadPageTest) {
+TEST(DiskSchedulerTest, ScheduleWriteReadPageTest) {
   char buf[BUSTUB_PAGE_SIZE] = {0};
   char data[BUSTUB_PAGE_SIZE] = {0};
 
@@ -49,4 +55,205 @@ TEST(DiskSchedulerTest, DISABLED_ScheduleWriteReadPageTest) {
   dm->ShutDown();
 }
 
+/** Writes and then reads back the same pages without waiting in between; every read must see the write before it. */
+void CheckScheduleOrdering(DiskManager *dm, DiskSchedulerBackend backend) {
+  const size_t num_pages = 16;
+  const int rounds = 4;
+  DiskScheduler disk_scheduler(dm, {backend, 8});
+  std::vector<std::vector<char>> written(num_pages * rounds, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::vector<char>> read(num_pages * rounds, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::future<bool>> futures;
+
+  for (int round = 0; round < rounds; round++) {
+    for (size_t page = 0; page < num_pages; page++) {
+      auto &data = written[round * num_pages + page];
+      snprintf(data.data(), data.size(), "page %zu round %d", page, round);
+      auto promise = disk_scheduler.CreatePromise();
+      futures.push_back(promise.get_future());
+      disk_scheduler.Schedule({true, data.data(), static_cast<page_id_t>(page), std::move(promise)});
+      auto read_promise = disk_scheduler.CreatePromise();
+      futures.push_back(read_promise.get_future());
+      disk_scheduler.Schedule(
+          {false, read[round * num_pages + page].data(), static_cast<page_id_t>(page), std::move(read_promise)});
+    }
+  }
+  for (auto &future : futures) {
+    ASSERT_TRUE(future.get());
+  }
+  for (size_t i = 0; i < written.size(); i++) {
+    ASSERT_EQ(written[i], read[i]) << DiskSchedulerBackendName(backend) << ", request " << i;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, BackendOrderingTest) {
+  for (auto backend : {DiskSchedulerBackend::Serial, DiskSchedulerBackend::IoUring, DiskSchedulerBackend::ThreadPool}) {
+    auto memory_dm = std::make_unique<DiskManagerUnlimitedMemory>();
+    CheckScheduleOrdering(memory_dm.get(), backend);
+    // Without a file descriptor, io_uring falls back to the thread pool.
+    {
+      DiskScheduler disk_scheduler(memory_dm.get(), {backend, 4});
+      EXPECT_EQ(disk_scheduler.GetBackend(),
+                backend == DiskSchedulerBackend::Serial ? backend : DiskSchedulerBackend::ThreadPool);
+    }
+    memory_dm->ShutDown();
+
+    remove("test.db");
+    auto file_dm = std::make_unique<DiskManager>("test.db");
+    CheckScheduleOrdering(file_dm.get(), backend);
+    file_dm->ShutDown();
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+}
+
+/** Holds the serial worker of a DiskScheduler on one request until Release(), so that requests pile up behind it. */
+class BlockedScheduler {
+ public:
+  explicit BlockedScheduler(DiskManager *dm, std::chrono::microseconds max_queue_wait = std::chrono::seconds(10))
+      : scheduler_(dm, {DiskSchedulerBackend::Serial, 1, max_queue_wait}) {
+    auto release = release_.get_future().share();
+    std::promise<void> started;
+    auto blocked = started.get_future();
+    scheduler_.Schedule({false, blocker_, 1000, scheduler_.CreatePromise(),
+                         [release, started = std::make_shared<std::promise<void>>(std::move(started))](bool) {
+                           started->set_value();
+                           release.wait();
+                         }});
+    blocked.wait();
+  }
+
+  /** @brief Schedule a request that records its page in Order() when it completes, before its future is ready. */
+  auto Schedule(bool is_write, char *data, page_id_t page_id, DiskRequestPriority priority) -> std::future<bool> {
+    auto recorded = std::make_shared<std::promise<bool>>();
+    auto future = recorded->get_future();
+    scheduler_.Schedule({is_write, data, page_id, scheduler_.CreatePromise(),
+                         [this, page_id, recorded](bool ok) {
+                           {
+                             std::lock_guard<std::mutex> lock(latch_);
+                             order_.push_back(page_id);
+                           }
+                           recorded->set_value(ok);
+                         },
+                         priority});
+    return future;
+  }
+
+  void Release() { release_.set_value(); }
+
+  auto Order() -> std::vector<page_id_t> {
+    std::lock_guard<std::mutex> lock(latch_);
+    return order_;
+  }
+
+  auto Scheduler() -> DiskScheduler & { return scheduler_; }
+
+ private:
+  char blocker_[BUSTUB_PAGE_SIZE];
+  std::promise<void> release_;
+  std::mutex latch_;
+  std::vector<page_id_t> order_;
+  /** Last, so that its worker is joined before the members that its requests use are gone. */
+  DiskScheduler scheduler_;
+};
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, PriorityTest) {
+  auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::vector<std::future<bool>> futures;
+  {
+    BlockedScheduler blocked(dm.get());
+    for (page_id_t page_id = 0; page_id < 4; page_id++) {
+      futures.push_back(blocked.Schedule(true, buf, page_id, DiskRequestPriority::Background));
+    }
+    futures.push_back(blocked.Schedule(false, buf, 10, DiskRequestPriority::Prefetch));
+    futures.push_back(blocked.Schedule(false, buf, 11, DiskRequestPriority::Prefetch));
+    futures.push_back(blocked.Schedule(false, buf, 20, DiskRequestPriority::Foreground));
+    // A prefetch that a query now waits for moves to the foreground queue.
+    blocked.Scheduler().Expedite(11);
+
+    auto stats = blocked.Scheduler().GetStats();
+    EXPECT_EQ(stats.queues_[static_cast<size_t>(DiskRequestPriority::Foreground)].depth_, 2);
+    EXPECT_EQ(stats.queues_[static_cast<size_t>(DiskRequestPriority::Prefetch)].depth_, 1);
+    EXPECT_EQ(stats.queues_[static_cast<size_t>(DiskRequestPriority::Background)].depth_, 4);
+    EXPECT_EQ(stats.expedited_, 1);
+
+    blocked.Release();
+    for (auto &future : futures) {
+      ASSERT_TRUE(future.get());
+    }
+    EXPECT_EQ(blocked.Order(), std::vector<page_id_t>({20, 11, 10, 0, 1, 2, 3}));
+    stats = blocked.Scheduler().GetStats();
+    EXPECT_EQ(stats.queues_[static_cast<size_t>(DiskRequestPriority::Background)].dequeued_, 4);
+    EXPECT_EQ(stats.queues_[static_cast<size_t>(DiskRequestPriority::Background)].max_depth_, 4);
+    EXPECT_EQ(stats.starved_, 0);
+  }
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, StarvationTest) {
+  auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  {
+    BlockedScheduler blocked(dm.get(), std::chrono::milliseconds(1));
+    auto background = blocked.Schedule(true, buf, 0, DiskRequestPriority::Background);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto foreground = blocked.Schedule(false, buf, 1, DiskRequestPriority::Foreground);
+    blocked.Release();
+    ASSERT_TRUE(background.get());
+    ASSERT_TRUE(foreground.get());
+    // The write had waited for longer than the limit, so it went ahead of the read.
+    EXPECT_EQ(blocked.Order(), std::vector<page_id_t>({0, 1}));
+    auto stats = blocked.Scheduler().GetStats();
+    EXPECT_EQ(stats.starved_, 1);
+    EXPECT_GE(stats.queues_[static_cast<size_t>(DiskRequestPriority::Background)].max_wait_,
+              std::chrono::milliseconds(10));
+  }
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, MergeAndSamePageOrderTest) {
+  auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+  char first[BUSTUB_PAGE_SIZE] = {0};
+  char second[BUSTUB_PAGE_SIZE] = {0};
+  char read[BUSTUB_PAGE_SIZE] = {0};
+  char other[BUSTUB_PAGE_SIZE] = {0};
+  std::strncpy(first, "first", sizeof(first));
+  std::strncpy(second, "second", sizeof(second));
+  {
+    BlockedScheduler blocked(dm.get());
+    // Two writes in a row to page 0: only the second one reaches the disk, and both complete.
+    auto write1 = blocked.Schedule(true, first, 0, DiskRequestPriority::Background);
+    auto write2 = blocked.Schedule(true, second, 0, DiskRequestPriority::Foreground);
+    // A read between two writes of page 1 keeps them apart, and a foreground read of page 1 does not overtake the
+    // background write before it.
+    auto write3 = blocked.Schedule(true, first, 1, DiskRequestPriority::Background);
+    auto read1 = blocked.Schedule(false, read, 1, DiskRequestPriority::Foreground);
+    auto write4 = blocked.Schedule(true, second, 1, DiskRequestPriority::Background);
+
+    auto stats = blocked.Scheduler().GetStats();
+    EXPECT_EQ(stats.queues_[static_cast<size_t>(DiskRequestPriority::Foreground)].merged_, 1);
+    // The merged write moved up to the foreground queue.
+    EXPECT_EQ(stats.queues_[static_cast<size_t>(DiskRequestPriority::Foreground)].depth_, 2);
+    EXPECT_EQ(stats.queues_[static_cast<size_t>(DiskRequestPriority::Background)].depth_, 2);
+
+    blocked.Release();
+    for (auto *future : {&write1, &write2, &write3, &read1, &write4}) {
+      ASSERT_TRUE(future->get());
+    }
+    EXPECT_EQ(std::strcmp(read, "first"), 0);
+    EXPECT_EQ(blocked.Order(), std::vector<page_id_t>({0, 0, 1, 1, 1}));
+    EXPECT_EQ(blocked.Scheduler().GetStats().promoted_, 1);
+  }
+  dm->ReadPage(0, other);
+  EXPECT_EQ(std::strcmp(other, "second"), 0);
+  dm->ReadPage(1, other);
+  EXPECT_EQ(std::strcmp(other, "second"), 0);
+  dm->ShutDown();
+}
+
 }  // namespace bustub
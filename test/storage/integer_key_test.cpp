@@ -0,0 +1,242 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// integer_key_test.cpp
+//
+// Identification: test/storage/integer_key_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/integer_key.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(IntegerKeyTest, PairOrderTest) {
+  auto schema = ParseCreateStatement("a integer,b integer");
+  // INT32_MIN is how BusTub stores a null INTEGER.
+  const std::vector<int32_t> values = {INT32_MIN, -65536, -1, 0, 1, 65536, INT32_MAX};
+  std::vector<std::pair<int32_t, int32_t>> pairs;
+  for (auto a : values) {
+    for (auto b : values) {
+      pairs.emplace_back(a, b);
+    }
+  }
+
+  // Scenario: packed pair keys compare as the pairs do, first column first.
+  IntegerComparator<IntegerPairKey> comparator;
+  for (const auto &lhs : pairs) {
+    for (const auto &rhs : pairs) {
+      IntegerPairKey lhs_key;
+      IntegerPairKey rhs_key;
+      lhs_key.SetFromKey(
+          Tuple({ValueFactory::GetIntegerValue(lhs.first), ValueFactory::GetIntegerValue(lhs.second)}, schema.get()),
+          *schema);
+      rhs_key.SetFromKey(
+          Tuple({ValueFactory::GetIntegerValue(rhs.first), ValueFactory::GetIntegerValue(rhs.second)}, schema.get()),
+          *schema);
+      const int expected = lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+      ASSERT_EQ(expected, comparator(lhs_key, rhs_key))
+          << "(" << lhs.first << "," << lhs.second << ") vs (" << rhs.first << "," << rhs.second << ")";
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(IntegerKeyTest, BPlusTreeTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  // Small pages, so that the keys and values of every page are split, borrowed and merged.
+  BPlusTree<IntegerKey<int64_t>, RID, IntegerComparator<IntegerKey<int64_t>>> tree(
+      "foo_pk", header_page->GetPageId(), bpm.get(), IntegerComparator<IntegerKey<int64_t>>(), 3, 5);
+
+  std::vector<int64_t> keys;
+  for (int64_t i = -500; i < 500; i++) {
+    keys.push_back(i * 3);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  IntegerKey<int64_t> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, RID(static_cast<int32_t>(key), 0)));
+  }
+  for (auto key : keys) {
+    if (key % 2 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, nullptr);
+    }
+  }
+
+  // Scenario: every key left is found with its value, and the removed ones are gone.
+  std::vector<RID> result;
+  for (auto key : keys) {
+    result.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(key % 2 == 0, tree.GetValue(index_key, &result)) << key;
+    if (key % 2 == 0) {
+      EXPECT_EQ(key, result[0].GetPageId());
+    }
+  }
+
+  // Scenario: the leaves hold the keys in order.
+  int64_t expected = -1500;
+  size_t count = 0;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    EXPECT_EQ(expected, (*iter).first.value_);
+    EXPECT_EQ(expected, (*iter).second.GetPageId());
+    expected += 6;
+    count++;
+  }
+  EXPECT_EQ(500U, count);
+}
+
+// NOLINTNEXTLINE
+TEST(IntegerKeyTest, ScanRangeTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  // Small pages, so that a range spans many leaves.
+  BPlusTree<IntegerKey<int32_t>, RID, IntegerComparator<IntegerKey<int32_t>>> tree(
+      "foo_pk", header_page->GetPageId(), bpm.get(), IntegerComparator<IntegerKey<int32_t>>(), 4, 5);
+
+  IntegerKey<int32_t> lo;
+  IntegerKey<int32_t> hi;
+  std::vector<RID> batch;
+  // Scenario: an empty tree has nothing in any range.
+  EXPECT_FALSE(tree.ScanRange(nullptr, true, nullptr, true).NextBatch(&batch));
+
+  // The even keys of [0, 200).
+  std::vector<int32_t> keys;
+  for (int32_t i = 0; i < 100; i++) {
+    keys.push_back(i * 2);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  IntegerKey<int32_t> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, RID(key, 0)));
+  }
+
+  // Scenario: every range, bounded or not and inclusive or not, returns the keys in it in order, a batch per leaf.
+  for (int32_t lo_key = -2; lo_key <= 201; lo_key += 3) {
+    for (int32_t hi_key = lo_key - 2; hi_key <= 201; hi_key += 7) {
+      for (int bounds = 0; bounds < 16; bounds++) {
+        const bool lo_bounded = (bounds & 1) != 0;
+        const bool hi_bounded = (bounds & 2) != 0;
+        const bool lo_inclusive = (bounds & 4) != 0;
+        const bool hi_inclusive = (bounds & 8) != 0;
+        lo.SetFromInteger(lo_key);
+        hi.SetFromInteger(hi_key);
+        std::vector<int32_t> expected;
+        for (int32_t key = 0; key < 200; key += 2) {
+          const bool above_lo = !lo_bounded || key > lo_key || (lo_inclusive && key == lo_key);
+          const bool below_hi = !hi_bounded || key < hi_key || (hi_inclusive && key == hi_key);
+          if (above_lo && below_hi) {
+            expected.push_back(key);
+          }
+        }
+        std::vector<int32_t> scanned;
+        auto iter = tree.ScanRange(lo_bounded ? &lo : nullptr, lo_inclusive, hi_bounded ? &hi : nullptr, hi_inclusive);
+        while (iter.NextBatch(&batch)) {
+          ASSERT_LE(batch.size(), 4U);
+          for (const auto &rid : batch) {
+            scanned.push_back(rid.GetPageId());
+          }
+        }
+        EXPECT_TRUE(batch.empty());
+        ASSERT_EQ(expected, scanned) << "lo=" << lo_key << " hi=" << hi_key << " bounds=" << bounds;
+      }
+    }
+  }
+
+  // Scenario: removes between batches merge away the next leaf; the scan picks up after the last key it returned.
+  auto iter = tree.ScanRange(nullptr, true, nullptr, true);
+  ASSERT_TRUE(iter.NextBatch(&batch));
+  std::vector<int32_t> scanned;
+  for (const auto &rid : batch) {
+    scanned.push_back(rid.GetPageId());
+  }
+  const int32_t last = scanned.back();
+  for (int32_t key = last + 2; key < last + 40; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, nullptr);
+  }
+  while (iter.NextBatch(&batch)) {
+    for (const auto &rid : batch) {
+      scanned.push_back(rid.GetPageId());
+    }
+  }
+  std::vector<int32_t> expected;
+  for (int32_t key = 0; key < 200; key += 2) {
+    if (key <= last || key >= last + 40) {
+      expected.push_back(key);
+    }
+  }
+  EXPECT_EQ(expected, scanned);
+}
+
+// NOLINTNEXTLINE
+TEST(IntegerKeyTest, CatalogTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Catalog catalog(bpm.get(), nullptr, nullptr);
+  auto schema = ParseCreateStatement("a integer,b bigint,c varchar(8),d smallint");
+  auto *table_info = catalog.CreateTable(nullptr, "t", *schema);
+  for (int32_t i = 0; i < 100; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetBigIntValue(int64_t{i} << 40),
+                 ValueFactory::GetVarcharValue(std::to_string(i)), ValueFactory::GetSmallIntValue(-i)},
+                schema.get());
+    table_info->table_->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuple);
+  }
+
+  auto create_index = [&](const std::string &name, const std::vector<uint32_t> &key_attrs) {
+    auto key_schema = Schema::CopySchema(schema.get(), key_attrs);
+    return catalog.CreateIndex(nullptr, name, "t", *schema, key_schema, key_attrs);
+  };
+
+  // Scenario: the key type is picked from the key schema.
+  auto *a_index = create_index("a", {0});
+  auto *b_index = create_index("b", {1});
+  auto *ad_index = create_index("ad", {0, 3});
+  auto *c_index = create_index("c", {2});
+  EXPECT_NE(nullptr, dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(a_index->index_.get()));
+  EXPECT_NE(nullptr, dynamic_cast<BPlusTreeIndexForOneBigintColumn *>(b_index->index_.get()));
+  EXPECT_NE(nullptr, dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(ad_index->index_.get()));
+  EXPECT_NE(nullptr, dynamic_cast<BPlusTreeIndexForNormalizedKey *>(c_index->index_.get()));
+
+  // Scenario: each index was loaded with the table and finds every row.
+  std::vector<RID> result;
+  for (auto iter = table_info->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [meta, tuple] = iter.GetTuple();
+    for (auto *index_info : {a_index, b_index, ad_index, c_index}) {
+      result.clear();
+      index_info->index_->ScanKey(
+          tuple.KeyFromTuple(*schema, index_info->key_schema_, index_info->index_->GetKeyAttrs()), &result, nullptr);
+      ASSERT_EQ(1U, result.size()) << index_info->name_;
+      EXPECT_EQ(tuple.GetRid(), result[0]);
+    }
+  }
+}
+
+}  // namespace bustub
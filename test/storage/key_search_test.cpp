@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search_test.cpp
+//
+// Identification: test/storage/key_search_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/index/key_search.h"
+
+namespace bustub {
+
+/** Search sorted arrays of every size up to a page of keys, with repeated keys, as std::upper_bound does. */
+template <typename T>
+void CheckUpperBound(std::mt19937 *rng) {
+  std::uniform_int_distribution<T> dist(-1000, 1000);
+  for (int n = 0; n <= 520; n++) {
+    std::vector<T> keys(n);
+    for (auto &key : keys) {
+      key = dist(*rng);
+    }
+    if (n > 0) {
+      keys[0] = std::numeric_limits<T>::min();
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<T> probes = {std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), -1001, 1001};
+    for (auto key : keys) {
+      if (key > std::numeric_limits<T>::min()) {
+        probes.push_back(key - 1);
+      }
+      probes.push_back(key);
+    }
+    for (auto probe : probes) {
+      const auto expected = std::upper_bound(keys.begin(), keys.end(), probe) - keys.begin();
+      ASSERT_EQ(expected, KeyUpperBound(keys.data(), n, probe)) << "n=" << n << " key=" << probe;
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(KeySearchTest, UpperBoundTest) {
+  const KeySearchIsa detected = DetectKeySearchIsa();
+  EXPECT_EQ(detected, GetKeySearchIsa());
+
+  // Scenario: every instruction set this CPU has finds the same upper bounds as std::upper_bound.
+  std::mt19937 rng(15445);
+  for (auto isa : {KeySearchIsa::Scalar, KeySearchIsa::Sse42, KeySearchIsa::Avx2}) {
+    if (static_cast<int>(isa) > static_cast<int>(detected)) {
+      EXPECT_THROW(SetKeySearchIsa(isa), Exception);
+      continue;
+    }
+    SetKeySearchIsa(isa);
+    EXPECT_EQ(isa, GetKeySearchIsa());
+    SCOPED_TRACE(KeySearchIsaName(isa));
+    CheckUpperBound<int32_t>(&rng);
+    CheckUpperBound<int64_t>(&rng);
+  }
+  SetKeySearchIsa(detected);
+}
+
+}  // namespace bustub
@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key_test.cpp
+//
+// Identification: test/storage/normalized_key_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/normalized_key.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Compare two key tuples column by column, with nulls first: the order that normalized keys should have. */
+static auto CompareTuples(const Tuple &lhs, const Tuple &rhs, const Schema &schema) -> int {
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    Value lhs_value = lhs.GetValue(&schema, i);
+    Value rhs_value = rhs.GetValue(&schema, i);
+    if (lhs_value.IsNull() || rhs_value.IsNull()) {
+      if (lhs_value.IsNull() != rhs_value.IsNull()) {
+        return lhs_value.IsNull() ? -1 : 1;
+      }
+      continue;
+    }
+    if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// NOLINTNEXTLINE
+TEST(NormalizedKeyTest, OrderTest) {
+  auto schema = ParseCreateStatement("a integer,b varchar(8),c double,d smallint");
+  std::vector<Value> ints = {ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetIntegerValue(-100),
+                             ValueFactory::GetIntegerValue(-1), ValueFactory::GetIntegerValue(0),
+                             ValueFactory::GetIntegerValue(1), ValueFactory::GetIntegerValue(65536)};
+  std::vector<Value> strings = {ValueFactory::GetNullValueByType(TypeId::VARCHAR), ValueFactory::GetVarcharValue(""),
+                                ValueFactory::GetVarcharValue("a"), ValueFactory::GetVarcharValue("ab"),
+                                ValueFactory::GetVarcharValue("b")};
+  std::vector<Value> decimals = {ValueFactory::GetNullValueByType(TypeId::DECIMAL),
+                                 ValueFactory::GetDecimalValue(-2.5), ValueFactory::GetDecimalValue(-0.5),
+                                 ValueFactory::GetDecimalValue(0), ValueFactory::GetDecimalValue(3.25)};
+  std::vector<Value> smallints = {ValueFactory::GetNullValueByType(TypeId::SMALLINT),
+                                  ValueFactory::GetSmallIntValue(-7), ValueFactory::GetSmallIntValue(300)};
+
+  std::vector<Tuple> tuples;
+  for (const auto &a : ints) {
+    for (const auto &b : strings) {
+      for (const auto &c : decimals) {
+        for (const auto &d : smallints) {
+          tuples.emplace_back(std::vector<Value>{a, b, c, d}, schema.get());
+        }
+      }
+    }
+  }
+  std::shuffle(tuples.begin(), tuples.end(), std::mt19937(15445));
+
+  // Scenario: every pair of keys compares as bytes the way the tuples compare column by column, nulls first.
+  NormalizedComparator<32> comparator(schema.get());
+  std::vector<NormalizedKey<32>> keys(tuples.size());
+  for (size_t i = 0; i < tuples.size(); i++) {
+    keys[i].SetFromKey(tuples[i], *schema);
+  }
+  for (size_t i = 0; i < tuples.size(); i++) {
+    for (size_t j = 0; j < tuples.size(); j++) {
+      ASSERT_EQ(CompareTuples(tuples[i], tuples[j], *schema), comparator(keys[i], keys[j]))
+          << tuples[i].ToString(schema.get()) << " vs " << tuples[j].ToString(schema.get());
+    }
+  }
+
+  // Scenario: keys that are not a multiple of 8 bytes are compared with memcmp, to the same result.
+  auto int_schema = ParseCreateStatement("a integer");
+  NormalizedComparator<5> short_comparator(int_schema.get());
+  for (size_t i = 0; i < ints.size(); i++) {
+    for (size_t j = 0; j < ints.size(); j++) {
+      Tuple lhs({ints[i]}, int_schema.get());
+      Tuple rhs({ints[j]}, int_schema.get());
+      NormalizedKey<5> lhs_key;
+      NormalizedKey<5> rhs_key;
+      lhs_key.SetFromKey(lhs, *int_schema);
+      rhs_key.SetFromKey(rhs, *int_schema);
+      EXPECT_EQ(CompareTuples(lhs, rhs, *int_schema), short_comparator(lhs_key, rhs_key));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(NormalizedKeyTest, EncodingTest) {
+  // Scenario: SetFromInteger() round-trips, in an 8 byte key as a BIGINT and in a 4 byte key as an INTEGER.
+  NormalizedKey<8> key;
+  NormalizedKey<4> short_key;
+  for (int64_t value : {-3, 0, 42, 1 << 20}) {
+    key.SetFromInteger(value);
+    short_key.SetFromInteger(value);
+    EXPECT_EQ(value, key.ToString());
+    EXPECT_EQ(value, short_key.ToString());
+  }
+
+  // Scenario: two integers fill an 8 byte key exactly, with no null bytes.
+  auto schema = ParseCreateStatement("a integer,b integer");
+  Tuple tuple({ValueFactory::GetIntegerValue(1), ValueFactory::GetIntegerValue(-1)}, schema.get());
+  key.SetFromKey(tuple, *schema);
+  const unsigned char expected[] = {0x80, 0, 0, 1, 0x7F, 0xFF, 0xFF, 0xFF};
+  EXPECT_EQ(0, memcmp(expected, key.data_, sizeof(expected)));
+
+  // Scenario: a 0 byte inside a varchar is escaped, so the string still sorts after its prefix.
+  auto varchar_schema = ParseCreateStatement("a varchar(8)");
+  NormalizedKey<16> prefix_key;
+  NormalizedKey<16> zero_key;
+  prefix_key.SetFromKey(Tuple({ValueFactory::GetVarcharValue("a")}, varchar_schema.get()), *varchar_schema);
+  zero_key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(std::string("a\0", 2))}, varchar_schema.get()),
+                      *varchar_schema);
+  EXPECT_EQ(-1, NormalizedComparator<16>()(prefix_key, zero_key));
+
+  // Scenario: a key too long for the key type is refused, not cut short.
+  NormalizedKey<8> long_key;
+  EXPECT_THROW(long_key.SetFromKey(Tuple({ValueFactory::GetVarcharValue("abcdefgh")}, varchar_schema.get()),
+                                   *varchar_schema),
+               Exception);
+}
+
+// NOLINTNEXTLINE
+TEST(NormalizedKeyTest, BPlusTreeIndexTest) {
+  auto table_schema = ParseCreateStatement("a integer,b varchar(8),c integer");
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  BPlusTreeIndex<NormalizedKey<16>, RID, NormalizedComparator<16>> index(
+      std::make_unique<IndexMetadata>("b_a", "t", table_schema.get(), std::vector<uint32_t>{1, 0}), bpm.get());
+  const Schema *key_schema = index.GetKeySchema();
+
+  // Index (b, a) of rows whose b cycles through a few strings, with some nulls.
+  const std::vector<std::string> names = {"pear", "apple", "fig", ""};
+  std::vector<Tuple> rows;
+  for (int32_t i = 0; i < 200; i++) {
+    Value name = i % 10 == 9 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                             : ValueFactory::GetVarcharValue(names[i % names.size()]);
+    rows.emplace_back(
+        std::vector<Value>{ValueFactory::GetIntegerValue(i - 100), name, ValueFactory::GetIntegerValue(i)},
+        table_schema.get());
+  }
+  for (int32_t i = 0; i < 200; i++) {
+    EXPECT_TRUE(index.InsertEntry(rows[i].KeyFromTuple(*table_schema, *key_schema, {1, 0}), RID(i, 0), nullptr));
+  }
+
+  // Scenario: every row is found by its key.
+  std::vector<RID> result;
+  for (int32_t i = 0; i < 200; i++) {
+    result.clear();
+    index.ScanKey(rows[i].KeyFromTuple(*table_schema, *key_schema, {1, 0}), &result, nullptr);
+    ASSERT_EQ(1U, result.size());
+    EXPECT_EQ(i, result[0].GetPageId());
+  }
+
+  // Scenario: a scan returns the rows ordered by b, nulls first, then by a.
+  std::vector<Tuple> keys;
+  for (auto iter = index.GetBeginIterator(); !iter.IsEnd(); ++iter) {
+    keys.push_back(rows[(*iter).second.GetPageId()].KeyFromTuple(*table_schema, *key_schema, {1, 0}));
+  }
+  ASSERT_EQ(200U, keys.size());
+  for (size_t i = 1; i < keys.size(); i++) {
+    EXPECT_EQ(-1, CompareTuples(keys[i - 1], keys[i], *key_schema));
+  }
+}
+
+}  // namespace bustub
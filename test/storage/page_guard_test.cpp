@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <string>
 
@@ -135,4 +136,46 @@ TEST(PageGuardTest, HHTest) {
   disk_manager->ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST(PageGuardTest, OptimisticGuardTest) {
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(1, disk_manager.get(), 2);
+
+  page_id_t page_id;
+  {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "Hello");
+  }
+
+  // Scenario: an optimistic read neither pins nor latches the page, and validates while nobody writes.
+  auto guard = bpm->FetchPageOptimistic(page_id);
+  ASSERT_TRUE(guard.IsValid());
+  EXPECT_EQ(page_id, guard.PageId());
+  EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+  EXPECT_TRUE(guard.Validate());
+  {
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    // Scenario: while a writer holds the page, optimistic reads fail.
+    EXPECT_FALSE(bpm->FetchPageOptimistic(page_id).IsValid());
+    EXPECT_FALSE(guard.Validate());
+  }
+  // Scenario: a write invalidates the reads that started before it.
+  EXPECT_FALSE(guard.Validate());
+  guard = bpm->FetchPageOptimistic(page_id);
+  EXPECT_TRUE(guard.Validate());
+
+  // Scenario: evicting the page invalidates the reads too.
+  page_id_t other_page_id;
+  bpm->NewPageGuarded(&other_page_id);
+  EXPECT_FALSE(guard.Validate());
+
+  // Scenario: a page that is not resident is read in first.
+  guard = bpm->FetchPageOptimistic(page_id);
+  ASSERT_TRUE(guard.IsValid());
+  EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+  EXPECT_TRUE(guard.Validate());
+
+  disk_manager->ShutDown();
+}
+
 }  // namespace bustub
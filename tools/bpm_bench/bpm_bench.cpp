@@ -1,11 +1,17 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <optional>
 #include <random>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include <cpp_random_distributions/zipfian_int_distribution.h>
@@ -14,12 +20,15 @@
 #include "binder/binder.h"
 #include "buffer/buffer_pool_manager.h"
 #include "buffer/lru_k_replacer.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
 #include "fmt/core.h"
 #include "fmt/std.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/disk/disk_manager_simulated.h"
 
 #include <sys/time.h>
 
@@ -34,6 +43,7 @@ static const size_t BUSTUB_GET_THREAD = 8;
 static const size_t LRU_K_SIZE = 16;
 static const size_t BUSTUB_PAGE_CNT = 6400;
 static const size_t BUSTUB_BPM_SIZE = 64;
+static const size_t BUSTUB_HOT_PAGE_CNT = 48;
 
 struct BpmTotalMetrics {
   uint64_t scan_cnt_{0};
@@ -53,11 +63,13 @@ struct BpmTotalMetrics {
     get_cnt_ += get_cnt;
   }
 
+  auto ScanPerSec() -> double { return scan_cnt_ / static_cast<double>(ClockMs() - start_time_) * 1000; }
+
+  auto GetPerSec() -> double { return get_cnt_ / static_cast<double>(ClockMs() - start_time_) * 1000; }
+
   void Report() {
-    auto now = ClockMs();
-    auto elsped = now - start_time_;
-    auto scan_per_sec = scan_cnt_ / static_cast<double>(elsped) * 1000;
-    auto get_per_sec = get_cnt_ / static_cast<double>(elsped) * 1000;
+    auto scan_per_sec = ScanPerSec();
+    auto get_per_sec = GetPerSec();
 
     fmt::print("<<< BEGIN\n");
     fmt::print("scan: {}\n", scan_per_sec);
@@ -100,41 +112,277 @@ struct BpmMetrics {
   }
 };
 
-// NOLINTNEXTLINE
-auto main(int argc, char **argv) -> int {
+struct BpmBenchConfig {
+  uint64_t duration_ms_{30000};
+  uint64_t latency_ms_{0};
+  size_t shards_{1};
+  bool flusher_{false};
+  /** Where RunBpmBench() keeps its pages: memory, pread (a DiskManager file) or mmap (a DiskManagerMmap file). */
+  std::string disk_{"memory"};
+  /** If set, RunBpmBench() keeps its pages in memory behind a simulated device with this profile. */
+  std::optional<bustub::DeviceProfile> device_profile_;
+};
+
+/** An in-memory disk that counts how many reads hit the first `BUSTUB_HOT_PAGE_CNT` pages. */
+class HotReadCountingDiskManager : public bustub::DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(bustub::page_id_t page_id, char *page_data) override {
+    if (static_cast<size_t>(page_id) < BUSTUB_HOT_PAGE_CNT) {
+      hot_reads_ += 1;
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  std::atomic<uint64_t> hot_reads_{0};
+};
+
+/**
+ * Measure the hit ratio of point lookups on a hot set of pages that fits in the buffer pool. If `scan_type` is set,
+ * the scan threads stream through the remaining pages with that access type at the same time.
+ *
+ * @return the fraction of lookups that were served without reading the disk
+ */
+auto RunScanResistanceBench(const BpmBenchConfig &config, std::optional<bustub::AccessType> scan_type) -> double {
   using bustub::AccessType;
   using bustub::BufferPoolManager;
-  using bustub::DiskManagerUnlimitedMemory;
   using bustub::page_id_t;
 
-  argparse::ArgumentParser program("bustub-bpm-bench");
-  program.add_argument("--duration").help("run bpm bench for n milliseconds");
-  program.add_argument("--latency").help("set disk latency to n milliseconds");
+  const uint64_t duration_ms = config.duration_ms_;
+  auto disk_manager = std::make_unique<HotReadCountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
 
-  try {
-    program.parse_args(argc, argv);
-  } catch (const std::runtime_error &err) {
-    std::cerr << err.what() << std::endl;
-    std::cerr << program;
-    return 1;
+  for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    guard.AsMut<char>()[i % 1024] = 1;
   }
+  disk_manager->SetLatency(config.latency_ms_);
 
-  uint64_t duration_ms = 30000;
-  if (program.present("--duration")) {
-    duration_ms = std::stoi(program.get("--duration"));
+  std::atomic<uint64_t> lookups{0};
+  std::vector<std::thread> threads;
+  if (scan_type.has_value()) {
+    for (size_t thread_id = 0; thread_id < BUSTUB_SCAN_THREAD; thread_id++) {
+      threads.emplace_back([thread_id, &bpm, duration_ms, scan_type] {
+        const size_t cold_page_cnt = BUSTUB_PAGE_CNT - BUSTUB_HOT_PAGE_CNT;
+        size_t page_idx = cold_page_cnt * thread_id / BUSTUB_SCAN_THREAD;
+        BpmMetrics metrics(fmt::format("scan {:>2}", thread_id), duration_ms);
+        metrics.Begin();
+        while (!metrics.ShouldFinish()) {
+          auto guard = bpm->FetchPageRead(BUSTUB_HOT_PAGE_CNT + page_idx, *scan_type);
+          page_idx = (page_idx + 1) % cold_page_cnt;
+        }
+      });
+    }
+  }
+  for (size_t thread_id = 0; thread_id < BUSTUB_GET_THREAD; thread_id++) {
+    threads.emplace_back([&bpm, duration_ms, &lookups] {
+      std::random_device r;
+      std::default_random_engine gen(r());
+      zipfian_int_distribution<size_t> dist(0, BUSTUB_HOT_PAGE_CNT - 1, 0.8);
+      BpmMetrics metrics("lookup", duration_ms);
+      metrics.Begin();
+      while (!metrics.ShouldFinish()) {
+        auto page_idx = dist(gen);
+        auto guard = bpm->FetchPageRead(page_idx, AccessType::Lookup);
+        if (guard.As<char>()[page_idx % 1024] == 0) {
+          throw std::runtime_error("invalid data");
+        }
+        metrics.Tick();
+      }
+      lookups += metrics.cnt_;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
   }
 
-  uint64_t latency_ms = 0;
-  if (program.present("--latency")) {
-    latency_ms = std::stoi(program.get("--latency"));
+  return lookups == 0 ? 0.0 : 1.0 - static_cast<double>(disk_manager->hot_reads_) / static_cast<double>(lookups);
+}
+
+/**
+ * Measure read throughput on a working set that is entirely cached, so that every fetch is a buffer pool hit.
+ * @return fetches per second over all `num_threads` threads
+ */
+auto RunCachedReadBench(const BpmBenchConfig &config, size_t num_threads) -> double {
+  using bustub::AccessType;
+  using bustub::BufferPoolManager;
+  using bustub::DiskManagerUnlimitedMemory;
+  using bustub::page_id_t;
+
+  const uint64_t duration_ms = config.duration_ms_;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  for (size_t i = 0; i < BUSTUB_BPM_SIZE; i++) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    guard.AsMut<char>()[i % 1024] = 1;
+  }
+
+  std::atomic<uint64_t> fetches{0};
+  std::vector<std::thread> threads;
+  for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
+    threads.emplace_back([&bpm, duration_ms, &fetches] {
+      std::random_device r;
+      std::default_random_engine gen(r());
+      std::uniform_int_distribution<size_t> dist(0, BUSTUB_BPM_SIZE - 1);
+      BpmMetrics metrics("cached", duration_ms);
+      metrics.Begin();
+      while (!metrics.ShouldFinish()) {
+        auto page_idx = dist(gen);
+        auto guard = bpm->FetchPageRead(page_idx, AccessType::Lookup);
+        if (guard.As<char>()[page_idx % 1024] == 0) {
+          throw std::runtime_error("invalid data");
+        }
+        metrics.Tick();
+      }
+      fetches += metrics.cnt_;
+    });
   }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return static_cast<double>(fetches) / (static_cast<double>(duration_ms) / 1000);
+}
 
+/** The access patterns of RunReplacerBench(). */
+enum class ReplacerWorkload { Uniform, Zipfian, ZipfianWithScans };
+
+/**
+ * Measure the hit ratio of a replacement policy on a single thread, with a fixed seed so that every policy sees the
+ * same page sequence. The working set is four times the size of the buffer pool. In the ZipfianWithScans workload,
+ * every 1000 lookups are followed by a scan of one pool's worth of pages.
+ *
+ * @return the fraction of fetches that were buffer pool hits, after a warm-up pass
+ */
+auto RunReplacerBench(const std::string &policy, ReplacerWorkload workload) -> double {
+  using bustub::AccessType;
+  using bustub::BufferPoolManager;
+  using bustub::DiskManagerUnlimitedMemory;
+  using bustub::page_id_t;
+
+  const size_t page_cnt = BUSTUB_BPM_SIZE * 4;
+  const size_t num_fetches = 200000;
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
   auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  bpm->SetReplacer(policy);
+  for (size_t i = 0; i < page_cnt; i++) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+  }
+
+  std::default_random_engine gen(42);
+  std::uniform_int_distribution<size_t> uniform(0, page_cnt - 1);
+  zipfian_int_distribution<size_t> zipfian(0, page_cnt - 1, 0.8);
+  size_t scan_idx = 0;
+  auto run = [&](size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      auto page_idx = workload == ReplacerWorkload::Uniform ? uniform(gen) : zipfian(gen);
+      bpm->FetchPageBasic(page_idx, AccessType::Lookup);
+      if (workload == ReplacerWorkload::ZipfianWithScans && (i + 1) % 1000 == 0) {
+        for (size_t j = 0; j < BUSTUB_BPM_SIZE; j++) {
+          bpm->FetchPageBasic(scan_idx, AccessType::Scan);
+          scan_idx = (scan_idx + 1) % page_cnt;
+        }
+      }
+    }
+  };
+  run(num_fetches / 10);
+  auto before = bpm->GetStats();
+  run(num_fetches);
+  auto after = bpm->GetStats();
+  auto hits = after.hits_ - before.hits_;
+  auto fetches = hits + after.misses_ - before.misses_;
+  return fetches == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(fetches);
+}
+
+/**
+ * Measure how long it takes to write back a buffer pool full of dirty pages to a file opened with O_DIRECT.
+ * @param writers the number of checkpoint writers, or 0 to flush the pages one by one in random order
+ * @return the time taken in milliseconds
+ */
+auto RunCheckpointBench(size_t pool_size, size_t writers) -> uint64_t {
+  using bustub::BufferPoolManager;
+  using bustub::DiskManager;
+  using bustub::page_id_t;
+
+  const std::string db_file = "bpm_bench_checkpoint.db";
+  remove(db_file.c_str());
+  auto disk_manager = std::make_unique<DiskManager>(db_file, true);
+  auto bpm = std::make_unique<BufferPoolManager>(pool_size, disk_manager.get(), LRU_K_SIZE);
   std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < pool_size; i++) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    guard.AsMut<char>()[0] = 1;
+    page_ids.push_back(page_id);
+  }
 
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  auto start = ClockMs();
+  if (writers == 0) {
+    std::shuffle(page_ids.begin(), page_ids.end(), std::default_random_engine(42));
+    for (auto page_id : page_ids) {
+      bpm->FlushPage(page_id);
+    }
+  } else {
+    bustub::checkpoint_writers = writers;
+    bpm->FlushAllPages();
+    bustub::checkpoint_writers = 1;
+  }
+  auto elapsed = ClockMs() - start;
+
+  disk_manager->ShutDown();
+  bpm.reset();
+  remove(db_file.c_str());
+  remove("bpm_bench_checkpoint.log");
+  remove("bpm_bench_checkpoint.fsm");
+  return elapsed;
+}
+
+/** Run the scan/get workload once against a buffer pool split into `config.shards_` instances. */
+void RunBpmBench(const BpmBenchConfig &config, BpmTotalMetrics *total_metrics) {
+  using bustub::AccessType;
+  using bustub::BufferPoolManager;
+  using bustub::DiskManagerUnlimitedMemory;
+  using bustub::page_id_t;
+  using bustub::ParallelBufferPoolManager;
+
+  const uint64_t duration_ms = config.duration_ms_;
+  const size_t shard_size = std::max<size_t>(1, BUSTUB_BPM_SIZE / config.shards_);
+
+  const std::string db_file = "bpm_bench.db";
+  std::unique_ptr<bustub::DiskManager> disk_manager;
+  DiskManagerUnlimitedMemory *memory_disk = nullptr;
+  if (config.disk_ == "pread" || config.disk_ == "mmap") {
+    remove(db_file.c_str());
+    if (config.disk_ == "pread") {
+      disk_manager = std::make_unique<bustub::DiskManager>(db_file);
+    } else {
+      disk_manager = std::make_unique<bustub::DiskManagerMmap>(db_file);
+    }
+  } else if (config.device_profile_.has_value()) {
+    auto device = std::make_unique<bustub::DiskManagerSimulated>(*config.device_profile_);
+    memory_disk = device.get();
+    disk_manager = std::move(device);
+  } else {
+    auto memory = std::make_unique<DiskManagerUnlimitedMemory>();
+    memory_disk = memory.get();
+    disk_manager = std::move(memory);
+  }
+  std::unique_ptr<BufferPoolManager> bpm;
+  if (config.shards_ == 1) {
+    bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  } else {
+    bpm = std::make_unique<ParallelBufferPoolManager>(config.shards_, shard_size, disk_manager.get(), LRU_K_SIZE);
+  }
+  std::vector<page_id_t> page_ids;
+
+  fmt::print(stderr,
+             "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}, shards={}, disk={}\n",
+             BUSTUB_PAGE_CNT, duration_ms, config.latency_ms_, LRU_K_SIZE, bpm->GetPoolSize(), config.shards_,
+             config.disk_);
+  if (config.device_profile_.has_value() && memory_disk != nullptr) {
+    fmt::print(stderr, "[info] device_profile={}\n", config.device_profile_->ToString());
+  }
 
   for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
     page_id_t page_id;
@@ -150,17 +398,21 @@ auto main(int argc, char **argv) -> int {
   }
 
   // enable disk latency after creating all pages
-  disk_manager->SetLatency(latency_ms);
+  if (memory_disk != nullptr) {
+    memory_disk->SetLatency(config.latency_ms_);
+  }
+  if (config.flusher_) {
+    bpm->StartBackgroundFlusher();
+  }
 
   fmt::print(stderr, "[info] benchmark start\n");
 
-  BpmTotalMetrics total_metrics;
-  total_metrics.Begin();
+  total_metrics->Begin();
 
   std::vector<std::thread> threads;
 
   for (size_t thread_id = 0; thread_id < BUSTUB_SCAN_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, total_metrics] {
       BpmMetrics metrics(fmt::format("scan {:>2}", thread_id), duration_ms);
       metrics.Begin();
 
@@ -186,12 +438,12 @@ auto main(int argc, char **argv) -> int {
         metrics.Report();
       }
 
-      total_metrics.ReportScan(metrics.cnt_);
+      total_metrics->ReportScan(metrics.cnt_);
     }));
   }
 
   for (size_t thread_id = 0; thread_id < BUSTUB_GET_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, total_metrics] {
       std::random_device r;
       std::default_random_engine gen(r());
       zipfian_int_distribution<size_t> dist(0, BUSTUB_PAGE_CNT - 1, 0.8);
@@ -218,7 +470,7 @@ auto main(int argc, char **argv) -> int {
         metrics.Report();
       }
 
-      total_metrics.ReportGet(metrics.cnt_);
+      total_metrics->ReportGet(metrics.cnt_);
     }));
   }
 
@@ -226,7 +478,197 @@ auto main(int argc, char **argv) -> int {
     thread.join();
   }
 
-  total_metrics.Report();
+  if (config.flusher_) {
+    bpm->StopBackgroundFlusher();
+    auto stats = bpm->GetBackgroundFlusherStats();
+    fmt::print(stderr, "[info] flusher: pages_cleaned={}, write_backs_avoided={}, foreground_write_backs={}\n",
+               stats.pages_cleaned_, stats.write_backs_avoided_, stats.foreground_write_backs_);
+  }
+  if (memory_disk == nullptr) {
+    bpm.reset();
+    disk_manager->ShutDown();
+    remove(db_file.c_str());
+    remove("bpm_bench.log");
+    remove("bpm_bench.fsm");
+  }
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-bpm-bench");
+  program.add_argument("--duration").help("run bpm bench for n milliseconds");
+  program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--shards").help("split the buffer pool into n instances");
+  program.add_argument("--device-profile")
+      .help("keep the pages in memory behind a simulated device: nvme, ssd, hdd or none, optionally followed by "
+            "overrides such as ,read_us=100,write_us=50,seq_read_us=10,seq_write_us=10,channels=4,bandwidth_mb=200");
+  program.add_argument("--disk").help(
+      "keep the pages in memory (default), in a file read with pread, in a file read through mmap, or compare the two "
+      "files: memory, pread, mmap or compare");
+  program.add_argument("--shard-sweep")
+      .help("run once for every power-of-two shard count from 1 to 64 and report the scaling")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--flusher")
+      .help("write back dirty pages in the background")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--cached-sweep")
+      .help("report FetchPageRead throughput on a fully cached working set for 1 to 32 threads")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--replacer")
+      .help("report the hit ratio of a replacement policy (lru_k, lru, clock, 2q, arc or all) under uniform and "
+            "zipfian lookups");
+  program.add_argument("--checkpoint")
+      .help("report the time to write back a pool of n dirty pages, page by page and as a checkpoint");
+  program.add_argument("--scan-resistance")
+      .help("report the point-lookup hit ratio with and without a concurrent full scan")
+      .default_value(false)
+      .implicit_value(true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  BpmBenchConfig config;
+  if (program.present("--duration")) {
+    config.duration_ms_ = std::stoi(program.get("--duration"));
+  }
+  if (program.present("--latency")) {
+    config.latency_ms_ = std::stoi(program.get("--latency"));
+  }
+  if (program.present("--shards")) {
+    config.shards_ = std::max(1, std::stoi(program.get("--shards")));
+  }
+  config.flusher_ = program.get<bool>("--flusher");
+  if (program.present("--device-profile")) {
+    try {
+      config.device_profile_ = bustub::DeviceProfile::Parse(program.get("--device-profile"));
+    } catch (const bustub::Exception &e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  }
+  if (program.present("--disk")) {
+    config.disk_ = bustub::StringUtil::Lower(program.get("--disk"));
+    if (config.disk_ != "memory" && config.disk_ != "pread" && config.disk_ != "mmap" && config.disk_ != "compare") {
+      std::cerr << "unknown disk: " << config.disk_ << std::endl;
+      return 1;
+    }
+  }
+
+  if (program.get<bool>("--scan-resistance")) {
+    using bustub::AccessType;
+    fmt::print(stderr, "[info] hot_page={}, total_page={}, duration_ms={}, lru_k_size={}, bpm_size={}\n",
+               BUSTUB_HOT_PAGE_CNT, BUSTUB_PAGE_CNT, config.duration_ms_, LRU_K_SIZE, BUSTUB_BPM_SIZE);
+    auto no_scan = RunScanResistanceBench(config, std::nullopt);
+    auto untagged_scan = RunScanResistanceBench(config, AccessType::Unknown);
+    auto tagged_scan = RunScanResistanceBench(config, AccessType::Scan);
+    fmt::print("<<< BEGIN\n");
+    fmt::print("lookup hit ratio, no scan:               {:.4f}\n", no_scan);
+    fmt::print("lookup hit ratio, scan as Unknown access: {:.4f}\n", untagged_scan);
+    fmt::print("lookup hit ratio, scan as Scan access:    {:.4f}\n", tagged_scan);
+    fmt::print(">>> END\n");
+    return 0;
+  }
+
+  if (program.present("--checkpoint")) {
+    auto pool_size = static_cast<size_t>(std::max(1, std::stoi(program.get("--checkpoint"))));
+    fmt::print(stderr, "[info] pool_size={} ({} MB)\n", pool_size, pool_size * bustub::BUSTUB_PAGE_SIZE >> 20);
+    std::vector<std::pair<std::string, uint64_t>> results;
+    results.emplace_back("FlushPage, random order", RunCheckpointBench(pool_size, 0));
+    for (size_t writers : {1, 4}) {
+      results.emplace_back(fmt::format("FlushAllPages, {} writer(s)", writers), RunCheckpointBench(pool_size, writers));
+    }
+    fmt::print("<<< BEGIN\n");
+    for (const auto &[name, ms] : results) {
+      fmt::print("{:<28} {:>8} ms\n", name, ms);
+    }
+    fmt::print(">>> END\n");
+    return 0;
+  }
+
+  if (program.present("--replacer")) {
+    std::vector<std::string> policies{program.get("--replacer")};
+    if (bustub::StringUtil::Lower(policies[0]) == "all") {
+      policies = {"lru_k", "lru", "clock", "2q", "arc"};
+    }
+    fmt::print(stderr, "[info] total_page={}, lru_k_size={}, bpm_size={}\n", BUSTUB_BPM_SIZE * 4, LRU_K_SIZE,
+               BUSTUB_BPM_SIZE);
+    std::vector<std::tuple<std::string, double, double, double>> results;
+    for (const auto &policy : policies) {
+      results.emplace_back(policy, RunReplacerBench(policy, ReplacerWorkload::Uniform),
+                           RunReplacerBench(policy, ReplacerWorkload::Zipfian),
+                           RunReplacerBench(policy, ReplacerWorkload::ZipfianWithScans));
+    }
+    fmt::print("<<< BEGIN\n");
+    fmt::print("{:<8} {:>10} {:>10} {:>16}\n", "policy", "uniform", "zipfian", "zipfian+scans");
+    for (const auto &[policy, uniform, zipfian, with_scans] : results) {
+      fmt::print("{:<8} {:>10.4f} {:>10.4f} {:>16.4f}\n", policy, uniform, zipfian, with_scans);
+    }
+    fmt::print(">>> END\n");
+    return 0;
+  }
+
+  if (program.get<bool>("--cached-sweep")) {
+    fmt::print(stderr, "[info] duration_ms={}, lru_k_size={}, bpm_size={}\n", config.duration_ms_, LRU_K_SIZE,
+               BUSTUB_BPM_SIZE);
+    std::vector<std::pair<size_t, double>> results;
+    for (size_t num_threads = 1; num_threads <= 32; num_threads *= 2) {
+      results.emplace_back(num_threads, RunCachedReadBench(config, num_threads));
+    }
+    fmt::print("<<< BEGIN\n");
+    for (const auto &[num_threads, fetches_per_sec] : results) {
+      fmt::print("threads={:<3} fetch: {:<14.1f} speedup: {:.2f}x\n", num_threads, fetches_per_sec,
+                 results[0].second == 0 ? 0.0 : fetches_per_sec / results[0].second);
+    }
+    fmt::print(">>> END\n");
+    return 0;
+  }
+
+  if (config.disk_ == "compare") {
+    std::vector<std::tuple<std::string, double, double>> results;
+    for (const auto *disk : {"pread", "mmap"}) {
+      config.disk_ = disk;
+      BpmTotalMetrics total_metrics;
+      RunBpmBench(config, &total_metrics);
+      results.emplace_back(disk, total_metrics.ScanPerSec(), total_metrics.GetPerSec());
+    }
+    fmt::print("<<< BEGIN\n");
+    for (const auto &[disk, scan_per_sec, get_per_sec] : results) {
+      fmt::print("disk={:<6} scan: {:<12.1f} get: {:<12.1f}\n", disk, scan_per_sec, get_per_sec);
+    }
+    fmt::print(">>> END\n");
+    return 0;
+  }
+
+  if (!program.get<bool>("--shard-sweep")) {
+    BpmTotalMetrics total_metrics;
+    RunBpmBench(config, &total_metrics);
+    total_metrics.Report();
+    return 0;
+  }
+
+  std::vector<std::tuple<size_t, double, double>> results;
+  for (size_t shards = 1; shards <= 64; shards *= 2) {
+    config.shards_ = shards;
+    BpmTotalMetrics total_metrics;
+    RunBpmBench(config, &total_metrics);
+    results.emplace_back(shards, total_metrics.ScanPerSec(), total_metrics.GetPerSec());
+  }
+
+  const double base = std::get<1>(results[0]) + std::get<2>(results[0]);
+  fmt::print("<<< BEGIN\n");
+  for (const auto &[shards, scan_per_sec, get_per_sec] : results) {
+    fmt::print("shards={:<3} scan: {:<12.1f} get: {:<12.1f} speedup: {:.2f}x\n", shards, scan_per_sec, get_per_sec,
+               base == 0 ? 0.0 : (scan_per_sec + get_per_sec) / base);
+  }
+  fmt::print(">>> END\n");
 
   return 0;
 }
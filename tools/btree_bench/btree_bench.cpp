@@ -20,8 +20,12 @@
 #include "common/util/string_util.h"
 #include "fmt/format.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_simulated.h"
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/generic_key.h"
+#include "storage/index/integer_key.h"
+#include "storage/index/key_search.h"
+#include "storage/index/normalized_key.h"
 #include "test_util.h"
 
 #include <sys/time.h>
@@ -110,46 +114,25 @@ auto KeyWillVanish(size_t key) -> bool { return key % 7 == 0; }
 // These keys will be overwritten to a new value
 auto KeyWillChange(size_t key) -> bool { return key % 5 == 0; }
 
-// NOLINTNEXTLINE
-auto main(int argc, char **argv) -> int {
-  using bustub::AccessType;
-  using bustub::BufferPoolManager;
-  using bustub::DiskManagerUnlimitedMemory;
+/**
+ * Fill a tree with TOTAL_KEYS keys, then run the readers and writers against it. The key type is a parameter, to
+ * compare GenericKey, which is compared through Values, with NormalizedKey, which is compared as bytes, and with
+ * IntegerKey, which is compared as a native integer.
+ */
+template <typename KeyType, typename KeyComparator>
+void RunBench(bustub::BufferPoolManager *bpm, uint64_t duration_ms, size_t write_threads) {
   using bustub::page_id_t;
 
-  argparse::ArgumentParser program("bustub-btree-bench");
-  program.add_argument("--duration").help("run btree bench for n milliseconds");
-
-  try {
-    program.parse_args(argc, argv);
-  } catch (const std::runtime_error &err) {
-    std::cerr << err.what() << std::endl;
-    std::cerr << program;
-    return 1;
-  }
-
-  uint64_t duration_ms = 30000;
-  if (program.present("--duration")) {
-    duration_ms = std::stoi(program.get("--duration"));
-  }
-
-  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
-
-  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}\n", TOTAL_KEYS, duration_ms,
-             LRU_K_SIZE, BUSTUB_BPM_SIZE);
-
   auto key_schema = bustub::ParseCreateStatement("a bigint");
-  bustub::GenericComparator<8> comparator(key_schema.get());
+  KeyComparator comparator(key_schema.get());
 
   page_id_t page_id;
   auto header_page = bpm->NewPageGuarded(&page_id);
 
-  bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>> index("foo_pk", page_id,
-                                                                                            bpm.get(), comparator);
+  bustub::BPlusTree<KeyType, bustub::RID, KeyComparator> index("foo_pk", page_id, bpm, comparator);
 
   for (size_t key = 0; key < TOTAL_KEYS; key++) {
-    bustub::GenericKey<8> index_key;
+    KeyType index_key;
     bustub::RID rid;
     uint32_t value = key;
     rid.Set(value, value);
@@ -175,7 +158,7 @@ auto main(int argc, char **argv) -> int {
       std::default_random_engine gen(r());
       std::uniform_int_distribution<size_t> dis(key_start, key_end - 1);
 
-      bustub::GenericKey<8> index_key;
+      KeyType index_key;
       std::vector<bustub::RID> rids;
 
       while (!metrics.ShouldFinish()) {
@@ -210,7 +193,7 @@ auto main(int argc, char **argv) -> int {
     }));
   }
 
-  for (size_t thread_id = 0; thread_id < BUSTUB_WRITE_THREAD; thread_id++) {
+  for (size_t thread_id = 0; thread_id < write_threads; thread_id++) {
     threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics] {
       BTreeMetrics metrics(fmt::format("write {:>2}", thread_id), duration_ms);
       metrics.Begin();
@@ -221,7 +204,7 @@ auto main(int argc, char **argv) -> int {
       std::default_random_engine gen(r());
       std::uniform_int_distribution<size_t> dis(key_start, key_end - 1);
 
-      bustub::GenericKey<8> index_key;
+      KeyType index_key;
       bustub::RID rid;
 
       bool do_insert = false;
@@ -263,5 +246,97 @@ auto main(int argc, char **argv) -> int {
 
   total_metrics.Report();
 
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  using bustub::AccessType;
+  using bustub::BufferPoolManager;
+  using bustub::DiskManagerUnlimitedMemory;
+  using bustub::page_id_t;
+
+  argparse::ArgumentParser program("bustub-btree-bench");
+  program.add_argument("--duration").help("run btree bench for n milliseconds");
+  program.add_argument("--read-only")
+      .help("run the readers only, to measure lookups without write contention")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--key-type")
+      .help("generic, for keys compared column by column through Values, normalized, for keys compared as bytes, or "
+            "integer, for keys compared as native integers")
+      .default_value(std::string("generic"));
+  program.add_argument("--key-search")
+      .help("how integer keys are searched in a page: scalar, sse4.2 or avx2; the best this CPU has by default");
+  program.add_argument("--device-profile")
+      .help("keep the pages behind a simulated device: nvme, ssd, hdd or none, optionally followed by overrides such "
+            "as ,read_us=100,channels=4");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 30000;
+  if (program.present("--duration")) {
+    duration_ms = std::stoi(program.get("--duration"));
+  }
+  const size_t write_threads = program.get<bool>("--read-only") ? 0 : BUSTUB_WRITE_THREAD;
+  const auto key_type = program.get<std::string>("--key-type");
+  if (key_type != "generic" && key_type != "normalized" && key_type != "integer") {
+    std::cerr << "unknown key type: " << key_type << std::endl;
+    return 1;
+  }
+
+  if (program.present("--key-search")) {
+    const auto key_search = program.get("--key-search");
+    bool known = false;
+    for (auto isa : {bustub::KeySearchIsa::Scalar, bustub::KeySearchIsa::Sse42, bustub::KeySearchIsa::Avx2}) {
+      if (key_search == bustub::KeySearchIsaName(isa)) {
+        try {
+          bustub::SetKeySearchIsa(isa);
+        } catch (const bustub::Exception &e) {
+          std::cerr << e.what() << std::endl;
+          return 1;
+        }
+        known = true;
+      }
+    }
+    if (!known) {
+      std::cerr << "unknown key search: " << key_search << std::endl;
+      return 1;
+    }
+  }
+
+  std::unique_ptr<DiskManagerUnlimitedMemory> disk_manager;
+  if (program.present("--device-profile")) {
+    try {
+      auto profile = bustub::DeviceProfile::Parse(program.get("--device-profile"));
+      fmt::print(stderr, "[info] device_profile={}\n", profile.ToString());
+      disk_manager = std::make_unique<bustub::DiskManagerSimulated>(profile);
+    } catch (const bustub::Exception &e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  } else {
+    disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  }
+  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+
+  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}, key_type={}, key_search={}\n",
+             TOTAL_KEYS, duration_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE, key_type,
+             bustub::KeySearchIsaName(bustub::GetKeySearchIsa()));
+
+  if (key_type == "normalized") {
+    RunBench<bustub::NormalizedKey<8>, bustub::NormalizedComparator<8>>(bpm.get(), duration_ms, write_threads);
+  } else if (key_type == "integer") {
+    using IntegerKey = bustub::IntegerKey<int64_t>;
+    RunBench<IntegerKey, bustub::IntegerComparator<IntegerKey>>(bpm.get(), duration_ms, write_threads);
+  } else {
+    RunBench<bustub::GenericKey<8>, bustub::GenericComparator<8>>(bpm.get(), duration_ms, write_threads);
+  }
+
   return 0;
 }
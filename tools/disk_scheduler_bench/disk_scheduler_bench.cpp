@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <future>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/frame_arena.h"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
+
+static const char *BENCH_DB_FILE = "disk_scheduler_bench.db";
+
+struct DiskSchedulerBenchConfig {
+  /** Size of the file the requests go to, in pages. */
+  size_t num_pages_{16384};
+  uint64_t duration_ms_{1000};
+  /** Fraction of the requests that are writes. */
+  double write_ratio_{0.0};
+  bool direct_io_{false};
+  /** Background writes kept queued while the latency of foreground reads is measured. */
+  size_t write_backlog_{256};
+};
+
+/** @return the requests completed per second by `backend` with `queue_depth` random page requests kept in flight */
+auto RunDiskSchedulerBench(bustub::DiskManager *disk_manager, bustub::DiskSchedulerBackend backend,
+                           size_t queue_depth, const DiskSchedulerBenchConfig &config)
+    -> std::pair<bustub::DiskSchedulerBackend, double> {
+  bustub::DiskScheduler scheduler(disk_manager, {backend, queue_depth});
+  // One aligned frame per request in flight, so that O_DIRECT requests are never bounced.
+  bustub::FrameArena frames(queue_depth, false);
+  std::mt19937_64 gen(15445);
+  std::uniform_int_distribution<bustub::page_id_t> page_dist(0, static_cast<bustub::page_id_t>(config.num_pages_ - 1));
+  std::bernoulli_distribution write_dist(config.write_ratio_);
+
+  auto issue = [&](size_t slot) {
+    auto promise = scheduler.CreatePromise();
+    auto future = promise.get_future();
+    scheduler.Schedule({write_dist(gen), frames.GetFrame(static_cast<bustub::frame_id_t>(slot)), page_dist(gen),
+                        std::move(promise)});
+    return future;
+  };
+
+  // A closed loop: every completion is replaced by a new request, so exactly queue_depth requests are outstanding.
+  std::vector<std::future<bool>> in_flight;
+  for (size_t slot = 0; slot < queue_depth; slot++) {
+    in_flight.push_back(issue(slot));
+  }
+  uint64_t completed = 0;
+  const auto start = std::chrono::steady_clock::now();
+  const auto deadline = start + std::chrono::milliseconds(config.duration_ms_);
+  auto now = start;
+  for (size_t slot = 0; now < deadline; slot = (slot + 1) % queue_depth) {
+    in_flight[slot].wait();
+    completed++;
+    in_flight[slot] = issue(slot);
+    if (completed % 64 == 0) {
+      now = std::chrono::steady_clock::now();
+    }
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  for (auto &future : in_flight) {
+    future.wait();
+  }
+  return {scheduler.GetBackend(), static_cast<double>(completed) / elapsed.count()};
+}
+
+/**
+ * @return the 50th and 99th percentile latency, in microseconds, of one-at-a-time reads while another thread keeps
+ * `config.write_backlog_` writes queued, as a bulk load writing back dirty pages would. The writes are scheduled with
+ * `write_priority`: Background lets the reads overtake them, Foreground puts everything in one FIFO queue.
+ */
+auto RunReadLatencyBench(bustub::DiskManager *disk_manager, bustub::DiskSchedulerBackend backend, size_t queue_depth,
+                         bustub::DiskRequestPriority write_priority, const DiskSchedulerBenchConfig &config)
+    -> std::pair<double, double> {
+  bustub::DiskScheduler scheduler(disk_manager, {backend, queue_depth});
+  bustub::FrameArena frames(config.write_backlog_ + 1, false);
+  std::atomic<bool> stop{false};
+  const auto last_page = static_cast<bustub::page_id_t>(config.num_pages_ - 1);
+
+  std::thread writer([&] {
+    std::mt19937_64 gen(15721);
+    std::uniform_int_distribution<bustub::page_id_t> page_dist(0, last_page);
+    std::vector<std::future<bool>> backlog(config.write_backlog_);
+    for (size_t slot = 0; !stop.load(); slot = (slot + 1) % backlog.size()) {
+      if (backlog[slot].valid()) {
+        backlog[slot].wait();
+      }
+      auto promise = scheduler.CreatePromise();
+      backlog[slot] = promise.get_future();
+      scheduler.Schedule({true, frames.GetFrame(static_cast<bustub::frame_id_t>(slot + 1)), page_dist(gen),
+                          std::move(promise), {}, write_priority});
+    }
+    for (auto &write : backlog) {
+      if (write.valid()) {
+        write.wait();
+      }
+    }
+  });
+
+  std::mt19937_64 gen(15445);
+  std::uniform_int_distribution<bustub::page_id_t> page_dist(0, last_page);
+  std::vector<double> latencies;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.duration_ms_);
+  for (auto now = std::chrono::steady_clock::now(); now < deadline; now = std::chrono::steady_clock::now()) {
+    auto promise = scheduler.CreatePromise();
+    auto future = promise.get_future();
+    scheduler.Schedule({false, frames.GetFrame(0), page_dist(gen), std::move(promise)});
+    future.wait();
+    const std::chrono::duration<double, std::micro> latency = std::chrono::steady_clock::now() - now;
+    latencies.push_back(latency.count());
+  }
+  stop = true;
+  writer.join();
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) {
+    return latencies.empty() ? 0.0 : latencies[static_cast<size_t>(p * static_cast<double>(latencies.size() - 1))];
+  };
+  return {percentile(0.5), percentile(0.99)};
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-disk-scheduler-bench");
+  program.add_argument("--duration").help("run every configuration for n milliseconds");
+  program.add_argument("--pages").help("size of the file read and written, in pages");
+  program.add_argument("--write-ratio").help("fraction of the requests that are writes, 0 to 1");
+  program.add_argument("--write-backlog").help("background writes kept queued while read latency is measured");
+  program.add_argument("--direct-io")
+      .help("open the file with O_DIRECT, so that reads are not served from the page cache")
+      .default_value(false)
+      .implicit_value(true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  DiskSchedulerBenchConfig config;
+  if (program.present("--duration")) {
+    config.duration_ms_ = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--pages")) {
+    config.num_pages_ = std::max<size_t>(1, std::stoul(program.get("--pages")));
+  }
+  if (program.present("--write-ratio")) {
+    config.write_ratio_ = std::clamp(std::stod(program.get("--write-ratio")), 0.0, 1.0);
+  }
+  if (program.present("--write-backlog")) {
+    config.write_backlog_ = std::max<size_t>(1, std::stoul(program.get("--write-backlog")));
+  }
+  config.direct_io_ = program.get<bool>("--direct-io");
+
+  remove(BENCH_DB_FILE);
+  auto disk_manager = std::make_unique<bustub::DiskManager>(BENCH_DB_FILE, config.direct_io_);
+  {
+    // Write the whole file first, so that reads hit allocated blocks.
+    bustub::FrameArena chunk(64, false);
+    std::vector<const char *> pages(64);
+    for (size_t i = 0; i < pages.size(); i++) {
+      pages[i] = chunk.GetFrame(static_cast<bustub::frame_id_t>(i));
+    }
+    for (size_t page_id = 0; page_id < config.num_pages_; page_id += pages.size()) {
+      pages.resize(std::min<size_t>(64, config.num_pages_ - page_id));
+      disk_manager->WritePages(static_cast<bustub::page_id_t>(page_id), pages);
+    }
+    disk_manager->SyncPages();
+  }
+  fmt::print(stderr, "[info] pages={} ({} MB), duration_ms={}, write_ratio={}, direct_io={}\n", config.num_pages_,
+             config.num_pages_ * bustub::BUSTUB_PAGE_SIZE >> 20, config.duration_ms_, config.write_ratio_,
+             disk_manager->IsDirectIo());
+
+  std::vector<std::tuple<std::string, size_t, double>> results;
+  for (auto backend : {bustub::DiskSchedulerBackend::Serial, bustub::DiskSchedulerBackend::ThreadPool,
+                       bustub::DiskSchedulerBackend::IoUring}) {
+    for (size_t queue_depth = 1; queue_depth <= 64; queue_depth *= 2) {
+      auto [used, iops] = RunDiskSchedulerBench(disk_manager.get(), backend, queue_depth, config);
+      if (used != backend) {
+        fmt::print(stderr, "[info] {} is not available, skipped\n", bustub::DiskSchedulerBackendName(backend));
+        break;
+      }
+      results.emplace_back(bustub::DiskSchedulerBackendName(backend), queue_depth, iops);
+    }
+  }
+
+  // Foreground read latency while writes are flooding the scheduler, with and without write priorities.
+  std::vector<std::tuple<std::string, std::string, double, double>> latencies;
+  for (auto backend : {bustub::DiskSchedulerBackend::Serial, bustub::DiskSchedulerBackend::IoUring}) {
+    for (auto write_priority : {bustub::DiskRequestPriority::Foreground, bustub::DiskRequestPriority::Background}) {
+      const size_t queue_depth = backend == bustub::DiskSchedulerBackend::Serial ? 1 : 8;
+      auto [p50, p99] = RunReadLatencyBench(disk_manager.get(), backend, queue_depth, write_priority, config);
+      latencies.emplace_back(bustub::DiskSchedulerBackendName(backend),
+                             write_priority == bustub::DiskRequestPriority::Background ? "background" : "fifo", p50,
+                             p99);
+    }
+  }
+  disk_manager->ShutDown();
+  remove(BENCH_DB_FILE);
+  remove("disk_scheduler_bench.log");
+  remove("disk_scheduler_bench.fsm");
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("{:<12} {:>6} {:>12}\n", "backend", "depth", "iops");
+  for (const auto &[backend, queue_depth, iops] : results) {
+    fmt::print("{:<12} {:>6} {:>12.0f}\n", backend, queue_depth, iops);
+  }
+  fmt::print("\n{:<12} {:>12} {:>12} {:>12}\n", "backend", "writes", "read_p50_us", "read_p99_us");
+  for (const auto &[backend, writes, p50, p99] : latencies) {
+    fmt::print("{:<12} {:>12} {:>12.1f} {:>12.1f}\n", backend, writes, p50, p99);
+  }
+  fmt::print(">>> END\n");
+  return 0;
+}
@@ -0,0 +1,85 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/lru_k_replacer.h"
+#include "common/config.h"
+#include "fmt/core.h"
+
+static const size_t LRU_K_SIZE = 16;
+static const size_t MIN_FRAMES = 64;
+static const size_t MAX_FRAMES = 1 << 20;
+
+/**
+ * Drive the replacer the way the buffer pool does: a hit records an access and pins/unpins the frame, a miss evicts
+ * a victim and records the first access of the new page in the victim's frame.
+ *
+ * @return average nanoseconds per operation
+ */
+auto RunReplacerBench(size_t num_frames, size_t num_ops, double miss_ratio) -> double {
+  using bustub::frame_id_t;
+  bustub::LRUKReplacer replacer(num_frames, LRU_K_SIZE);
+  for (size_t i = 0; i < num_frames; i++) {
+    auto frame_id = static_cast<frame_id_t>(i);
+    replacer.RecordAccess(frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+
+  // Pre-draw the workload so that random number generation stays out of the timed loop.
+  std::mt19937_64 gen(num_frames);
+  std::uniform_int_distribution<frame_id_t> frame_dis(0, static_cast<frame_id_t>(num_frames - 1));
+  std::bernoulli_distribution miss_dis(miss_ratio);
+  std::vector<frame_id_t> frames(num_ops);
+  for (auto &frame_id : frames) {
+    frame_id = miss_dis(gen) ? -1 : frame_dis(gen);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto frame_id : frames) {
+    if (frame_id < 0) {
+      replacer.Evict(&frame_id);
+    }
+    replacer.RecordAccess(frame_id);
+    replacer.SetEvictable(frame_id, false);
+    replacer.SetEvictable(frame_id, true);
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+  return elapsed.count() / static_cast<double>(num_ops);
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-replacer-bench");
+  program.add_argument("--ops").help("run n operations for every pool size");
+  program.add_argument("--miss-ratio").help("fraction of operations that evict a frame, between 0 and 1");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t num_ops = 1000000;
+  if (program.present("--ops")) {
+    num_ops = std::stoul(program.get("--ops"));
+  }
+  double miss_ratio = 0.1;
+  if (program.present("--miss-ratio")) {
+    miss_ratio = std::stod(program.get("--miss-ratio"));
+  }
+
+  fmt::print(stderr, "[info] ops={}, miss_ratio={}, lru_k_size={}\n", num_ops, miss_ratio, LRU_K_SIZE);
+
+  fmt::print("<<< BEGIN\n");
+  for (size_t num_frames = MIN_FRAMES; num_frames <= MAX_FRAMES; num_frames *= 4) {
+    fmt::print("frames={}: {:.1f} ns/op\n", num_frames, RunReplacerBench(num_frames, num_ops, miss_ratio));
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
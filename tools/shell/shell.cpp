@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include "binder/binder.h"
@@ -27,7 +29,20 @@ auto GetWidthOfUtf8(const void *beg, const void *end, size_t *width) -> int {
 auto main(int argc, char **argv) -> int {
   ft_set_u8strwid_func(&GetWidthOfUtf8);
 
-  auto bustub = std::make_unique<bustub::BustubInstance>("test.db");
+  bool use_mmap = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--mmap") == 0) {
+      use_mmap = true;
+    }
+    if (strcmp(argv[i], "--disk-io-depth") == 0 && i + 1 < argc) {
+      bustub::disk_io_depth = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+    }
+    if (strcmp(argv[i], "--buffer-pool-instances") == 0 && i + 1 < argc) {
+      bustub::buffer_pool_instances = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+    }
+  }
+  auto bustub = std::make_unique<bustub::BustubInstance>(
+      "test.db", use_mmap ? bustub::DiskManagerKind::Mmap : bustub::DiskManagerKind::Pread);
 
   auto default_prompt = "bustub> ";
   auto emoji_prompt = "\U0001f6c1> ";  // the bathtub emoji
@@ -175,6 +175,14 @@ auto main(int argc, char **argv) -> int {  // NOLINT
   program.add_argument("--verbose").help("increase output verbosity").default_value(false).implicit_value(true);
   program.add_argument("-d", "--diff").help("write diff file").default_value(false).implicit_value(true);
   program.add_argument("--in-memory").help("use in-memory backend").default_value(false).implicit_value(true);
+  program.add_argument("--disk-io-depth")
+      .help("number of disk requests kept in flight, more than 1 for io_uring")
+      .default_value(size_t{1})
+      .scan<'u', size_t>();
+  program.add_argument("--buffer-pool-instances")
+      .help("number of instances the buffer pool is split into")
+      .default_value(size_t{1})
+      .scan<'u', size_t>();
 
   try {
     program.parse_args(argc, argv);
@@ -201,6 +209,8 @@ auto main(int argc, char **argv) -> int {  // NOLINT
 
   std::unique_ptr<bustub::BustubInstance> bustub;
 
+  bustub::disk_io_depth = program.get<size_t>("--disk-io-depth");
+  bustub::buffer_pool_instances = program.get<size_t>("--buffer-pool-instances");
   if (program.get<bool>("--in-memory")) {
     bustub = std::make_unique<bustub::BustubInstance>();
   } else {
@@ -17,6 +17,7 @@
 #include "concurrency/transaction_manager.h"
 #include "fmt/core.h"
 #include "fmt/std.h"
+#include "storage/disk/disk_manager_simulated.h"
 #include "terrier_bench_config.h"
 
 #include <sys/time.h>
@@ -141,6 +142,9 @@ auto main(int argc, char **argv) -> int {
   program.add_argument("--force-create-index").help("create index in terrier bench");
   program.add_argument("--force-enable-update").help("use update statement in terrier bench");
   program.add_argument("--nft").help("number of NFTs in the bench");
+  program.add_argument("--device-profile")
+      .help("keep the pages behind a simulated device: nvme, ssd, hdd or none, optionally followed by overrides such "
+            "as ,read_us=100,channels=4");
 
   size_t bustub_nft_num = 10;
 
@@ -152,7 +156,19 @@ auto main(int argc, char **argv) -> int {
     return 1;
   }
 
-  auto bustub = std::make_unique<bustub::BustubInstance>();
+  std::unique_ptr<bustub::BustubInstance> bustub;
+  if (program.present("--device-profile")) {
+    try {
+      auto profile = bustub::DeviceProfile::Parse(program.get("--device-profile"));
+      fmt::print(stderr, "[info] device_profile={}\n", profile.ToString());
+      bustub = std::make_unique<bustub::BustubInstance>(std::make_unique<bustub::DiskManagerSimulated>(profile));
+    } catch (const bustub::Exception &e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  } else {
+    bustub = std::make_unique<bustub::BustubInstance>();
+  }
   auto writer = bustub::SimpleStreamWriter(std::cerr);
 
   // create schema